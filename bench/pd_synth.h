@@ -0,0 +1,131 @@
+// bench/pd_synth.h
+#pragma once
+
+#include "sstv_types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// PD 测试信号合成器：VIS 头 + PD 行数据，相位连续的 FM 正弦波，可选加性高斯白噪声
+// 时序与 docs/pd120_encode.py 相同；各段时长按理想结束时刻累计，不会逐段累积取整误差
+namespace sstv::bench {
+
+struct SynthOptions {
+    double sample_rate = 11025.0;
+    double snr_db = std::numeric_limits<double>::infinity(); // 信号功率 / 全带宽噪声功率，无穷大表示无噪声
+    double frequency_offset = 0.0;   // 整体频偏 (Hz)，模拟 SSB 失谐
+    double padding_s = 0.5;          // 信号前后的静音时长
+    double amplitude = 0.8;
+    uint32_t noise_seed = 1234;
+};
+
+// 测试图案：R 为水平渐变、G 为垂直渐变、B 为 40 像素棋盘格
+inline Pixel test_pattern(int x, int y, int width, int height) {
+    const auto r = static_cast<uint8_t>(255 * x / std::max(width - 1, 1));
+    const auto g = static_cast<uint8_t>(255 * y / std::max(height - 1, 1));
+    const auto b = static_cast<uint8_t>(((x / 40 + y / 40) % 2) ? 220 : 30);
+    return {r, g, b};
+}
+
+class PDSynthesizer {
+public:
+    PDSynthesizer(const ModeDescriptor& desc, const SynthOptions& options)
+        : m_desc(desc), m_options(options) {}
+
+    // 合成完整的一次发送（前导音 + VIS + 全部行）
+    std::vector<float> synthesize() {
+        m_output.assign(static_cast<size_t>(m_options.padding_s * m_options.sample_rate), 0.0f);
+        m_phase = 0.0;
+        m_time = 0.0;
+        m_end_time = 0.0;
+
+        for (const auto& tone : DEFAULT_PREAMBLE_TONES) emit(tone.frequency, tone.duration_ms);
+        emit_vis(m_desc.mode.vis_code);
+        emit_image();
+
+        m_output.insert(m_output.end(), static_cast<size_t>(m_options.padding_s * m_options.sample_rate), 0.0f);
+        add_noise();
+        return std::move(m_output);
+    }
+
+private:
+    void emit(double frequency, double duration_ms) {
+        const double fs = m_options.sample_rate;
+        const double step = 2.0 * std::numbers::pi * (frequency + m_options.frequency_offset) / fs;
+        m_end_time += duration_ms * fs / 1000.0;
+        for (; m_time < m_end_time; m_time += 1.0) {
+            m_phase += step;
+            m_output.push_back(static_cast<float>(m_options.amplitude * std::sin(m_phase)));
+        }
+        m_phase = std::fmod(m_phase, 2.0 * std::numbers::pi);
+    }
+
+    void emit_vis(int vis_code) {
+        emit(VIS_LEADER_BURST_FREQ, VIS_LEADER_BURST_DURATION_MS);
+        emit(VIS_BREAK_FREQ, VIS_BREAK_DURATION_MS);
+        emit(VIS_LEADER_BURST_FREQ, VIS_LEADER_BURST_DURATION_MS);
+        emit(VIS_START_STOP_FREQ, VIS_BIT_DURATION_MS);
+        int ones = 0;
+        for (int bit = 0; bit < 7; ++bit) { // LSB 在前
+            const int value = (vis_code >> bit) & 1;
+            ones += value;
+            emit(value ? VIS_LOGIC_1_FREQ : VIS_LOGIC_0_FREQ, VIS_BIT_DURATION_MS);
+        }
+        emit((ones % 2) ? VIS_LOGIC_1_FREQ : VIS_LOGIC_0_FREQ, VIS_BIT_DURATION_MS); // 偶校验
+        emit(VIS_START_STOP_FREQ, VIS_BIT_DURATION_MS);
+    }
+
+    // 每两行一组：SYNC, PORCH, Y(N), R-Y, B-Y, Y(N+1)，色差取两行平均（BT.601 studio range）
+    void emit_image() {
+        const int width = m_desc.mode.width;
+        const int height = m_desc.mode.height;
+        const PDTimings& t = m_desc.pd_timings;
+        const double pixel_ms = t.segment_ms / width;
+        std::vector<double> y1(width), y2(width), cr(width), cb(width);
+
+        for (int y = 0; y + 1 < height; y += 2) {
+            for (int x = 0; x < width; ++x) {
+                double cr_sum = 0.0, cb_sum = 0.0;
+                for (int k = 0; k < 2; ++k) {
+                    const Pixel p = test_pattern(x, y + k, width, height);
+                    (k ? y2 : y1)[x] = 16.0 + 0.256789 * p.r + 0.504129 * p.g + 0.097906 * p.b;
+                    cb_sum += 128.0 - 0.148223 * p.r - 0.290992 * p.g + 0.439215 * p.b;
+                    cr_sum += 128.0 + 0.439215 * p.r - 0.367789 * p.g - 0.071426 * p.b;
+                }
+                cr[x] = cr_sum / 2.0;
+                cb[x] = cb_sum / 2.0;
+            }
+
+            emit(SYNC_FREQ, t.sync_ms);
+            emit(BLACK_FREQ, t.porch_ms);
+            for (const auto* component : {&y1, &cr, &cb, &y2}) {
+                for (double value : *component) emit(BLACK_FREQ + value / 255.0 * FREQ_RANGE, pixel_ms);
+            }
+        }
+    }
+
+    void add_noise() {
+        if (!std::isfinite(m_options.snr_db)) return;
+        const double signal_power = m_options.amplitude * m_options.amplitude / 2.0;
+        const double noise_std = std::sqrt(signal_power / std::pow(10.0, m_options.snr_db / 10.0));
+        std::mt19937 rng(m_options.noise_seed);
+        std::normal_distribution<double> noise(0.0, noise_std);
+        for (auto& s : m_output) s += static_cast<float>(noise(rng));
+    }
+
+    const ModeDescriptor& m_desc;
+    SynthOptions m_options;
+
+    std::vector<float> m_output;
+    double m_phase = 0.0;
+    double m_time = 0.0;     // 已生成的采样数
+    double m_end_time = 0.0; // 当前段的理想结束时刻（采样数）
+};
+
+} // namespace sstv::bench
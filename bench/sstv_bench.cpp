@@ -0,0 +1,507 @@
+// bench/sstv_bench.cpp
+// 性能基准：合成 PD50/90/120/160/180/240 信号（多种采样率与信噪比），测量
+//   - 各阶段单独运行时的 ns/sample（Resampler, FIRFilter, FrequencyEstimator, VISDecoder, PDDemodulator）
+//   - 完整 Decoder 的实时倍率与每秒堆分配次数
+// 并可输出 JSON 报告，用于在版本之间发现性能回退
+#include "pd_synth.h"
+#include "dsp_filters.h"
+#include "dsp_freq_estimator.h"
+#include "dsp_resampler.h"
+#include "dsp_simd.h"
+#include "sstv_decoder.h"
+#include "sstv_pd_demodulator.h"
+#include "sstv_types.h"
+#include "sstv_vis_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// --- 堆分配计数：替换全局 operator new ---
+static std::atomic<unsigned long long> g_allocation_count{0};
+
+void* operator new(std::size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace sstv;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t BLOCK_SIZE = 1024; // 与 CLI 解码器相同的输入块大小
+
+struct BenchConfig {
+    std::vector<const ModeDescriptor*> modes;
+    std::vector<double> sample_rates{11025.0, 44100.0, 48000.0};
+    std::vector<double> snrs_db{std::numeric_limits<double>::infinity(), 20.0, 10.0};
+    int repeat = 3;
+    std::optional<std::string> json_path; // "-" 表示标准输出
+    bool verify_fused = false;            // 只做融合前端一致性校验，不测性能
+};
+
+// 一个测试用例（模式 x 采样率 x 信噪比）的测量结果
+struct CaseResult {
+    std::string_view mode;
+    double sample_rate = 0.0;
+    double snr_db = 0.0;
+    double audio_seconds = 0.0;
+
+    // 各阶段 ns/sample（按该阶段自身的输入样本计），std::nullopt 表示该阶段未运行
+    std::optional<double> resampler_ns;
+    double fir_ns = 0.0;
+    double estimator_ns = 0.0;
+    double vis_ns = 0.0;
+    double pd_ns = 0.0;
+
+    // 完整 Decoder
+    double decode_ns = 0.0;            // 每个输入样本的耗时
+    double realtime_factor = 0.0;
+    unsigned long long allocations = 0;
+    double allocations_per_second = 0.0;
+    int lines_decoded = 0;
+    bool complete = false;
+    double mean_abs_error = 0.0;       // 与原始测试图案的 RGB 平均绝对误差
+};
+
+// 重复 repeat 次取最快的一次，返回秒数。body 每次都必须从全新状态开始运行
+template <typename Body>
+double best_of(int repeat, Body&& body) {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeat; ++r) {
+        const auto t0 = Clock::now();
+        body();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+double ns_per_sample(double seconds, size_t samples) {
+    return samples ? seconds * 1e9 / static_cast<double>(samples) : 0.0;
+}
+
+CaseResult run_case(const ModeDescriptor& desc, double sample_rate, double snr_db, int repeat) {
+    CaseResult result;
+    result.mode = desc.mode.name;
+    result.sample_rate = sample_rate;
+    result.snr_db = snr_db;
+
+    bench::SynthOptions synth_options;
+    synth_options.sample_rate = sample_rate;
+    synth_options.snr_db = snr_db;
+    const std::vector<float> signal = bench::PDSynthesizer(desc, synth_options).synthesize();
+    result.audio_seconds = static_cast<double>(signal.size()) / sample_rate;
+
+    const double internal_rate = Decoder::INTERNAL_SAMPLE_RATE;
+
+    // 1. Resampler（输入采样率等于内部采样率时 Decoder 不使用重采样器）
+    std::vector<float> internal;
+    if (std::abs(sample_rate - internal_rate) > 1.0) {
+        std::vector<float> block_out;
+        const double seconds = best_of(repeat, [&] {
+            dsp::Resampler resampler(sample_rate, internal_rate);
+            block_out.resize(resampler.max_output_size(BLOCK_SIZE));
+            internal.clear();
+            for (size_t i = 0; i < signal.size(); i += BLOCK_SIZE) {
+                const size_t n = std::min(BLOCK_SIZE, signal.size() - i);
+                const size_t produced = resampler.process_into({signal.data() + i, n}, block_out);
+                internal.insert(internal.end(), block_out.begin(), block_out.begin() + produced);
+            }
+        });
+        result.resampler_ns = ns_per_sample(seconds, signal.size());
+    } else {
+        internal = signal;
+    }
+
+    // 2. FIRFilter
+    std::vector<float> filtered(internal.size());
+    result.fir_ns = ns_per_sample(best_of(repeat, [&] {
+        dsp::FIRFilter bandpass(Decoder::FIR_TAP_COUNT, internal_rate, 300.0, 3000.0);
+        for (size_t i = 0; i < internal.size(); i += BLOCK_SIZE) {
+            const size_t n = std::min(BLOCK_SIZE, internal.size() - i);
+            bandpass.process_block(internal.data() + i, filtered.data() + i, n);
+        }
+    }), internal.size());
+
+    // 3. FrequencyEstimator
+    std::vector<FreqSample> frequencies(filtered.size());
+    result.estimator_ns = ns_per_sample(best_of(repeat, [&] {
+        dsp::FrequencyEstimator estimator(internal_rate);
+        for (size_t i = 0; i < filtered.size(); i += BLOCK_SIZE) {
+            const size_t n = std::min(BLOCK_SIZE, filtered.size() - i);
+            estimator.process_block(filtered.data() + i, frequencies.data() + i, n);
+        }
+    }), filtered.size());
+
+    // 4. VISDecoder：只计入检测到 VIS 之前送入的样本（检测后 Decoder 不再调用它）
+    size_t vis_end = frequencies.size();
+    double vis_afc_offset = 0.0;
+    const double vis_seconds = best_of(repeat, [&] {
+        VISDecoder vis(internal_rate, [](const SSTVMode&) {});
+        vis_end = frequencies.size();
+        for (size_t i = 0; i < frequencies.size(); ++i) {
+            if (vis.process_frequency(frequencies[i])) {
+                vis_end = i + 1;
+                break;
+            }
+        }
+        vis_afc_offset = vis.get_afc_offset();
+    });
+    result.vis_ns = ns_per_sample(vis_seconds, vis_end);
+
+    // 5. PDDemodulator：从 VIS 结束处开始解调图像数据
+    const size_t pd_samples = filtered.size() - vis_end;
+    result.pd_ns = ns_per_sample(best_of(repeat, [&] {
+        PDDemodulator pd(internal_rate, [](int, std::span<const Pixel>) {}, [](int, int) {});
+        pd.configure(desc.mode, desc.pd_timings);
+        pd.set_afc_offset(vis_afc_offset);
+        for (size_t i = vis_end; i < filtered.size(); ++i) {
+            pd.process(filtered[i], frequencies[i]);
+        }
+    }), pd_samples);
+
+    // 6. 完整 Decoder：实时倍率、分配次数与解码质量
+    const int width = desc.mode.width;
+    const int height = desc.mode.height;
+    std::vector<Pixel> image(static_cast<size_t>(width) * height, Pixel{0, 0, 0});
+    unsigned long long allocations = 0;
+    const double decode_seconds = best_of(repeat, [&] {
+        Decoder decoder(sample_rate);
+        result.lines_decoded = 0;
+        result.complete = false;
+        decoder.set_on_line_decoded_callback([&](int line, std::span<const Pixel> pixels) {
+            ++result.lines_decoded;
+            if (line >= 0 && line < height) std::copy(pixels.begin(), pixels.end(), image.begin() + static_cast<size_t>(line) * width);
+        });
+        decoder.set_on_image_complete_callback([&](int, int) { result.complete = true; });
+
+        const auto before = g_allocation_count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < signal.size(); i += BLOCK_SIZE) {
+            decoder.process(signal.data() + i, std::min(BLOCK_SIZE, signal.size() - i));
+        }
+        allocations = g_allocation_count.load(std::memory_order_relaxed) - before;
+    });
+    result.decode_ns = ns_per_sample(decode_seconds, signal.size());
+    result.realtime_factor = result.audio_seconds / decode_seconds;
+    result.allocations = allocations;
+    result.allocations_per_second = static_cast<double>(allocations) / decode_seconds;
+
+    double error = 0.0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Pixel a = image[static_cast<size_t>(y) * width + x];
+            const Pixel b = bench::test_pattern(x, y, width, height);
+            error += std::abs(a.r - b.r) + std::abs(a.g - b.g) + std::abs(a.b - b.b);
+        }
+    }
+    result.mean_abs_error = error / (3.0 * width * height);
+    return result;
+}
+
+// --- 融合前端一致性校验（--verify-fused）---
+// 同一段信号分别走逐阶段整块路径与 FusedFrontEnd 路径，比较解码出的行数、完成的图像数与全部行像素的哈希
+
+struct VerifyDecode {
+    int lines = 0;
+    int images = 0;
+    uint64_t hash = 14695981039346656037ull; // FNV-1a：行号 + 行像素
+
+    bool operator==(const VerifyDecode&) const = default;
+};
+
+// reset_at_sample：在此位置之后的第一个块边界、两次 process() 之间调用 reset()
+// reset_at_line：在第一次解码到该行时从行回调中调用 reset()，只比较其后的输出
+//   （块内 reset 在融合路径下于下一个 tile 生效，reset 之后残余的几个样本两条路径不同，
+//    但都处于 VIS 搜索状态，不影响后续图像）
+VerifyDecode verify_decode(const std::vector<float>& signal, double sample_rate, bool fused, size_t block_size,
+                           size_t reset_at_sample, int reset_at_line) {
+    Decoder decoder(sample_rate);
+    decoder.set_fused_pipeline_enabled(fused);
+    VerifyDecode result;
+    bool line_reset_done = false;
+    decoder.set_on_line_decoded_callback([&](int line, std::span<const Pixel> pixels) {
+        ++result.lines;
+        auto mix = [&](uint8_t byte) { result.hash = (result.hash ^ byte) * 1099511628211ull; };
+        for (int shift = 0; shift < 32; shift += 8) mix(static_cast<uint8_t>(static_cast<uint32_t>(line) >> shift));
+        for (const Pixel& p : pixels) {
+            mix(p.r);
+            mix(p.g);
+            mix(p.b);
+        }
+        if (line == reset_at_line && !line_reset_done) {
+            line_reset_done = true;
+            decoder.reset();
+            result = {};
+        }
+    });
+    decoder.set_on_image_complete_callback([&](int, int) { ++result.images; });
+
+    bool sample_reset_done = false;
+    for (size_t i = 0; i < signal.size(); i += block_size) {
+        if (!sample_reset_done && i >= reset_at_sample) {
+            sample_reset_done = true;
+            decoder.reset();
+        }
+        decoder.process(signal.data() + i, std::min(block_size, signal.size() - i));
+    }
+    return result;
+}
+
+// 返回不一致的用例数
+int verify_fused_case(const ModeDescriptor& desc, double sample_rate, double snr_db, FILE* out) {
+    bench::SynthOptions synth_options;
+    synth_options.sample_rate = sample_rate;
+    synth_options.snr_db = snr_db;
+    const std::vector<float> single = bench::PDSynthesizer(desc, synth_options).synthesize();
+    // 两次连续发送：reset 之后还要能解码第二幅图像
+    std::vector<float> twice = single;
+    synth_options.noise_seed += 1;
+    const std::vector<float> second = bench::PDSynthesizer(desc, synth_options).synthesize();
+    twice.insert(twice.end(), second.begin(), second.end());
+
+    constexpr size_t NO_RESET = std::numeric_limits<size_t>::max();
+    struct Scenario {
+        const char* name;
+        const std::vector<float>* signal;
+        size_t block_size;
+        size_t reset_at_sample;
+        int reset_at_line;
+    };
+    const int reset_line = desc.mode.height / 4;
+    const Scenario scenarios[] = {
+        {"stream", &single, BLOCK_SIZE, NO_RESET, -1},
+        {"odd-blocks", &single, 333, NO_RESET, -1},
+        {"whole", &single, single.size(), NO_RESET, -1},
+        {"reset-between", &twice, BLOCK_SIZE, single.size() / 2, -1},
+        {"reset-in-callback", &twice, BLOCK_SIZE, NO_RESET, reset_line},
+    };
+
+    char snr[16];
+    if (std::isfinite(snr_db)) std::snprintf(snr, sizeof(snr), "%.0f dB", snr_db);
+    else std::snprintf(snr, sizeof(snr), "clean");
+
+    int failures = 0;
+    for (const Scenario& sc : scenarios) {
+        const VerifyDecode separate = verify_decode(*sc.signal, sample_rate, false, sc.block_size, sc.reset_at_sample, sc.reset_at_line);
+        const VerifyDecode fused = verify_decode(*sc.signal, sample_rate, true, sc.block_size, sc.reset_at_sample, sc.reset_at_line);
+        // 相同之外还要求确实解码出了图像，否则两条路径“一致地失败”也会通过
+        const bool ok = separate == fused && separate.lines > 0 && separate.images > 0;
+        failures += ok ? 0 : 1;
+        std::fprintf(out, "%-6s %6.0f %7s %-17s | separate %4d lines %d images %016llx | fused %4d lines %d images %016llx | %s\n",
+                     std::string(desc.mode.name).c_str(), sample_rate, snr, sc.name,
+                     separate.lines, separate.images, static_cast<unsigned long long>(separate.hash),
+                     fused.lines, fused.images, static_cast<unsigned long long>(fused.hash), ok ? "ok" : "MISMATCH");
+        std::fflush(out);
+    }
+    return failures;
+}
+
+const char* simd_name() {
+#if defined(SSTV_SIMD_AVX2)
+    return "avx2";
+#elif defined(SSTV_SIMD_SSE2)
+    return "sse2";
+#elif defined(SSTV_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// JSON 数值：非有限值（无噪声时的 SNR、未运行的阶段）输出为 null
+std::string json_number(std::optional<double> value) {
+    if (!value || !std::isfinite(*value)) return "null";
+    std::ostringstream os;
+    os.precision(6);
+    os << *value;
+    return os.str();
+}
+
+void write_json(std::ostream& os, const std::vector<CaseResult>& results, int repeat) {
+    os << "{\n"
+       << "  \"schema_version\": 1,\n"
+       << "  \"build\": {\"simd\": \"" << simd_name() << "\", \"float32_pipeline\": "
+       << (std::is_same_v<FreqSample, float> ? "true" : "false") << ", \"block_size\": " << BLOCK_SIZE
+       << ", \"repeat\": " << repeat << "},\n"
+       << "  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CaseResult& r = results[i];
+        os << "    {\"mode\": \"" << r.mode << "\", \"sample_rate\": " << json_number(r.sample_rate)
+           << ", \"snr_db\": " << json_number(r.snr_db) << ", \"audio_seconds\": " << json_number(r.audio_seconds) << ",\n"
+           << "     \"stages_ns_per_sample\": {\"resampler\": " << json_number(r.resampler_ns)
+           << ", \"fir_filter\": " << json_number(r.fir_ns) << ", \"frequency_estimator\": " << json_number(r.estimator_ns)
+           << ", \"vis_decoder\": " << json_number(r.vis_ns) << ", \"pd_demodulator\": " << json_number(r.pd_ns) << "},\n"
+           << "     \"decoder_ns_per_sample\": " << json_number(r.decode_ns)
+           << ", \"realtime_factor\": " << json_number(r.realtime_factor)
+           << ", \"allocations\": " << r.allocations
+           << ", \"allocations_per_second\": " << json_number(r.allocations_per_second) << ",\n"
+           << "     \"lines_decoded\": " << r.lines_decoded << ", \"complete\": " << (r.complete ? "true" : "false")
+           << ", \"mean_abs_error\": " << json_number(r.mean_abs_error) << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+void print_row(FILE* out, const CaseResult& r) {
+    char snr[16];
+    if (std::isfinite(r.snr_db)) std::snprintf(snr, sizeof(snr), "%.0f dB", r.snr_db);
+    else std::snprintf(snr, sizeof(snr), "clean");
+    char resampler[16];
+    if (r.resampler_ns) std::snprintf(resampler, sizeof(resampler), "%9.2f", *r.resampler_ns);
+    else std::snprintf(resampler, sizeof(resampler), "%9s", "-");
+
+    std::fprintf(out, "%-6s %6.0f %7s | %s %9.2f %9.2f %9.2f %9.2f | %8.1fx %10.1f | %4d %s %6.3f\n",
+                std::string(r.mode).c_str(), r.sample_rate, snr, resampler, r.fir_ns, r.estimator_ns,
+                r.vis_ns, r.pd_ns, r.realtime_factor, r.allocations_per_second,
+                r.lines_decoded, r.complete ? "yes" : " no", r.mean_abs_error);
+}
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--modes PD120,PD50,...] [--rates 11025,44100,...] [--snr clean,20,10]\n"
+              << "       [--repeat N] [--quick] [--json [path]] [--verify-fused]\n"
+              << "  --modes   Modes to synthesize (default: all PD modes)\n"
+              << "  --rates   Input sample rates in Hz (default 11025,44100,48000)\n"
+              << "  --snr     Signal-to-noise ratios in dB, 'clean' for no noise (default clean,20,10)\n"
+              << "  --repeat  Runs per measurement, the fastest is reported (default 3)\n"
+              << "  --quick   PD120 at 48000 Hz, clean, one run\n"
+              << "  --json    Write a JSON report to path, or to stdout if no path is given\n"
+              << "  --verify-fused  Check that the fused front end decodes exactly like the separate stages\n"
+              << "                  (including reset() mid-stream); exits with 1 on any mismatch" << std::endl;
+}
+
+std::vector<std::string> split_list(const std::string& arg) {
+    std::vector<std::string> items;
+    std::stringstream ss(arg);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<const ModeDescriptor*> all_pd_modes() {
+    std::vector<const ModeDescriptor*> modes;
+    for (const auto& desc : MODE_TABLE) {
+        if (desc.mode.family == SSTVFamily::PD) modes.push_back(&desc);
+    }
+    return modes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.modes = all_pd_modes();
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc && !std::string_view(argv[i + 1]).starts_with("--");
+            if (arg == "--modes" && has_value) {
+                config.modes.clear();
+                for (const auto& name : split_list(argv[++i])) {
+                    auto it = std::find_if(MODE_TABLE.begin(), MODE_TABLE.end(),
+                                           [&](const ModeDescriptor& d) { return d.mode.name == name; });
+                    if (it == MODE_TABLE.end() || it->mode.family != SSTVFamily::PD) {
+                        std::cerr << "Unknown PD mode: " << name << std::endl;
+                        return 1;
+                    }
+                    config.modes.push_back(&*it);
+                }
+            } else if (arg == "--rates" && has_value) {
+                config.sample_rates.clear();
+                for (const auto& rate : split_list(argv[++i])) config.sample_rates.push_back(std::stod(rate));
+            } else if (arg == "--snr" && has_value) {
+                config.snrs_db.clear();
+                for (const auto& snr : split_list(argv[++i])) {
+                    config.snrs_db.push_back(snr == "clean" ? std::numeric_limits<double>::infinity() : std::stod(snr));
+                }
+            } else if (arg == "--repeat" && has_value) {
+                config.repeat = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--quick") {
+                config.modes = {find_mode(95)};
+                config.sample_rates = {48000.0};
+                config.snrs_db = {std::numeric_limits<double>::infinity()};
+                config.repeat = 1;
+            } else if (arg == "--verify-fused") {
+                config.verify_fused = true;
+            } else if (arg == "--json") {
+                config.json_path = has_value ? std::string(argv[++i]) : std::string("-");
+            } else {
+                print_usage(argv[0]);
+                return arg == "--help" || arg == "-h" ? 0 : 1;
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (config.verify_fused) {
+        int failures = 0;
+        for (const ModeDescriptor* desc : config.modes) {
+            for (double rate : config.sample_rates) {
+                for (double snr : config.snrs_db) failures += verify_fused_case(*desc, rate, snr, stdout);
+            }
+        }
+        std::printf("%s: %d mismatching case(s)\n", failures ? "FAILED" : "PASSED", failures);
+        return failures ? 1 : 0;
+    }
+
+    // JSON 写到标准输出时，表格改写到标准错误，保证 stdout 可直接被解析
+    const bool json_to_stdout = config.json_path && *config.json_path == "-";
+    FILE* table = json_to_stdout ? stderr : stdout;
+    std::fprintf(table, "SIMD: %s, frequency pipeline: %s, repeat: %d\n", simd_name(),
+                 std::is_same_v<FreqSample, float> ? "float32" : "float64", config.repeat);
+    std::fprintf(table, "%-6s %6s %7s | %9s %9s %9s %9s %9s | %9s %10s | %4s %3s %6s\n",
+                 "mode", "rate", "snr", "resample", "fir", "estimate", "vis", "pd",
+                 "realtime", "allocs/s", "line", "ok", "mae");
+    std::fprintf(table, "%-21s | %49s |\n", "", "ns/sample");
+    std::fflush(table);
+
+    std::vector<CaseResult> results;
+    for (const ModeDescriptor* desc : config.modes) {
+        for (double rate : config.sample_rates) {
+            for (double snr : config.snrs_db) {
+                results.push_back(run_case(*desc, rate, snr, config.repeat));
+                print_row(table, results.back());
+                std::fflush(table);
+            }
+        }
+    }
+
+    if (config.json_path) {
+        if (json_to_stdout) {
+            write_json(std::cout, results, config.repeat);
+        } else {
+            std::ofstream out(*config.json_path);
+            if (!out) {
+                std::cerr << "Cannot write " << *config.json_path << std::endl;
+                return 1;
+            }
+            write_json(out, results, config.repeat);
+            std::cout << "JSON report written to " << *config.json_path << std::endl;
+        }
+    }
+    return 0;
+}
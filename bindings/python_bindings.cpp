@@ -3,14 +3,379 @@
 #include <pybind11/functional.h> // 自动转换 std::function
 #include <pybind11/numpy.h>      // 处理 Python 的 NumPy 数组 (代替 float*)
 
+#include "sstv_batch_decoder.h"
+#include "sstv_channelized_decoder.h"
 #include "sstv_decoder.h"
+#include "sstv_decoder_pool.h"
+#include "sstv_freq_track.h"
+#include "sstv_image_writer.h"
+#include "sstv_stream_decoder.h"
 #include "sstv_types.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
 namespace py = pybind11;
 using namespace sstv;
 
+static_assert(sizeof(Pixel) == 3, "Pixel must be tightly packed RGB for NumPy views");
+
+// 析构 DecoderPool / StreamDecoder 时需要 join 工作线程，而工作线程可能正在等待 GIL 执行回调
+struct GilReleasingDeleter {
+    template <typename T>
+    void operator()(T* object) const {
+        py::gil_scoped_release release;
+        delete object;
+    }
+};
+
+// Python 端的 Decoder
+//
+// process() 在 DSP 运行期间释放 GIL，多个 Python 线程可以并行解码各自的 Decoder。
+// 解码器回调此时不能进入 Python，因此先把事件（连同行像素副本）缓存到本次调用的
+// CallbackBatch 中，process() 重新获得 GIL 后再按发生顺序统一派发。
+// 同一个 Decoder 被多个线程同时调用时，由 m_mutex 串行化
+class PyDecoder {
+public:
+    PyDecoder(double sample_rate, dsp::ResamplerMode resampler) : m_decoder(sample_rate, resampler) {
+        m_decoder.set_on_mode_detected_callback([this](const SSTVMode& mode) {
+            if (!m_batch) return;
+            // 新图像会清空并复用 frame：尚未派发的 LINE_READY 所指的行已不在 frame 中，直接丢弃
+            std::erase_if(m_batch->events, [](const Event& event) { return event.kind == EventKind::LINE_READY; });
+            if (!m_has_mode_cb) return;
+            m_batch->events.push_back({EventKind::MODE_DETECTED, static_cast<int>(m_batch->modes.size()), 0, 0, 0});
+            m_batch->modes.push_back(mode);
+        });
+        m_decoder.set_on_line_decoded_callback([this](int line_idx, std::span<const Pixel> pixels) {
+            if (!m_batch || !m_has_line_cb) return;
+            m_batch->events.push_back({EventKind::LINE_DECODED, line_idx, 0, m_batch->pixels.size(), pixels.size()});
+            m_batch->pixels.insert(m_batch->pixels.end(), pixels.begin(), pixels.end());
+        });
+        m_decoder.set_on_line_ready_callback([this](int line_idx) {
+            if (!m_batch || !m_has_line_ready_cb) return;
+            m_batch->events.push_back({EventKind::LINE_READY, line_idx, 0, 0, 0});
+        });
+        m_decoder.set_on_image_complete_callback([this](int width, int height) {
+            if (!m_batch || !m_has_complete_cb) return;
+            m_batch->events.push_back({EventKind::IMAGE_COMPLETE, width, height, 0, 0});
+        });
+        m_decoder.set_on_image_finished_callback([this](const FrameInfo& info) {
+            if (!m_batch || !m_has_finished_cb) return;
+            m_batch->events.push_back({EventKind::IMAGE_FINISHED, static_cast<int>(m_batch->frames.size()), 0, 0, 0});
+            m_batch->frames.push_back(info);
+        });
+    }
+
+    void process(const py::array_t<float, py::array::c_style | py::array::forcecast>& samples) {
+        py::buffer_info buf = samples.request();
+        if (buf.ndim != 1) {
+            throw std::runtime_error("Buffer must be 1D");
+        }
+
+        run_batched([&] {
+            m_decoder.process(static_cast<const float*>(buf.ptr), static_cast<size_t>(buf.shape[0]));
+        });
+    }
+
+    // THROUGHPUT 模式下暂存的样本同样可能触发回调
+    void flush() {
+        run_batched([&] { m_decoder.flush(); });
+    }
+
+    // 频率轨迹文件同样在释放 GIL 后回放，事件按 process() 的方式派发
+    void replay_track(const std::string& path) {
+        run_batched([&] {
+            FreqTrackReader track(path);
+            m_decoder.replay(track);
+        });
+    }
+
+    void set_freq_track_writer(FreqTrackWriter* writer) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_freq_track_writer(writer);
+    }
+
+    void set_image_writer(ImageWriter* writer) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_image_writer(writer);
+    }
+
+    void reset() {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.reset();
+    }
+
+    void set_discriminator_mode(dsp::DiscriminatorMode mode) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_discriminator_mode(mode);
+    }
+
+    void set_tone_gate_enabled(bool enabled) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_tone_gate_enabled(enabled);
+    }
+
+    void set_vis_engine(VISEngine engine) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_vis_engine(engine);
+    }
+
+    void set_sync_mode(SyncMode mode) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_sync_mode(mode);
+    }
+
+    // 切换时会先解码暂存的样本，可能触发回调
+    void set_processing_mode(ProcessingMode mode) {
+        run_batched([&] { m_decoder.set_processing_mode(mode); });
+    }
+
+    void set_frame_buffer_enabled(bool enabled) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_frame_buffer_enabled(enabled);
+    }
+
+    void set_frame_manager_enabled(bool enabled, size_t slots) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_frame_manager_enabled(enabled, slots);
+        m_frame_manager.store(m_decoder.frame_manager(), std::memory_order_release);
+    }
+
+    // FrameManager 自带锁，不经过 m_mutex，process() 运行期间其他线程也可以取帧
+    std::unique_ptr<FrameManager::Frame> acquire_frame(std::optional<double> timeout) {
+        FrameManager* manager = m_frame_manager.load(std::memory_order_acquire);
+        if (!manager) throw std::runtime_error("Frame manager is not enabled");
+        py::gil_scoped_release release;
+        FrameManager::Frame frame = timeout
+            ? manager->wait_acquire(std::chrono::milliseconds(static_cast<int64_t>(std::max(*timeout, 0.0) * 1000.0)))
+            : manager->try_acquire();
+        if (!frame) return nullptr;
+        return std::make_unique<FrameManager::Frame>(std::move(frame));
+    }
+
+    uint64_t dropped_frames() const {
+        const FrameManager* manager = m_frame_manager.load(std::memory_order_acquire);
+        return manager ? manager->dropped_frames() : 0;
+    }
+
+    void cancel_image() {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.cancel_image();
+    }
+
+    void set_image_timeout_lines(int lines) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.set_image_timeout_lines(lines);
+    }
+
+    // 计数器只做 relaxed 原子读取，不加锁，其他 Python 线程可在 process 运行期间随时读取
+    DecoderStats stats() const { return m_decoder.stats(); }
+
+    void reset_stats() {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.reset_stats();
+    }
+
+    // 跟踪记录不是原子快照，与 process 共用同一把锁
+    std::string dump_trace() {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        std::ostringstream out;
+        m_decoder.dump_trace(out);
+        return out.str();
+    }
+
+    void clear_trace() {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        m_decoder.clear_trace();
+    }
+
+    // 回调对象只在持有 GIL 时读写；无 GIL 的解码线程只看原子标志
+    void set_on_mode_detected_callback(py::object cb) { set_callback(m_on_mode_detected, m_has_mode_cb, std::move(cb)); }
+    void set_on_line_decoded_callback(py::object cb) { set_callback(m_on_line_decoded, m_has_line_cb, std::move(cb)); }
+    void set_on_line_ready_callback(py::object cb) { set_callback(m_on_line_ready, m_has_line_ready_cb, std::move(cb)); }
+    void set_on_image_complete_callback(py::object cb) { set_callback(m_on_image_complete, m_has_complete_cb, std::move(cb)); }
+    void set_on_image_finished_callback(py::object cb) { set_callback(m_on_image_finished, m_has_finished_cb, std::move(cb)); }
+
+    const Decoder& decoder() const { return m_decoder; }
+
+private:
+    enum class EventKind { MODE_DETECTED, LINE_DECODED, LINE_READY, IMAGE_COMPLETE, IMAGE_FINISHED };
+
+    struct Event {
+        EventKind kind;
+        int a;          // mode 序号 / 行号 / 宽度 / FrameInfo 序号
+        int b;          // 高度
+        size_t offset;  // 行像素在 CallbackBatch::pixels 中的起点
+        size_t count;
+    };
+
+    struct CallbackBatch {
+        std::vector<Event> events;
+        std::vector<SSTVMode> modes;
+        std::vector<Pixel> pixels;
+        std::vector<FrameInfo> frames;
+    };
+
+    // 不持有 GIL 执行 work，期间的解码器事件缓存到 CallbackBatch，重新获得 GIL 后统一派发
+    template <typename Work>
+    void run_batched(Work&& work) {
+        CallbackBatch batch;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard lock(m_mutex);
+            m_batch = &batch;
+            try {
+                work();
+            } catch (...) {
+                m_batch = nullptr;
+                throw;
+            }
+            m_batch = nullptr;
+        }
+        dispatch(batch);
+    }
+
+    static void set_callback(py::object& slot, std::atomic<bool>& flag, py::object cb) {
+        slot = std::move(cb);
+        flag.store(!slot.is_none(), std::memory_order_release);
+    }
+
+    // 持有 GIL 时调用；某个回调抛出异常时，其余事件被丢弃，异常传给 process() 的调用方
+    void dispatch(const CallbackBatch& batch) {
+        for (const Event& event : batch.events) {
+            switch (event.kind) {
+                case EventKind::MODE_DETECTED:
+                    if (!m_on_mode_detected.is_none()) m_on_mode_detected(batch.modes[static_cast<size_t>(event.a)]);
+                    break;
+                case EventKind::LINE_DECODED:
+                    if (!m_on_line_decoded.is_none()) {
+                        auto first = batch.pixels.begin() + static_cast<std::ptrdiff_t>(event.offset);
+                        m_on_line_decoded(event.a, std::vector<Pixel>(first, first + static_cast<std::ptrdiff_t>(event.count)));
+                    }
+                    break;
+                case EventKind::LINE_READY:
+                    if (!m_on_line_ready.is_none()) m_on_line_ready(event.a);
+                    break;
+                case EventKind::IMAGE_COMPLETE:
+                    if (!m_on_image_complete.is_none()) m_on_image_complete(event.a, event.b);
+                    break;
+                case EventKind::IMAGE_FINISHED:
+                    if (!m_on_image_finished.is_none()) m_on_image_finished(batch.frames[static_cast<size_t>(event.a)]);
+                    break;
+            }
+        }
+    }
+
+    Decoder m_decoder;
+    std::mutex m_mutex;
+    CallbackBatch* m_batch = nullptr; // 仅在 process() 期间有效
+    std::atomic<FrameManager*> m_frame_manager{nullptr}; // 创建后不再改变
+
+    py::object m_on_mode_detected = py::none();
+    py::object m_on_line_decoded = py::none();
+    py::object m_on_line_ready = py::none();
+    py::object m_on_image_complete = py::none();
+    py::object m_on_image_finished = py::none();
+    std::atomic<bool> m_has_mode_cb{false};
+    std::atomic<bool> m_has_line_cb{false};
+    std::atomic<bool> m_has_line_ready_cb{false};
+    std::atomic<bool> m_has_complete_cb{false};
+    std::atomic<bool> m_has_finished_cb{false};
+};
+
+// Python 端的 ChannelizedDecoder
+//
+// process() / flush() / reset() 在解码期间释放 GIL，回调经 pybind11 的函数包装重新获得 GIL 后直接调用。
+// 对同一对象的并发调用由 m_mutex 串行化：每个入口都先释放 GIL 再加锁，顺序固定，
+// 不会与正在等待 GIL 的回调互相死锁；递归锁允许回调中调用同一对象的 setter
+class PyChannelizedDecoder {
+public:
+    PyChannelizedDecoder(double sample_rate, std::vector<double> offsets, double max_channel_spacing,
+                         dsp::ResamplerMode resampler)
+        : m_decoder(sample_rate, std::move(offsets), max_channel_spacing, resampler) {}
+
+    void process(const py::array_t<float, py::array::c_style | py::array::forcecast>& samples) {
+        py::buffer_info buf = samples.request();
+        if (buf.ndim != 1) {
+            throw std::runtime_error("Buffer must be 1D");
+        }
+        locked([&] { m_decoder.process(static_cast<const float*>(buf.ptr), static_cast<size_t>(buf.shape[0])); });
+    }
+
+    void flush() { locked([&] { m_decoder.flush(); }); }
+    void reset() { locked([&] { m_decoder.reset(); }); }
+
+    // 信道数、采样率与信道偏移在构造后不变，统计计数器为原子量，均不经过 m_mutex
+    [[nodiscard]] const ChannelizedDecoder& decoder() const { return m_decoder; }
+    [[nodiscard]] double signal_offset(size_t channel) {
+        return locked([&] { return m_decoder.signal_offset(channel); });
+    }
+
+    void set_tone_gate_enabled(bool enabled) { locked([&] { m_decoder.set_tone_gate_enabled(enabled); }); }
+    void set_vis_engine(VISEngine engine) { locked([&] { m_decoder.set_vis_engine(engine); }); }
+    void set_sync_mode(SyncMode mode) { locked([&] { m_decoder.set_sync_mode(mode); }); }
+    void set_image_timeout_lines(int lines) { locked([&] { m_decoder.set_image_timeout_lines(lines); }); }
+    void set_image_writer(size_t channel, ImageWriter* writer) {
+        locked([&] { m_decoder.decoder(channel).set_image_writer(writer); });
+    }
+
+    void set_on_mode_detected_callback(ChannelModeDetectedCallback cb) {
+        locked([&] { m_decoder.set_on_mode_detected_callback(std::move(cb)); });
+    }
+    // 行像素以 span 传出，只在回调期间有效，这里转成 Pixel 列表交给 Python
+    void set_on_line_decoded_callback(std::function<void(size_t, int, const std::vector<Pixel>&)> cb) {
+        ChannelLineDecodedCallback wrapped;
+        if (cb) {
+            wrapped = [cb = std::move(cb)](size_t channel, int line_idx, std::span<const Pixel> pixels) {
+                cb(channel, line_idx, std::vector<Pixel>(pixels.begin(), pixels.end()));
+            };
+        }
+        locked([&] { m_decoder.set_on_line_decoded_callback(std::move(wrapped)); });
+    }
+    void set_on_image_complete_callback(ChannelImageCompleteCallback cb) {
+        locked([&] { m_decoder.set_on_image_complete_callback(std::move(cb)); });
+    }
+
+private:
+    template <typename Work>
+    std::invoke_result_t<Work&> locked(Work&& work) {
+        py::gil_scoped_release release;
+        std::lock_guard lock(m_mutex);
+        return work();
+    }
+
+    ChannelizedDecoder m_decoder;
+    std::recursive_mutex m_mutex;
+};
+
 PYBIND11_MODULE(_core, m) {
     m.doc() = "SSTV Decoder Python Bindings (C++23)";
+    // 编译期选择的频率链路精度（SSTV_FLOAT32_PIPELINE）
+    m.attr("FLOAT32_PIPELINE") = std::is_same_v<FreqSample, float>;
+    // 监控计数器是否编译进来（SSTV_ENABLE_STATS）
+    m.attr("STATS_ENABLED") = STATS_ENABLED;
+    // 逐样本状态跟踪是否编译进来（SSTV_ENABLE_TRACE）
+    m.attr("TRACE_ENABLED") = TRACE_ENABLED;
 
     // 1. 绑定结构体 Pixel
     py::class_<Pixel>(m, "Pixel")
@@ -37,24 +402,405 @@ PYBIND11_MODULE(_core, m) {
         .def_readonly("duration_s", &SSTVMode::duration_s)
         .def_readonly("family", &SSTVMode::family);
 
-    // 3. 核心类 Decoder 的封装
-    py::class_<Decoder>(m, "Decoder")
-        .def(py::init<double>(), py::arg("sample_rate"))
+    py::enum_<dsp::DiscriminatorMode>(m, "DiscriminatorMode")
+        .value("ATAN2", dsp::DiscriminatorMode::ATAN2)
+        .value("FAST_ATAN2", dsp::DiscriminatorMode::FAST_ATAN2);
+
+    py::enum_<dsp::ResamplerMode>(m, "ResamplerMode")
+        .value("LIBSAMPLERATE", dsp::ResamplerMode::LIBSAMPLERATE)
+        .value("POLYPHASE", dsp::ResamplerMode::POLYPHASE);
+
+    py::enum_<VISEngine>(m, "VISEngine")
+        .value("FM", VISEngine::FM)
+        .value("GOERTZEL", VISEngine::GOERTZEL);
+
+    py::enum_<TrackEncoding>(m, "TrackEncoding")
+        .value("FLOAT32", TrackEncoding::FLOAT32)
+        .value("INT16", TrackEncoding::INT16);
+
+    // 频率轨迹录制：由 Decoder.set_freq_track_writer() 挂接，close() 或析构时写出最后一个块
+    py::class_<FreqTrackWriter>(m, "FreqTrackWriter")
+        .def(py::init([](const std::string& path, TrackEncoding encoding, size_t chunk_samples) {
+                 return std::make_unique<FreqTrackWriter>(path, Decoder::INTERNAL_SAMPLE_RATE, encoding, chunk_samples);
+             }),
+             py::arg("path"), py::arg("encoding") = TrackEncoding::FLOAT32,
+             py::arg("chunk_samples") = FreqTrackWriter::DEFAULT_CHUNK_SAMPLES)
+        .def("close", &FreqTrackWriter::close)
+        .def("__enter__", [](FreqTrackWriter& self) -> FreqTrackWriter& { return self; },
+             py::return_value_policy::reference)
+        .def("__exit__", [](FreqTrackWriter& self, const py::args&) { self.close(); })
+        .def_property_readonly("encoding", &FreqTrackWriter::encoding)
+        .def_property_readonly("samples_written", &FreqTrackWriter::samples_written);
+
+    py::enum_<ImageFormat>(m, "ImageFormat")
+        .value("RAW", ImageFormat::RAW)
+        .value("PNG", ImageFormat::PNG);
+
+    // 异步图像输出：由 Decoder.set_image_writer() 挂接，行像素交给后台线程逐行编码（PNG）或写入映射文件（raw）。
+    // 后台线程执行 Python 回调时需要 GIL，析构与 flush() 等待期间释放 GIL
+    py::class_<ImageWriter, std::unique_ptr<ImageWriter, GilReleasingDeleter>>(m, "ImageWriter")
+        .def(py::init([](const std::string& path, std::optional<ImageFormat> format, size_t queue_lines) {
+                 return std::unique_ptr<ImageWriter, GilReleasingDeleter>(
+                     new ImageWriter(path, format.value_or(ImageWriter::format_for_path(path)), queue_lines));
+             }),
+             py::arg("path"), py::arg("format") = py::none(), py::arg("queue_lines") = ImageWriter::DEFAULT_QUEUE_LINES)
+        .def("flush", &ImageWriter::flush, py::call_guard<py::gil_scoped_release>(),
+             "Wait until every queued image is written; raises the first write error")
+        .def("path_for", &ImageWriter::path_for, py::arg("sequence"))
+        // 解码文件（非实时输入）时打开：队列满时解码线程等待，而不是丢行
+        .def("set_wait_when_full", &ImageWriter::set_wait_when_full, py::arg("wait") = true)
+        .def_property_readonly("wait_when_full", &ImageWriter::wait_when_full)
+        // 回调在后台线程中执行，参数为 (path, FrameInfo)，须在第一幅图像之前设置
+        .def("set_on_image_written_callback", &ImageWriter::set_on_image_written_callback)
+        .def_property_readonly("format", &ImageWriter::format)
+        .def_property_readonly("images_written", &ImageWriter::images_written)
+        .def_property_readonly("images_dropped", &ImageWriter::images_dropped)
+        .def_property_readonly("lines_dropped", &ImageWriter::lines_dropped)
+        .def_property_readonly("queued_events", &ImageWriter::queued_events);
+
+    py::enum_<ProcessingMode>(m, "ProcessingMode")
+        .value("BALANCED", ProcessingMode::BALANCED)
+        .value("LOW_LATENCY", ProcessingMode::LOW_LATENCY)
+        .value("THROUGHPUT", ProcessingMode::THROUGHPUT);
+
+    py::enum_<SyncMode>(m, "SyncMode")
+        .value("THRESHOLD", SyncMode::THRESHOLD)
+        .value("CORRELATION", SyncMode::CORRELATION);
+
+    py::enum_<FrameStatus>(m, "FrameStatus")
+        .value("COMPLETE", FrameStatus::COMPLETE)
+        .value("CANCELLED", FrameStatus::CANCELLED)
+        .value("TIMED_OUT", FrameStatus::TIMED_OUT);
+
+    py::class_<FrameInfo>(m, "FrameInfo")
+        .def_readonly("mode", &FrameInfo::mode)
+        .def_readonly("width", &FrameInfo::width)
+        .def_readonly("height", &FrameInfo::height)
+        .def_readonly("lines_decoded", &FrameInfo::lines_decoded)
+        .def_readonly("status", &FrameInfo::status)
+        .def_readonly("sequence", &FrameInfo::sequence);
+
+    // 帧管理器中的一帧：持有期间解码器不会覆盖这块缓冲区
+    py::class_<FrameManager::Frame>(m, "Frame")
+        .def_property_readonly("info", [](const FrameManager::Frame& self) {
+            if (!self) throw std::runtime_error("Frame was released");
+            return self.info();
+        })
+        // (height, width, 3) uint8 视图，base 为 Frame 对象；release() 之后视图失效，需要保留时先 copy()
+        .def_property_readonly("pixels", [](py::object self) {
+            const auto& frame = self.cast<const FrameManager::Frame&>();
+            if (!frame) throw std::runtime_error("Frame was released");
+            const auto height = static_cast<py::ssize_t>(frame.info().height);
+            const auto width = static_cast<py::ssize_t>(frame.info().width);
+            return py::array_t<uint8_t>({height, width, py::ssize_t{3}}, {width * 3, py::ssize_t{3}, py::ssize_t{1}},
+                                        reinterpret_cast<const uint8_t*>(frame.pixels().data()), self);
+        })
+        .def("release", &FrameManager::Frame::release, "Return the buffer to the decoder")
+        .def("__bool__", [](const FrameManager::Frame& self) { return static_cast<bool>(self); });
+
+    // 监控计数器快照（Decoder.stats() / DecoderPool.channel_stats()）
+    py::class_<DecoderStats>(m, "DecoderStats")
+        .def_readonly("samples_processed", &DecoderStats::samples_processed)
+        .def_readonly("gated_samples", &DecoderStats::gated_samples)
+        .def_readonly("gate_openings", &DecoderStats::gate_openings)
+        .def_readonly("resampler_ns", &DecoderStats::resampler_ns)
+        .def_readonly("bandpass_ns", &DecoderStats::bandpass_ns)
+        .def_readonly("estimator_ns", &DecoderStats::estimator_ns)
+        .def_readonly("state_machine_ns", &DecoderStats::state_machine_ns)
+        .def_readonly("fused_front_end_ns", &DecoderStats::fused_front_end_ns)
+        // {VIS 状态名: 在该状态下放弃的 VIS 头数}
+        .def_property_readonly("vis_resets", [](const DecoderStats& s) {
+            py::dict resets;
+            for (size_t i = 0; i < VISDecoder::STATE_COUNT; ++i) {
+                resets[py::str(std::string(VISDecoder::state_name(static_cast<VISDecoder::State>(i))))] = s.vis_resets[i];
+            }
+            return resets;
+        })
+        .def_readonly("vis_parity_errors", &DecoderStats::vis_parity_errors)
+        .def_readonly("vis_headers_decoded", &DecoderStats::vis_headers_decoded)
+        .def_readonly("vis_unknown_modes", &DecoderStats::vis_unknown_modes)
+        .def_readonly("pd_syncs_detected", &DecoderStats::pd_syncs_detected)
+        .def_readonly("pd_sync_timeouts", &DecoderStats::pd_sync_timeouts)
+        .def_readonly("lines_emitted", &DecoderStats::lines_emitted)
+        .def_readonly("images_completed", &DecoderStats::images_completed)
+        .def_readonly("images_cancelled", &DecoderStats::images_cancelled)
+        .def_readonly("images_timed_out", &DecoderStats::images_timed_out)
+        .def_readonly("afc_offset", &DecoderStats::afc_offset);
+
+    // 3. 核心类 Decoder 的封装（实际绑定的是 PyDecoder，见上文）
+    py::class_<PyDecoder>(m, "Decoder")
+        .def(py::init<double, dsp::ResamplerMode>(), py::arg("sample_rate"),
+             py::arg("resampler") = dsp::ResamplerMode::LIBSAMPLERATE)
 
         // 关键：将 process(const float*, size_t) 封装为接受 NumPy 数组的接口
-        .def("process", [](Decoder &self, const py::array_t<float>& samples) {
+        // DSP 运行期间释放 GIL，回调在返回前统一派发
+        .def("process", &PyDecoder::process, py::arg("samples"), "Process audio samples (NumPy array)")
+
+        .def("reset", &PyDecoder::reset)
+        // 处理模式：低延迟（小块、立即回调）或高吞吐（L2 大小的块、回调在块末派发，流结束时调用 flush）
+        .def("set_processing_mode", &PyDecoder::set_processing_mode, py::arg("mode"))
+        .def_property_readonly("processing_mode", [](const PyDecoder& self) {
+            return self.decoder().processing_mode();
+        })
+        .def_property_readonly("preferred_block_size", [](const PyDecoder& self) {
+            return self.decoder().preferred_block_size();
+        })
+        .def("flush", &PyDecoder::flush, "Decode samples held back by ProcessingMode.THROUGHPUT")
+        // 录制 / 回放频率轨迹：回放跳过重采样、带通与鉴频，只重跑 VIS / PD 状态机。
+        // writer 在挂接期间保持存活；传入 None 停止录制
+        .def("set_freq_track_writer", &PyDecoder::set_freq_track_writer, py::arg("writer"), py::keep_alive<1, 2>())
+        .def("replay_track", &PyDecoder::replay_track, py::arg("path"), "Decode a frequency track file")
+        // 图像输出：每幅图像结束时（无论完成、取消还是超时）文件即写好；writer 在挂接期间保持存活，传入 None 停止
+        .def("set_image_writer", &PyDecoder::set_image_writer, py::arg("writer"), py::keep_alive<1, 2>())
+        .def("set_discriminator_mode", &PyDecoder::set_discriminator_mode, py::arg("mode"))
+        .def("stats", &PyDecoder::stats, "Snapshot of the monitoring counters (safe from any thread)")
+        .def("reset_stats", &PyDecoder::reset_stats)
+        .def("dump_trace", &PyDecoder::dump_trace, "Retained per-sample state trace as CSV (empty unless TRACE_ENABLED)")
+        .def("clear_trace", &PyDecoder::clear_trace)
+
+        // 空闲信道音调门限：未检测到前导音能量时跳过鉴频与 VIS 状态机
+        .def("set_tone_gate_enabled", &PyDecoder::set_tone_gate_enabled, py::arg("enabled") = true)
+        .def_property_readonly("tone_gate_enabled", [](const PyDecoder& self) {
+            return self.decoder().tone_gate_enabled();
+        })
+
+        // VIS 检测引擎：FM 鉴频（默认）或块 Goertzel 匹配窗
+        .def("set_vis_engine", &PyDecoder::set_vis_engine, py::arg("engine"))
+        .def_property_readonly("vis_engine", [](const PyDecoder& self) {
+            return self.decoder().vis_engine();
+        })
+
+        // PD 行同步定位：逐样本门限（默认）或多候选模板相关（延迟一个行组，校正倾斜）
+        .def("set_sync_mode", &PyDecoder::set_sync_mode, py::arg("mode"))
+        .def_property_readonly("sync_mode", [](const PyDecoder& self) {
+            return self.decoder().sync_mode();
+        })
+
+        // 整帧缓冲区模式：解码器直接写入预分配的连续像素缓冲区，Python 端通过 NumPy 视图零拷贝读取
+        .def("set_frame_buffer_enabled", &PyDecoder::set_frame_buffer_enabled, py::arg("enabled") = true)
+        .def_property_readonly("frame_buffer_enabled", [](const PyDecoder& self) {
+            return self.decoder().frame_buffer_enabled();
+        })
+        // (height, width, 3) uint8 视图，base 为 Decoder 对象本身，视图存活期间 Decoder 不会被释放
+        .def_property_readonly("frame", [](py::object self) {
+            const auto& decoder = self.cast<const PyDecoder&>().decoder();
+            const auto height = static_cast<py::ssize_t>(decoder.frame_height());
+            const auto width = static_cast<py::ssize_t>(decoder.frame_width());
+            return py::array_t<uint8_t>({height, width, py::ssize_t{3}}, {width * 3, py::ssize_t{3}, py::ssize_t{1}},
+                                        reinterpret_cast<const uint8_t*>(decoder.frame().data()), self);
+        })
+
+        // 多帧输出：每幅图像写入帧管理器的一个预分配槽位，完成后由 acquire_frame() 零拷贝取出
+        .def("set_frame_manager_enabled", &PyDecoder::set_frame_manager_enabled, py::arg("enabled") = true,
+             py::arg("slots") = FrameManager::MIN_SLOTS)
+        .def_property_readonly("frame_manager_enabled", [](const PyDecoder& self) {
+            return self.decoder().frame_manager_enabled();
+        })
+        // timeout 为 None 时不等待，没有完成的帧时返回 None；返回的 Frame 使 Decoder 保持存活
+        .def("acquire_frame", &PyDecoder::acquire_frame, py::arg("timeout") = py::none(), py::keep_alive<0, 1>())
+        .def_property_readonly("dropped_frames", &PyDecoder::dropped_frames)
+
+        // 放弃当前图像（FrameStatus.CANCELLED），不重建处理链，立即恢复 VIS 搜索
+        .def("cancel_image", &PyDecoder::cancel_image)
+        // 连续 lines 个行周期没有有效同步脉冲时放弃当前图像（FrameStatus.TIMED_OUT），0 表示不超时
+        .def("set_image_timeout_lines", &PyDecoder::set_image_timeout_lines, py::arg("lines"))
+        .def_property_readonly("image_timeout_lines", [](const PyDecoder& self) {
+            return self.decoder().image_timeout_lines();
+        })
+
+        // 绑定回调函数（传入 None 可取消）
+        .def("set_on_mode_detected_callback", &PyDecoder::set_on_mode_detected_callback)
+        .def("set_on_line_decoded_callback", &PyDecoder::set_on_line_decoded_callback)
+        .def("set_on_image_complete_callback", &PyDecoder::set_on_image_complete_callback)
+        // 只传递行号，不构造任何 Pixel 对象；像素从 frame 中读取。
+        // 回调在 process() 返回后才派发，而 frame 只反映最新的图像：同一次调用中若又检测到新图像，
+        // 旧图像未派发的行事件会被丢弃
+        .def("set_on_line_ready_callback", &PyDecoder::set_on_line_ready_callback)
+        // 图像以任何方式结束时调用，参数为 FrameInfo
+        .def("set_on_image_finished_callback", &PyDecoder::set_on_image_finished_callback);
+
+    // 4. 多通道解码池：每个通道独立的解码链，由固定数量的工作线程调度
+    py::class_<DecoderPool, std::unique_ptr<DecoderPool, GilReleasingDeleter>>(m, "DecoderPool")
+        .def(py::init<size_t, double, size_t>(),
+             py::arg("channel_count"), py::arg("sample_rate"), py::arg("worker_count") = 0)
+
+        // 样本在持有 GIL 时拷贝进通道队列，随后立即返回
+        .def("submit", [](DecoderPool &self, size_t channel, const py::array_t<float, py::array::c_style | py::array::forcecast>& samples) {
+            py::buffer_info buf = samples.request();
+            if (buf.ndim != 1) {
+                throw std::runtime_error("Buffer must be 1D");
+            }
+            self.submit(channel, static_cast<float*>(buf.ptr), static_cast<size_t>(buf.shape[0]));
+        }, py::arg("channel"), py::arg("samples"), "Queue audio samples (NumPy array) for a channel")
+
+        // 等待期间释放 GIL，工作线程才能执行 Python 回调
+        .def("wait_idle", &DecoderPool::wait_idle, py::call_guard<py::gil_scoped_release>())
+        .def("reset_channel", &DecoderPool::reset_channel, py::arg("channel"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("channel_stats", &DecoderPool::channel_stats, py::arg("channel"))
+        .def("set_tone_gate_enabled", &DecoderPool::set_tone_gate_enabled, py::arg("enabled") = true,
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_vis_engine", &DecoderPool::set_vis_engine, py::arg("engine"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_sync_mode", &DecoderPool::set_sync_mode, py::arg("mode"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_image_timeout_lines", &DecoderPool::set_image_timeout_lines, py::arg("lines"),
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("channel_count", &DecoderPool::channel_count)
+        .def_property_readonly("worker_count", &DecoderPool::worker_count)
+
+        // 回调在工作线程中执行，第一个参数为通道序号
+        .def("set_on_mode_detected_callback", &DecoderPool::set_on_mode_detected_callback)
+        // 行像素以 span 传出，只在回调期间有效，这里转成 Pixel 列表交给 Python
+        .def("set_on_line_decoded_callback", [](DecoderPool& self,
+                std::function<void(size_t, int, const std::vector<Pixel>&)> cb) {
+            if (!cb) {
+                self.set_on_line_decoded_callback(nullptr);
+                return;
+            }
+            self.set_on_line_decoded_callback([cb = std::move(cb)](size_t channel, int line_idx, std::span<const Pixel> pixels) {
+                cb(channel, line_idx, std::vector<Pixel>(pixels.begin(), pixels.end()));
+            });
+        })
+        .def("set_on_image_complete_callback", &DecoderPool::set_on_image_complete_callback);
+
+    // 5. 实时采集前端：采集回调只把样本推入无锁环形缓冲区，解码在独立线程中进行
+    py::class_<StreamDecoder, std::unique_ptr<StreamDecoder, GilReleasingDeleter>>(m, "StreamDecoder")
+        .def(py::init<double, size_t, size_t, dsp::ResamplerMode>(),
+             py::arg("sample_rate"), py::arg("block_size") = StreamDecoder::DEFAULT_BLOCK_SIZE,
+             py::arg("buffer_samples") = 0, py::arg("resampler") = dsp::ResamplerMode::LIBSAMPLERATE)
+
+        // 持有 GIL 拷贝进环形缓冲区后立即返回，从不阻塞；返回实际写入的样本数
+        .def("push", [](StreamDecoder& self, const py::array_t<float, py::array::c_style | py::array::forcecast>& samples) {
             py::buffer_info buf = samples.request();
             if (buf.ndim != 1) {
                 throw std::runtime_error("Buffer must be 1D");
             }
-            // 调用原始 C++ 接口
-            self.process(static_cast<float*>(buf.ptr), static_cast<size_t>(buf.shape[0]));
-        }, py::arg("samples"), "Process audio samples (NumPy array)")
+            return self.push(static_cast<const float*>(buf.ptr), static_cast<size_t>(buf.shape[0]));
+        }, py::arg("samples"), "Queue captured audio (NumPy array); returns the number of samples accepted")
+
+        // 解码线程执行 Python 回调时需要 GIL，等待期间必须释放
+        .def("start", &StreamDecoder::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &StreamDecoder::stop, py::call_guard<py::gil_scoped_release>())
+        .def("flush", &StreamDecoder::flush, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("running", &StreamDecoder::running)
+        .def_property_readonly("overrun_count", &StreamDecoder::overrun_count)
+        .def_property_readonly("dropped_samples", &StreamDecoder::dropped_samples)
+        .def_property_readonly("queued_samples", &StreamDecoder::queued_samples)
+        .def_property_readonly("capacity", &StreamDecoder::capacity)
+        .def_property_readonly("block_size", &StreamDecoder::block_size)
+        .def("stats", [](const StreamDecoder& self) { return self.decoder().stats(); })
+
+        // 回调在解码线程中执行，须在 start() 之前设置
+        .def("set_on_mode_detected_callback", [](StreamDecoder& self, ModeDetectedCallback cb) {
+            self.decoder().set_on_mode_detected_callback(std::move(cb));
+        })
+        .def("set_on_line_decoded_callback", [](StreamDecoder& self,
+                std::function<void(int, const std::vector<Pixel>&)> cb) {
+            if (!cb) {
+                self.decoder().set_on_line_decoded_callback(nullptr);
+                return;
+            }
+            self.decoder().set_on_line_decoded_callback([cb = std::move(cb)](int line_idx, std::span<const Pixel> pixels) {
+                cb(line_idx, std::vector<Pixel>(pixels.begin(), pixels.end()));
+            });
+        })
+        .def("set_on_image_complete_callback", [](StreamDecoder& self, ImageCompleteCallback cb) {
+            self.decoder().set_on_image_complete_callback(std::move(cb));
+        })
+        // 同样须在 start() 之前设置；writer 在挂接期间保持存活
+        .def("set_image_writer", [](StreamDecoder& self, ImageWriter* writer) {
+            self.decoder().set_image_writer(writer);
+        }, py::arg("writer"), py::keep_alive<1, 2>());
+
+    // 6. 离线批量解码：整段录音先做 VIS 扫描，再多线程并行解码每一幅图像
+    py::class_<DecodedImage>(m, "DecodedImage")
+        .def_readonly("mode", &DecodedImage::mode)
+        .def_readonly("sample_offset", &DecodedImage::sample_offset)
+        .def_readonly("data_offset", &DecodedImage::data_offset)
+        .def_readonly("width", &DecodedImage::width)
+        .def_readonly("height", &DecodedImage::height)
+        .def_readonly("lines_decoded", &DecodedImage::lines_decoded)
+        .def_readonly("complete", &DecodedImage::complete)
+        // (height, width, 3) uint8 视图，直接引用 C++ 像素缓冲区，不做拷贝
+        .def_property_readonly("pixels", [](py::object self) {
+            auto& image = self.cast<DecodedImage&>();
+            return py::array_t<uint8_t>(
+                {static_cast<py::ssize_t>(image.height), static_cast<py::ssize_t>(image.width), py::ssize_t{3}},
+                {static_cast<py::ssize_t>(image.width) * 3, py::ssize_t{3}, py::ssize_t{1}},
+                reinterpret_cast<const uint8_t*>(image.pixels.data()), self);
+        });
+
+    m.def("decode_buffer", [](const py::array_t<float, py::array::c_style | py::array::forcecast>& samples,
+                              double sample_rate, size_t max_threads, dsp::ResamplerMode resampler, bool tone_gate) {
+        py::buffer_info buf = samples.request();
+        if (buf.ndim != 1) {
+            throw std::runtime_error("Buffer must be 1D");
+        }
+        BatchDecodeOptions options;
+        options.max_threads = max_threads;
+        options.resampler = resampler;
+        options.tone_gate = tone_gate;
+
+        // 解码期间不需要访问 Python 对象，释放 GIL
+        py::gil_scoped_release release;
+        return decode_buffer(static_cast<const float*>(buf.ptr), static_cast<size_t>(buf.shape[0]), sample_rate, options);
+    }, py::arg("samples"), py::arg("sample_rate"), py::arg("max_threads") = 0,
+       py::arg("resampler") = dsp::ResamplerMode::LIBSAMPLERATE, py::arg("tone_gate") = true,
+       "Decode every SSTV image in a whole recording (NumPy array)");
+
+    m.def("decode_file", [](const std::string& path, double sample_rate, size_t max_threads,
+                            dsp::ResamplerMode resampler, bool tone_gate) {
+        BatchDecodeOptions options;
+        options.max_threads = max_threads;
+        options.resampler = resampler;
+        options.tone_gate = tone_gate;
+        return decode_file(path, sample_rate, options);
+    }, py::arg("path"), py::arg("sample_rate"), py::arg("max_threads") = 0,
+       py::arg("resampler") = dsp::ResamplerMode::LIBSAMPLERATE, py::arg("tone_gate") = true,
+       py::call_guard<py::gil_scoped_release>(),
+       "Decode every SSTV image in a raw float32/int16 or WAV recording");
+
+    // 7. 宽带多信道解码：一个 FFT 多相滤波器组拆分子信道，每个子信道一个 Decoder
+    py::class_<PyChannelizedDecoder>(m, "ChannelizedDecoder")
+        .def(py::init<double, std::vector<double>, double, dsp::ResamplerMode>(),
+             py::arg("sample_rate"), py::arg("offsets"),
+             py::arg("max_channel_spacing") = ChannelizedDecoder::DEFAULT_MAX_CHANNEL_SPACING,
+             py::arg("resampler") = dsp::ResamplerMode::POLYPHASE)
+
+        // 解码在调用线程中进行，期间释放 GIL；回调经 pybind11 的函数包装重新获得 GIL
+        .def("process", &PyChannelizedDecoder::process, py::arg("samples"),
+             "Process wideband audio samples (NumPy array)")
+        .def("flush", &PyChannelizedDecoder::flush)
+        .def("reset", &PyChannelizedDecoder::reset)
+
+        .def_property_readonly("channel_count", [](const PyChannelizedDecoder& self) {
+            return self.decoder().channel_count();
+        })
+        .def_property_readonly("channel_rate", [](const PyChannelizedDecoder& self) {
+            return self.decoder().channel_rate();
+        })
+        .def_property_readonly("channel_spacing", [](const PyChannelizedDecoder& self) {
+            return self.decoder().channel_spacing();
+        })
+        .def("channel_offset", [](const PyChannelizedDecoder& self, size_t channel) {
+            return self.decoder().channel_offset(channel);
+        }, py::arg("channel"))
+        .def("signal_offset", &PyChannelizedDecoder::signal_offset, py::arg("channel"))
+        .def("channel_stats", [](const PyChannelizedDecoder& self, size_t channel) {
+            return self.decoder().channel_stats(channel);
+        }, py::arg("channel"))
 
-        .def("reset", &Decoder::reset)
+        .def("set_tone_gate_enabled", &PyChannelizedDecoder::set_tone_gate_enabled, py::arg("enabled") = true)
+        .def("set_vis_engine", &PyChannelizedDecoder::set_vis_engine, py::arg("engine"))
+        .def("set_sync_mode", &PyChannelizedDecoder::set_sync_mode, py::arg("mode"))
+        .def("set_image_timeout_lines", &PyChannelizedDecoder::set_image_timeout_lines, py::arg("lines"))
+        // writer 在挂接期间保持存活
+        .def("set_image_writer", &PyChannelizedDecoder::set_image_writer,
+             py::arg("channel"), py::arg("writer"), py::keep_alive<1, 3>())
 
-        // 绑定回调函数
-        .def("set_on_mode_detected_callback", &Decoder::set_on_mode_detected_callback)
-        .def("set_on_line_decoded_callback", &Decoder::set_on_line_decoded_callback)
-        .def("set_on_image_complete_callback", &Decoder::set_on_image_complete_callback);
+        // 第一个参数为通道序号（在 offsets 中的位置）
+        .def("set_on_mode_detected_callback", &PyChannelizedDecoder::set_on_mode_detected_callback)
+        .def("set_on_line_decoded_callback", &PyChannelizedDecoder::set_on_line_decoded_callback)
+        .def("set_on_image_complete_callback", &PyChannelizedDecoder::set_on_image_complete_callback);
 }
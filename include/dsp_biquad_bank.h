@@ -0,0 +1,153 @@
+// include/dsp_biquad_bank.h
+#pragma once
+
+#include "dsp_filters.h"
+#include "dsp_simd.h"
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace sstv::dsp {
+
+// 多通道二阶 IIR 滤波器组：LANES 个相互独立的 biquad 同步推进，每个 lane 各有一组 float 系数与状态
+//
+// 同一条滤波器链上的递推无法沿时间并行，这里改为沿通道方向向量化（每 4 个 lane 一个 SIMD 寄存器）：
+// lane 之间可以是不同的滤波器，也可以是同一个滤波器作用于不同的信号流。
+// 计算顺序固定为 ((((a0*x + a1*x1) + a2*x2) + b1*y1) + b2*y2)，向量与标量路径都用非融合乘加，逐位一致
+// （前提是编译器不把标量乘加收缩为 FMA：CMakeLists.txt 对所有构建加 -ffp-contract=off）
+template <size_t LANES>
+class BiquadBank {
+    static_assert(LANES > 0 && LANES % 4 == 0, "BiquadBank lane count must be a multiple of 4");
+
+public:
+    static constexpr size_t LANE_COUNT = LANES;
+
+    // 设置某个 lane 的系数并清空该 lane 的状态
+    void set_coeffs(size_t lane, const BiquadCoeffs& c) {
+        m_a0[lane] = static_cast<float>(c.a0);
+        m_a1[lane] = static_cast<float>(c.a1);
+        m_a2[lane] = static_cast<float>(c.a2);
+        m_b1[lane] = static_cast<float>(c.b1);
+        m_b2[lane] = static_cast<float>(c.b2);
+        m_x1[lane] = m_x2[lane] = m_y1[lane] = m_y2[lane] = 0.0f;
+    }
+    void set_bandpass(size_t lane, double frequency, double bandwidth, double sample_rate) {
+        set_coeffs(lane, BiquadCoeffs::bandpass(frequency, bandwidth, sample_rate));
+    }
+    void set_lowpass(size_t lane, double cutoff, double sample_rate) {
+        set_coeffs(lane, BiquadCoeffs::lowpass(cutoff, sample_rate));
+    }
+
+    void clear() {
+        m_x1.fill(0.0f); m_x2.fill(0.0f);
+        m_y1.fill(0.0f); m_y2.fill(0.0f);
+    }
+
+    // 所有 lane 前进一个样本：in[lane] -> out[lane]（in 与 out 可以是同一数组）
+    void step(const float* in, float* out) {
+        size_t l = 0;
+#if defined(SSTV_SIMD_AVX2) || defined(SSTV_SIMD_SSE2)
+        for (; l < LANES; l += 4) {
+            const __m128 x = _mm_loadu_ps(in + l);
+            const __m128 x1 = _mm_load_ps(&m_x1[l]);
+            const __m128 y1 = _mm_load_ps(&m_y1[l]);
+            __m128 y = _mm_mul_ps(_mm_load_ps(&m_a0[l]), x);
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(&m_a1[l]), x1));
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(&m_a2[l]), _mm_load_ps(&m_x2[l])));
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(&m_b1[l]), y1));
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(&m_b2[l]), _mm_load_ps(&m_y2[l])));
+            _mm_store_ps(&m_x2[l], x1);
+            _mm_store_ps(&m_x1[l], x);
+            _mm_store_ps(&m_y2[l], y1);
+            _mm_store_ps(&m_y1[l], y);
+            _mm_storeu_ps(out + l, y);
+        }
+#elif defined(SSTV_SIMD_NEON)
+        for (; l < LANES; l += 4) {
+            const float32x4_t x = vld1q_f32(in + l);
+            const float32x4_t x1 = vld1q_f32(&m_x1[l]);
+            const float32x4_t y1 = vld1q_f32(&m_y1[l]);
+            float32x4_t y = vmulq_f32(vld1q_f32(&m_a0[l]), x);
+            y = vaddq_f32(y, vmulq_f32(vld1q_f32(&m_a1[l]), x1));
+            y = vaddq_f32(y, vmulq_f32(vld1q_f32(&m_a2[l]), vld1q_f32(&m_x2[l])));
+            y = vaddq_f32(y, vmulq_f32(vld1q_f32(&m_b1[l]), y1));
+            y = vaddq_f32(y, vmulq_f32(vld1q_f32(&m_b2[l]), vld1q_f32(&m_y2[l])));
+            vst1q_f32(&m_x2[l], x1);
+            vst1q_f32(&m_x1[l], x);
+            vst1q_f32(&m_y2[l], y1);
+            vst1q_f32(&m_y1[l], y);
+            vst1q_f32(out + l, y);
+        }
+#endif
+        step_lanes(in, out, l, LANES);
+    }
+
+    // 只推进 [first, last) 范围内的 lane，其余 lane 的状态不变
+    void step_lanes(const float* in, float* out, size_t first, size_t last) {
+        for (size_t l = first; l < last; ++l) {
+            const float x = in[l];
+            float y = m_a0[l] * x;
+            y = y + m_a1[l] * m_x1[l];
+            y = y + m_a2[l] * m_x2[l];
+            y = y + m_b1[l] * m_y1[l];
+            y = y + m_b2[l] * m_y2[l];
+            m_x2[l] = m_x1[l]; m_x1[l] = x;
+            m_y2[l] = m_y1[l]; m_y1[l] = y;
+            out[l] = y;
+        }
+    }
+
+    // 连续推进 count 个样本，输入输出按样本交错存放：in[t * LANES + lane]
+    void process_block(const float* in, float* out, size_t count) {
+        for (size_t t = 0; t < count; ++t) step(in + t * LANES, out + t * LANES);
+    }
+
+private:
+    alignas(16) std::array<float, LANES> m_a0{}, m_a1{}, m_a2{}, m_b1{}, m_b2{};
+    alignas(16) std::array<float, LANES> m_x1{}, m_x2{}, m_y1{}, m_y2{};
+};
+
+// 双音包络检波器：两个带通谐振器与各自的低通包络跟随器（对 |带通输出| 低通）共 4 个 biquad，
+// 放在同一个 4-lane 滤波器组里一条向量指令推进
+//
+// lane 0/1 为带通 A/B，lane 2/3 为低通 A/B。低通依赖同一时刻的带通输出，因此级联的第二级错开一个样本
+// （软件流水线）：第 t 步带通处理 x[t]，低通处理 |bp[t-1]|。块首单独推进带通、块尾单独推进低通，
+// 所以块内输出与逐级计算逐位一致、没有额外延迟，也与分块方式无关
+class DualToneEnvelope {
+public:
+    void setup(double freq_a, double freq_b, double bandwidth, double lowpass_cutoff, double sample_rate) {
+        m_bank.set_bandpass(0, freq_a, bandwidth, sample_rate);
+        m_bank.set_bandpass(1, freq_b, bandwidth, sample_rate);
+        m_bank.set_lowpass(2, lowpass_cutoff, sample_rate);
+        m_bank.set_lowpass(3, lowpass_cutoff, sample_rate);
+    }
+
+    void clear() { m_bank.clear(); }
+
+    // env_a[t] / env_b[t] 为 x[t] 对应的两路包络
+    void process_block(const float* x, float* env_a, float* env_b, size_t count) {
+        if (count == 0) return;
+        alignas(16) float v[4] = {x[0], x[0], 0.0f, 0.0f};
+        m_bank.step_lanes(v, v, 0, 2);
+        for (size_t t = 1; t < count; ++t) {
+            v[2] = std::abs(v[0]);
+            v[3] = std::abs(v[1]);
+            v[0] = v[1] = x[t];
+            m_bank.step(v, v);
+            env_a[t - 1] = v[2];
+            env_b[t - 1] = v[3];
+        }
+        v[2] = std::abs(v[0]);
+        v[3] = std::abs(v[1]);
+        m_bank.step_lanes(v, v, 2, 4);
+        env_a[count - 1] = v[2];
+        env_b[count - 1] = v[3];
+    }
+
+    void process(float x, float& env_a, float& env_b) { process_block(&x, &env_a, &env_b, 1); }
+
+private:
+    BiquadBank<4> m_bank;
+};
+
+} // namespace sstv::dsp
@@ -0,0 +1,94 @@
+// include/dsp_channelizer.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace sstv::dsp {
+
+    // FFT 多相分析滤波器组（加权重叠相加结构）：把一路宽带实信号拆成 K 个等间隔子信道，
+    // 各自抽取 D 倍后以实音频输出
+    //
+    // 子信道 k 的频偏为 offset_k = k * input_rate / K（k >= K/2 时为 (k - K) * 间隔，即负频偏）。
+    // 其输出是把宽带信号下变频 offset_k 后、以 center_freq 为中心带通滤波得到的实音频，
+    // 也就是说宽带信号中位于 center_freq + offset_k 附近的信号，在子信道 k 中出现在 center_freq 附近。
+    //
+    // 原型低通 h（长度 L = P*K）调制到 center_freq 成为复带通 h'[l] = h[l] e^{j2π·center·l/fs}，
+    // 每 D 个输入样本：
+    //   1. 最近 L 个输入与 h' 相乘后按 K 点折叠成复序列（2L 次乘加）
+    //   2. 按 (m*D) mod K 循环移位（即每个信道的下变频相位），做一次 K 点 FFT 同时得到全部子信道
+    //   3. 子信道输出 2 * Re(Y_k)
+    // 因此每个输出块只有一次共享的 FFT，与信道数无关，而不是每个信道各做一次全速率混频 + FIR
+    class Channelizer {
+    public:
+        /**
+         * @param input_rate    宽带输入采样率 (Hz)
+         * @param channel_count 子信道数 K（FFT 长度，必须为 2 的幂），信道间隔 input_rate / K
+         * @param decimation    抽取倍数 D，子信道输出采样率 input_rate / D
+         * @param center_freq   子信道输出音频的中心频率 (Hz)
+         * @param passband      通带半宽 (Hz)，center_freq ± passband 以内为通带
+         * @param stopband      阻带半宽 (Hz)，center_freq ± stopband 以外为阻带；过渡带宽决定原型长度
+         * @throws std::runtime_error 参数无效，或 center_freq + stopband 超出输出奈奎斯特频率
+         */
+        Channelizer(double input_rate, size_t channel_count, size_t decimation,
+                    double center_freq, double passband, double stopband);
+
+        /**
+         * @brief 无分配的流式接口：只输出 channels 中列出的子信道
+         * @param channels 子信道序号（< channel_count()）
+         * @param output   第 i 个所选信道的样本写入 output[i * stride ...]，
+         *                 stride 至少为 max_output_size(input.size())
+         * @return 每个信道写入的样本数
+         */
+        size_t process_into(std::span<const float> input, std::span<const size_t> channels,
+                            std::span<float> output, size_t stride);
+
+        // 输入 input_count 个样本时每个信道输出样本数的上界
+        [[nodiscard]] size_t max_output_size(size_t input_count) const {
+            return input_count / m_decimation + 1;
+        }
+
+        void reset();
+
+        [[nodiscard]] size_t channel_count() const { return m_channel_count; }
+        [[nodiscard]] size_t decimation() const { return m_decimation; }
+        [[nodiscard]] size_t taps_per_branch() const { return m_taps_per_branch; }
+        [[nodiscard]] double output_rate() const { return m_input_rate / static_cast<double>(m_decimation); }
+        [[nodiscard]] double channel_spacing() const { return m_input_rate / static_cast<double>(m_channel_count); }
+        [[nodiscard]] double center_freq() const { return m_center_freq; }
+
+        // 子信道 k 的频偏 (Hz)，范围 [-input_rate/2, input_rate/2)
+        [[nodiscard]] double channel_offset(size_t channel) const;
+        // 离 offset 最近的子信道
+        [[nodiscard]] size_t channel_for_offset(double offset) const;
+
+    private:
+        void fft(); // 原位 K 点 FFT（正指数核），输入已按位反转顺序放入 m_spectrum_re / m_spectrum_im
+
+        double m_input_rate;
+        size_t m_channel_count;            // K
+        size_t m_decimation;               // D
+        double m_center_freq;
+        size_t m_taps_per_branch;          // P，原型长度 L = P * K
+
+        // 时间反转后的复原型 h'[L-1-q]，实部 / 虚部分开存放，与按时间正序排列的输入窗口逐元素相乘
+        std::vector<float> m_taps_re;
+        std::vector<float> m_taps_im;
+        std::vector<float> m_history;      // 最近 L-1 个输入样本
+        std::vector<float> m_block_buffer; // 线性工作区：[L-1 个历史样本 | 输入块]
+
+        std::vector<float> m_fold_re;      // 折叠结果（按时间反转顺序），K 点
+        std::vector<float> m_fold_im;
+        std::vector<float> m_spectrum_re;  // FFT 工作区，K 点
+        std::vector<float> m_spectrum_im;
+        std::vector<float> m_twiddle_re;   // 各级蝶形的旋转因子（见 fft()）
+        std::vector<float> m_twiddle_im;
+        std::vector<uint32_t> m_bit_reverse;
+
+        size_t m_next_output;              // 下一个输出的最新输入样本在当前块中的位置
+        size_t m_rotation;                 // (m * D) mod K，当前输出的循环移位量
+    };
+
+} // namespace sstv::dsp
@@ -2,7 +2,9 @@
 #pragma once
 
 #include "sstv_types.h" // 包含 FilterCoefficients 和 FilterDelayLine
+#include "dsp_simd.h"
 #include <vector>
+#include <span>
 #include <numbers>
 #include <cmath>
 
@@ -35,42 +37,74 @@ public:
     // input_samples: 输入样本数组
     // output_samples: 输出样本数组 (与输入数组大小相同)
     // count: 样本数量
+    // 内部将历史样本与输入拼接为线性缓冲区，使用 SIMD 块卷积一次产生多个输出
     void process_block(const float* input_samples, float* output_samples, size_t count);
 
+    // 无分配的流式接口，output 长度至少为 input.size()
+    void process_into(std::span<const float> input, std::span<float> output);
+
 private:
-    FilterCoefficients m_coeffs;    // 滤波器系数
-    FilterDelayLine m_delay_line;   // 延迟线（循环缓冲区），存储历史输入样本
-    size_t m_tap_count;             // 滤波器抽头数量 (m_coeffs.size())
-    size_t m_current_pos;           // 延迟线中的写入指针，指向最新样本的位置
+    std::vector<float> m_taps;          // 时间反转后的 float 系数，与延迟线窗口按正序做点积
+    FilterDelayLine m_delay_line;       // 镜像延迟线（长度 2N），任意时刻最近 N 个样本都连续存放
+    std::vector<float> m_block_buffer;  // process_block 的线性工作区：[N-1 个历史样本 | 输入块]
+    size_t m_tap_count;                 // 滤波器抽头数量 (m_taps.size())
+    size_t m_current_pos;               // 延迟线中下一个样本的写入位置 [0, N)
 };
 
-class Biquad {
-public:
-    // 构造一个二阶 IIR 谐振器 (Bandpass)
-    void setup_bandpass(double frequency, double bandwidth, double sample_rate) {
+// 二阶 IIR 系数：y = a0*x + a1*x1 + a2*x2 + b1*y1 + b2*y2（反馈项已取负号）
+struct BiquadCoeffs {
+    double a0 = 0, a1 = 0, a2 = 0, b1 = 0, b2 = 0;
+
+    // 二阶 IIR 谐振器 (Bandpass)，a1 = a2 = 0
+    static BiquadCoeffs bandpass(double frequency, double bandwidth, double sample_rate) {
         double omega = 2.0 * std::numbers::pi * frequency / sample_rate;
         double bw_rad = 2.0 * std::numbers::pi * bandwidth / sample_rate;
 
-        m_b2 = -std::exp(-bw_rad);
-        m_b1 = 2.0 * std::exp(-bw_rad / 2.0) * std::cos(omega);
+        BiquadCoeffs c;
+        c.b2 = -std::exp(-bw_rad);
+        c.b1 = 2.0 * std::exp(-bw_rad / 2.0) * std::cos(omega);
         // a0 归一化增益，使中心频率增益为 1
-        m_a0 = 1.0 - std::sqrt(m_b1*m_b1 / (4.0 * -m_b2)) * (1.0 + m_b2);
+        c.a0 = 1.0 - std::sqrt(c.b1*c.b1 / (4.0 * -c.b2)) * (1.0 + c.b2);
         // 简化版 a0
-        m_a0 = (1.0 + m_b2) * std::sin(omega) * 0.5;
-        clear();
+        c.a0 = (1.0 + c.b2) * std::sin(omega) * 0.5;
+        return c;
     }
 
-    // 构造一个低通滤波器 (Butterworth 2nd order)
-    void setup_lowpass(double cutoff, double sample_rate) {
+    // 低通滤波器 (Butterworth 2nd order)
+    static BiquadCoeffs lowpass(double cutoff, double sample_rate) {
         double ff = cutoff / sample_rate;
         double ita = 1.0 / std::tan(std::numbers::pi * ff);
         double q = std::sqrt(2.0);
         double den = 1.0 + q * ita + ita * ita;
-        m_a0 = 1.0 / den;
-        m_a1 = 2.0 / den;
-        m_a2 = 1.0 / den;
-        m_b1 = 2.0 * (ita * ita - 1.0) / den;
-        m_b2 = -(1.0 - q * ita + ita * ita) / den;
+        BiquadCoeffs c;
+        c.a0 = 1.0 / den;
+        c.a1 = 2.0 / den;
+        c.a2 = 1.0 / den;
+        c.b1 = 2.0 * (ita * ita - 1.0) / den;
+        c.b2 = -(1.0 - q * ita + ita * ita) / den;
+        return c;
+    }
+};
+
+class Biquad {
+public:
+    // 构造一个二阶 IIR 谐振器 (Bandpass)
+    void setup_bandpass(double frequency, double bandwidth, double sample_rate) {
+        const BiquadCoeffs c = BiquadCoeffs::bandpass(frequency, bandwidth, sample_rate);
+        m_a0 = c.a0;
+        m_b1 = c.b1;
+        m_b2 = c.b2;
+        clear();
+    }
+
+    // 构造一个低通滤波器 (Butterworth 2nd order)
+    void setup_lowpass(double cutoff, double sample_rate) {
+        const BiquadCoeffs c = BiquadCoeffs::lowpass(cutoff, sample_rate);
+        m_a0 = c.a0;
+        m_a1 = c.a1;
+        m_a2 = c.a2;
+        m_b1 = c.b1;
+        m_b2 = c.b2;
         m_is_lowpass = true;
         clear();
     }
@@ -96,4 +130,25 @@ private:
     bool m_is_lowpass = false;
 };
 
+// 一阶 IIR 隔直滤波器: y[n] = x[n] - x[n-1] + alpha * y[n-1]
+// 状态保存在实例中，每条处理链各自持有一个
+class DCBlocker {
+public:
+    explicit DCBlocker(float alpha = 0.995f) : m_alpha(alpha) {}
+
+    float process(float input) {
+        float output = input - m_prev_input + m_alpha * m_prev_output;
+        m_prev_input = input;
+        m_prev_output = output;
+        return output;
+    }
+
+    void clear() { m_prev_input = m_prev_output = 0.0f; }
+
+private:
+    float m_alpha; // 截止频率越小，alpha 越接近 1
+    float m_prev_input = 0.0f;
+    float m_prev_output = 0.0f;
+};
+
 } // namespace sstv::dsp
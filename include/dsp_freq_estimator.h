@@ -2,41 +2,81 @@
 
 #include "sstv_types.h"
 #include "dsp_agc.h"
+#include "dsp_filters.h"
 #include <vector>
 #include <cmath>
 #include <numeric>
 #include <memory>
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <span>
 
 namespace sstv::dsp {
 
+    // 希尔伯特变换长度。偶数偏移（含中心）的理想系数恒为 0，只有 ±1, ±3, ... ±31 这 32 个奇数偏移非零，
+    // 再利用奇对称 h[-n] = -h[n]，实际只需 16 个系数
+    constexpr size_t HILBERT_TAPS = 63;
+    constexpr size_t HILBERT_GROUP_DELAY = HILBERT_TAPS / 2;
+    constexpr size_t HILBERT_HALF_TAPS = (HILBERT_GROUP_DELAY + 1) / 2;
+
+    // 鉴频器实现方式
+    enum class DiscriminatorMode {
+        // std::atan2，作为参考精度（默认）；精度为 FreqSample（默认 double，float32 链路下为 float）
+        ATAN2,
+        // 单精度多项式近似 atan2 (Abramowitz & Stegun 4.4.49)，不调用任何超越函数
+        // 相位误差 <= 1.2e-5 rad，11025 Hz 下对应频率误差 <= 0.021 Hz（1100-2300 Hz 全频段均适用），
+        // 远小于一个像素灰阶对应的 800 / 255 = 3.14 Hz；实测约 0.4% 的像素在量化边界处相差 ±1
+        FAST_ATAN2
+    };
+
+    // 单精度快速 atan2，最大误差约 1.2e-5 rad
+    float fast_atan2(float y, float x);
+
     class FrequencyEstimator {
     public:
-        explicit FrequencyEstimator(double sample_rate);
+        explicit FrequencyEstimator(double sample_rate, DiscriminatorMode mode = DiscriminatorMode::ATAN2);
+
+        void set_discriminator_mode(DiscriminatorMode mode) { m_discriminator_mode = mode; }
+        [[nodiscard]] DiscriminatorMode get_discriminator_mode() const { return m_discriminator_mode; }
 
-        std::vector<double> process_block(const float* input_samples, size_t count);
-        double process_sample(float input_sample);
+        // 块处理：将 count 个样本的瞬时频率 (Hz) 写入调用方提供的 output_frequencies
+        // 频率类型为 FreqSample（默认 double，SSTV_FLOAT32_PIPELINE 下为 float，此时鉴频全程单精度）
+        void process_block(const float* input_samples, FreqSample* output_frequencies, size_t count);
+        // 无分配的流式接口，output 长度至少为 input.size()
+        void process_into(std::span<const float> input, std::span<FreqSample> output);
+        FreqSample process_sample(float input_sample);
 
-        [[nodiscard]] double get_last_frequency() const { return m_last_freq; }
+        [[nodiscard]] FreqSample get_last_frequency() const { return m_last_freq; }
         void clear();
 
     private:
         void generate_hilbert_coeffs();
+        // 由 I/Q 计算瞬时频率（含启动过渡期与噪声门限处理）
+        FreqSample discriminate(float i_val, float q);
+        // FAST_ATAN2 模式的块鉴频：先整块计算相位差，再逐样本处理门限
+        void discriminate_block_fast(const float* i_vals, const float* q_vals, FreqSample* output, size_t count);
 
         double m_sample_rate;
-        double m_last_freq;
+        FreqSample m_last_freq;
+        DiscriminatorMode m_discriminator_mode;
 
-        // AGC
+        // DC Blocker + AGC
+        DCBlocker m_dc_blocker;
         std::unique_ptr<AGC> m_agc;
 
         // 滤波器状态
-        std::vector<float> m_buffer;
-        std::vector<float> m_coeffs;
+        std::vector<float> m_buffer;        // 镜像延迟线（长度 2N），最近 N 个样本始终连续
+        std::array<float, HILBERT_HALF_TAPS> m_coeffs{}; // m_coeffs[t] 对应偏移 n = 2t + 1 的系数
         size_t m_buffer_size;
         size_t m_write_pos;
         size_t m_group_delay;
 
+        // 块处理工作区：[N-1 个历史样本 | AGC 后的输入块] 以及对应的 Q 路输出
+        std::vector<float> m_block_buffer;
+        std::vector<float> m_q_buffer;
+        std::vector<float> m_phase_buffer;
+
         // --- 核心状态：用于差分鉴频 ---
         float m_prev_i; // 上一时刻的同相分量
         float m_prev_q; // 上一时刻的正交分量
@@ -0,0 +1,50 @@
+// include/dsp_fused_pipeline.h
+#pragma once
+
+#include "sstv_types.h" // FreqSample
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace sstv::dsp {
+
+// 融合前端：带通 FIR -> (DC Blocker -> AGC -> 希尔伯特 -> 鉴频) -> 状态机，
+// 以 TILE 个样本为单位一次走完全部阶段，中间结果始终留在 L1 缓存中的定长数组里
+//
+// 阶段类型在编译期确定，块内不再有 std::function / 虚函数 / unique_ptr 间接调用：
+//   Bandpass  需提供 process_block(const float* in, float* out, size_t n)
+//   Estimator 需提供 process_block(const float* in, FreqSample* freq_out, size_t n)
+//   Sink      可调用对象 sink(const float* filtered, const FreqSample* freqs, size_t n)
+//
+// 各阶段的块处理结果与分块大小无关，因此输出与逐阶段整块处理的路径逐位一致
+template <typename Bandpass, typename Estimator, size_t TILE = 256>
+class FusedFrontEnd {
+    static_assert(TILE > 0, "FusedFrontEnd tile must not be empty");
+
+public:
+    FusedFrontEnd(Bandpass& bandpass, Estimator& estimator)
+        : m_bandpass(&bandpass), m_estimator(&estimator) {}
+
+    template <typename Sink>
+    void process(std::span<const float> input, Sink&& sink) {
+        for (size_t offset = 0; offset < input.size(); offset += TILE) {
+            const size_t n = std::min(TILE, input.size() - offset);
+            m_bandpass->process_block(input.data() + offset, m_filtered.data(), n);
+            m_estimator->process_block(m_filtered.data(), m_frequencies.data(), n);
+            sink(static_cast<const float*>(m_filtered.data()), static_cast<const FreqSample*>(m_frequencies.data()), n);
+        }
+    }
+
+    static constexpr size_t tile_size() { return TILE; }
+
+private:
+    Bandpass* m_bandpass;
+    Estimator* m_estimator;
+    std::array<float, TILE> m_filtered{};
+    std::array<FreqSample, TILE> m_frequencies{};
+};
+
+} // namespace sstv::dsp
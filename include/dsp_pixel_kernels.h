@@ -0,0 +1,254 @@
+// include/dsp_pixel_kernels.h
+#pragma once
+
+#include "dsp_simd.h"
+#include "sstv_types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// 整行像素核：频率段 -> 亮度/色差分量，YCbCr -> RGB
+// 各 SIMD 路径与标量实现逐位一致（输入为有限值时）
+namespace sstv::dsp::simd {
+
+// 单个频率 -> 像素分量，与 dsp::freq_to_pixel_value 相同：
+// 低于黑电平 / 高于白电平的值经 clamp 后分别得到 0 / 255，因此无需单独分支
+inline uint8_t freq_to_pixel_scalar(double frequency) {
+    double value = (frequency - BLACK_FREQ) / FREQ_RANGE * 255.0;
+    return static_cast<uint8_t>(std::clamp(value, 0.0, 255.0));
+}
+
+// 单精度版本（float32 频率链路），全程 float 运算
+inline uint8_t freq_to_pixel_scalar(float frequency) {
+    float value = (frequency - static_cast<float>(BLACK_FREQ)) / static_cast<float>(FREQ_RANGE) * 255.0f;
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+}
+
+// 一组频率 -> 像素分量（截断取整，与标量路径一致）
+inline void freq_to_pixel_row(const double* freqs, uint8_t* out, size_t count) {
+    size_t i = 0;
+#if defined(SSTV_SIMD_AVX2)
+    const __m256d black = _mm256_set1_pd(BLACK_FREQ), range = _mm256_set1_pd(FREQ_RANGE);
+    const __m256d lo = _mm256_setzero_pd(), hi = _mm256_set1_pd(255.0);
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(freqs + i), black), range), hi);
+        v = _mm256_min_pd(_mm256_max_pd(v, lo), hi);
+        __m128i q = _mm256_cvttpd_epi32(v);
+        q = _mm_packus_epi16(_mm_packs_epi32(q, q), q);
+        const int packed = _mm_cvtsi128_si32(q);
+        std::copy_n(reinterpret_cast<const uint8_t*>(&packed), 4, out + i);
+    }
+#elif defined(SSTV_SIMD_SSE2)
+    const __m128d black = _mm_set1_pd(BLACK_FREQ), range = _mm_set1_pd(FREQ_RANGE);
+    const __m128d lo = _mm_setzero_pd(), hi = _mm_set1_pd(255.0);
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(_mm_loadu_pd(freqs + i), black), range), hi);
+        v = _mm_min_pd(_mm_max_pd(v, lo), hi);
+        const __m128i q = _mm_cvttpd_epi32(v);
+        out[i] = static_cast<uint8_t>(_mm_cvtsi128_si32(q));
+        out[i + 1] = static_cast<uint8_t>(_mm_cvtsi128_si32(_mm_srli_si128(q, 4)));
+    }
+#elif defined(SSTV_SIMD_NEON)
+    const float64x2_t black = vdupq_n_f64(BLACK_FREQ), range = vdupq_n_f64(FREQ_RANGE);
+    const float64x2_t lo = vdupq_n_f64(0.0), hi = vdupq_n_f64(255.0);
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t v = vmulq_f64(vdivq_f64(vsubq_f64(vld1q_f64(freqs + i), black), range), hi);
+        v = vminq_f64(vmaxq_f64(v, lo), hi);
+        const int64x2_t q = vcvtq_s64_f64(v);
+        out[i] = static_cast<uint8_t>(vgetq_lane_s64(q, 0));
+        out[i + 1] = static_cast<uint8_t>(vgetq_lane_s64(q, 1));
+    }
+#endif
+    for (; i < count; ++i) out[i] = freq_to_pixel_scalar(freqs[i]);
+}
+
+// 单精度版本：每条指令处理的通道数是双精度的两倍 (AVX2 8 路，SSE2 / NEON 4 路)
+inline void freq_to_pixel_row(const float* freqs, uint8_t* out, size_t count) {
+    size_t i = 0;
+#if defined(SSTV_SIMD_AVX2)
+    const __m256 black = _mm256_set1_ps(static_cast<float>(BLACK_FREQ));
+    const __m256 range = _mm256_set1_ps(static_cast<float>(FREQ_RANGE));
+    const __m256 lo = _mm256_setzero_ps(), hi = _mm256_set1_ps(255.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(freqs + i), black), range), hi);
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        const __m256i q = _mm256_cvttps_epi32(v);
+        const __m128i q16 = _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(q16, q16));
+    }
+#elif defined(SSTV_SIMD_SSE2)
+    const __m128 black = _mm_set1_ps(static_cast<float>(BLACK_FREQ));
+    const __m128 range = _mm_set1_ps(static_cast<float>(FREQ_RANGE));
+    const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(_mm_loadu_ps(freqs + i), black), range), hi);
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        __m128i q = _mm_cvttps_epi32(v);
+        q = _mm_packus_epi16(_mm_packs_epi32(q, q), q);
+        const int packed = _mm_cvtsi128_si32(q);
+        std::copy_n(reinterpret_cast<const uint8_t*>(&packed), 4, out + i);
+    }
+#elif defined(SSTV_SIMD_NEON)
+    const float32x4_t black = vdupq_n_f32(static_cast<float>(BLACK_FREQ));
+    const float32x4_t range = vdupq_n_f32(static_cast<float>(FREQ_RANGE));
+    const float32x4_t lo = vdupq_n_f32(0.0f), hi = vdupq_n_f32(255.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_f32(vdivq_f32(vsubq_f32(vld1q_f32(freqs + i), black), range), hi);
+        float32x4_t b = vmulq_f32(vdivq_f32(vsubq_f32(vld1q_f32(freqs + i + 4), black), range), hi);
+        a = vminq_f32(vmaxq_f32(a, lo), hi);
+        b = vminq_f32(vmaxq_f32(b, lo), hi);
+        const uint16x8_t q = vcombine_u16(vmovn_u32(vcvtq_u32_f32(a)), vmovn_u32(vcvtq_u32_f32(b)));
+        vst1_u8(out + i, vmovn_u16(q));
+    }
+#endif
+    for (; i < count; ++i) out[i] = freq_to_pixel_scalar(freqs[i]);
+}
+
+// 把一段频率样本线性插值到 pixel_count 个像素位置，再映射为像素分量：
+//   pos = i / pixel_count * freq_count，freq = f[a] * (1 - w) + f[b] * w
+// 插值位置与权重均以 T 精度计算。freq_count 必须大于 0。
+// 插值按 64 像素一块先写入栈上临时行，再整块映射
+template <typename T>
+inline void resample_to_pixels(const T* freqs, size_t freq_count, uint8_t* out, size_t pixel_count) {
+    static_assert(std::is_same_v<T, double> || std::is_same_v<T, float>, "unsupported frequency sample type");
+    constexpr size_t CHUNK = 64;
+    alignas(32) T interpolated[CHUNK];
+
+    const T src_size = static_cast<T>(freq_count);
+    const T dst_size = static_cast<T>(pixel_count);
+    const size_t last = freq_count - 1;
+
+    for (size_t base = 0; base < pixel_count; base += CHUNK) {
+        const size_t n = std::min(CHUNK, pixel_count - base);
+        size_t j = 0;
+#if defined(SSTV_SIMD_AVX2)
+        if constexpr (std::is_same_v<T, double>) {
+            const __m256d vsrc = _mm256_set1_pd(src_size), vdst = _mm256_set1_pd(dst_size);
+            const __m256d one = _mm256_set1_pd(1.0), step = _mm256_set1_pd(4.0);
+            const __m128i vlast = _mm_set1_epi32(static_cast<int>(last)), vone = _mm_set1_epi32(1);
+            __m256d vi = _mm256_add_pd(_mm256_set1_pd(static_cast<double>(base)), _mm256_set_pd(3.0, 2.0, 1.0, 0.0));
+            for (; j + 4 <= n; j += 4, vi = _mm256_add_pd(vi, step)) {
+                const __m256d pos = _mm256_mul_pd(_mm256_div_pd(vi, vdst), vsrc);
+                const __m128i ia = _mm256_cvttpd_epi32(pos);
+                const __m128i ib = _mm_min_epi32(_mm_add_epi32(ia, vone), vlast);
+                const __m256d w = _mm256_sub_pd(pos, _mm256_cvtepi32_pd(ia));
+                const __m256d a = _mm256_i32gather_pd(freqs, ia, 8);
+                const __m256d b = _mm256_i32gather_pd(freqs, ib, 8);
+                _mm256_store_pd(interpolated + j,
+                                _mm256_add_pd(_mm256_mul_pd(a, _mm256_sub_pd(one, w)), _mm256_mul_pd(b, w)));
+            }
+        } else {
+            const __m256 vsrc = _mm256_set1_ps(src_size), vdst = _mm256_set1_ps(dst_size);
+            const __m256 one = _mm256_set1_ps(1.0f), step = _mm256_set1_ps(8.0f);
+            const __m256i vlast = _mm256_set1_epi32(static_cast<int>(last)), vone = _mm256_set1_epi32(1);
+            __m256 vi = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(base)),
+                                      _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f));
+            for (; j + 8 <= n; j += 8, vi = _mm256_add_ps(vi, step)) {
+                const __m256 pos = _mm256_mul_ps(_mm256_div_ps(vi, vdst), vsrc);
+                const __m256i ia = _mm256_cvttps_epi32(pos);
+                const __m256i ib = _mm256_min_epi32(_mm256_add_epi32(ia, vone), vlast);
+                const __m256 w = _mm256_sub_ps(pos, _mm256_cvtepi32_ps(ia));
+                const __m256 a = _mm256_i32gather_ps(freqs, ia, 4);
+                const __m256 b = _mm256_i32gather_ps(freqs, ib, 4);
+                _mm256_store_ps(interpolated + j,
+                                _mm256_add_ps(_mm256_mul_ps(a, _mm256_sub_ps(one, w)), _mm256_mul_ps(b, w)));
+            }
+        }
+#endif
+        for (; j < n; ++j) {
+            const T pos = (static_cast<T>(base + j) / dst_size) * src_size;
+            const size_t idx_a = static_cast<size_t>(pos);
+            const size_t idx_b = std::min(idx_a + 1, last);
+            const T weight = pos - static_cast<T>(idx_a);
+            interpolated[j] = freqs[idx_a] * (T(1) - weight) + freqs[idx_b] * weight;
+        }
+        freq_to_pixel_row(interpolated, out + base, n);
+    }
+}
+
+// 单个 YCbCr (BT.601 studio range) -> RGB，整数定点运算
+inline void ycbcr_to_rgb_scalar(uint8_t Y, uint8_t Cb, uint8_t Cr, uint8_t* rgb) {
+    int y = Y - 16;
+    int cb = Cb - 128;
+    int cr = Cr - 128;
+    int r = (298 * y + 409 * cr + 128) >> 8;
+    int g = (298 * y - 100 * cb - 208 * cr + 128) >> 8;
+    int b = (298 * y + 516 * cb + 128) >> 8;
+    rgb[0] = static_cast<uint8_t>(std::clamp(r, 0, 255));
+    rgb[1] = static_cast<uint8_t>(std::clamp(g, 0, 255));
+    rgb[2] = static_cast<uint8_t>(std::clamp(b, 0, 255));
+}
+
+// 整行 YCbCr -> 交错存放的 RGB (rgb 长度为 3 * count)
+// x86: 16 位分量两两交错后用 pmaddwd 一次完成两项乘加并得到 32 位结果，
+//      +128 的舍入常数作为与常量 1 配对的第三项一并累加；饱和打包即等价于 clamp(0, 255)
+// NEON: 宽乘累加 + 饱和窄化，最后用 vst3 直接交错写出
+inline void ycbcr_to_rgb_row(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* rgb, size_t count) {
+    size_t i = 0;
+#if defined(SSTV_SIMD_AVX2) || defined(SSTV_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y_bias = _mm_set1_epi16(16), c_bias = _mm_set1_epi16(128), one = _mm_set1_epi16(1);
+    const __m128i k_r = _mm_set_epi16(409, 298, 409, 298, 409, 298, 409, 298);      // (y, cr)
+    const __m128i k_b = _mm_set_epi16(516, 298, 516, 298, 516, 298, 516, 298);      // (y, cb)
+    const __m128i k_g1 = _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298); // (y, cb)
+    const __m128i k_g2 = _mm_set_epi16(128, -208, 128, -208, 128, -208, 128, -208); // (cr, 1)
+    const __m128i rounding = _mm_set1_epi32(128);
+
+    // 8 个像素的一个通道：两组 4 x int32 -> 8 x uint8（低 8 字节）
+    auto pack = [&](__m128i lo, __m128i hi) {
+        return _mm_packus_epi16(_mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8)), zero);
+    };
+
+    alignas(16) uint8_t r_out[16], g_out[16], b_out[16];
+    for (; i + 8 <= count; i += 8) {
+        const __m128i vy = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)), zero), y_bias);
+        const __m128i vcb = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)), zero), c_bias);
+        const __m128i vcr = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)), zero), c_bias);
+
+        const __m128i ycr_lo = _mm_unpacklo_epi16(vy, vcr), ycr_hi = _mm_unpackhi_epi16(vy, vcr);
+        const __m128i ycb_lo = _mm_unpacklo_epi16(vy, vcb), ycb_hi = _mm_unpackhi_epi16(vy, vcb);
+        const __m128i cr1_lo = _mm_unpacklo_epi16(vcr, one), cr1_hi = _mm_unpackhi_epi16(vcr, one);
+
+        const __m128i r = pack(_mm_add_epi32(_mm_madd_epi16(ycr_lo, k_r), rounding),
+                               _mm_add_epi32(_mm_madd_epi16(ycr_hi, k_r), rounding));
+        const __m128i g = pack(_mm_add_epi32(_mm_madd_epi16(ycb_lo, k_g1), _mm_madd_epi16(cr1_lo, k_g2)),
+                               _mm_add_epi32(_mm_madd_epi16(ycb_hi, k_g1), _mm_madd_epi16(cr1_hi, k_g2)));
+        const __m128i b = pack(_mm_add_epi32(_mm_madd_epi16(ycb_lo, k_b), rounding),
+                               _mm_add_epi32(_mm_madd_epi16(ycb_hi, k_b), rounding));
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(r_out), r);
+        _mm_store_si128(reinterpret_cast<__m128i*>(g_out), g);
+        _mm_store_si128(reinterpret_cast<__m128i*>(b_out), b);
+        uint8_t* dst = rgb + 3 * i;
+        for (size_t k = 0; k < 8; ++k) {
+            dst[3 * k] = r_out[k];
+            dst[3 * k + 1] = g_out[k];
+            dst[3 * k + 2] = b_out[k];
+        }
+    }
+#elif defined(SSTV_SIMD_NEON)
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t vy = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), vdupq_n_s16(16));
+        const int16x8_t vcb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cb + i))), vdupq_n_s16(128));
+        const int16x8_t vcr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cr + i))), vdupq_n_s16(128));
+        const int32x4_t rounding = vdupq_n_s32(128);
+
+        auto channel = [&](int16x8_t a, int16_t ka, int16x8_t b, int16_t kb, int16x8_t c, int16_t kc) {
+            int32x4_t lo = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(rounding, vget_low_s16(a), ka), vget_low_s16(b), kb), vget_low_s16(c), kc);
+            int32x4_t hi = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(rounding, vget_high_s16(a), ka), vget_high_s16(b), kb), vget_high_s16(c), kc);
+            return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, 8)), vqmovn_s32(vshrq_n_s32(hi, 8))));
+        };
+
+        uint8x8x3_t px;
+        px.val[0] = channel(vy, 298, vcr, 409, vcb, 0);
+        px.val[1] = channel(vy, 298, vcb, -100, vcr, -208);
+        px.val[2] = channel(vy, 298, vcb, 516, vcr, 0);
+        vst3_u8(rgb + 3 * i, px);
+    }
+#endif
+    for (; i < count; ++i) ycbcr_to_rgb_scalar(y[i], cb[i], cr[i], rgb + 3 * i);
+}
+
+} // namespace sstv::dsp::simd
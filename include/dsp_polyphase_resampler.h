@@ -0,0 +1,75 @@
+// include/dsp_polyphase_resampler.h
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sstv::dsp {
+
+    // 输入端重采样方式
+    enum class ResamplerMode {
+        LIBSAMPLERATE, // 通用 sinc 重采样 (dsp::Resampler) + 独立的带通 FIRFilter
+        POLYPHASE      // 固定倍率多相重采样，带通滤波并入抗混叠滤波器 (dsp::PolyphaseResampler)
+    };
+
+    // 固定有理倍率 L/M 的多相重采样器，抗混叠低通同时就是 SSTV 带通滤波器
+    //
+    // 原型滤波器在上采样率 input_rate * L 下设计（与 FIRFilter 相同的 Hamming 窗 sinc 带通），
+    // 按相位拆成 L 组、每组 K 个抽头。每个输出样本只计算一次 K 抽头点积，
+    // 被丢弃的样本完全不计算，因此重采样 + 带通合并为一次遍历：
+    //   44100 -> 11025: L/M = 1/4
+    //   48000 -> 11025: L/M = 147/640
+    // K 取为 output_tap_count 个输出样本所对应的输入时长，因此时域跨度（和过渡带宽）
+    // 与在输出采样率下运行 output_tap_count 抽头的 FIRFilter 相同
+    class PolyphaseResampler {
+    public:
+        // 允许的最大插值因子 L（原型滤波器长度为 L * K）
+        static constexpr size_t MAX_INTERPOLATION = 1024;
+
+        /**
+         * @param input_rate  原始采样率（必须为整数 Hz）
+         * @param output_rate 目标采样率（必须为整数 Hz）
+         * @param output_tap_count 等效的输出采样率下带通滤波器抽头数
+         * @param cutoff_freq_low / cutoff_freq_high 带通截止频率 (Hz)
+         * @throws std::runtime_error 倍率不受支持时（见 is_supported）
+         */
+        PolyphaseResampler(double input_rate, double output_rate, int output_tap_count,
+                           double cutoff_freq_low, double cutoff_freq_high);
+
+        // 两个采样率均为整数，且约分后的插值因子不超过 MAX_INTERPOLATION
+        static bool is_supported(double input_rate, double output_rate);
+
+        /**
+         * @brief 无分配的流式接口：重采样并带通滤波后的样本写入 output
+         * @param output 容量至少为 max_output_size(input.size())
+         * @return 实际写入 output 的样本数
+         */
+        size_t process_into(std::span<const float> input, std::span<float> output);
+
+        // 输入 input_count 个样本时输出样本数的上界
+        [[nodiscard]] size_t max_output_size(size_t input_count) const {
+            return (input_count * m_up) / m_down + 1;
+        }
+
+        void reset();
+
+        [[nodiscard]] size_t interpolation() const { return m_up; }
+        [[nodiscard]] size_t decimation() const { return m_down; }
+        [[nodiscard]] size_t taps_per_phase() const { return m_taps_per_phase; }
+
+    private:
+        size_t m_up;                       // 插值因子 L
+        size_t m_down;                     // 抽取因子 M
+        size_t m_taps_per_phase;           // 每相抽头数 K
+
+        // L 组时间反转后的相位系数，第 p 组: m_phase_taps[p*K + (K-1-k)] = h[p + k*L]
+        std::vector<float> m_phase_taps;
+        std::vector<float> m_history;      // 最近 K-1 个输入样本
+        std::vector<float> m_block_buffer; // 线性工作区：[K-1 个历史样本 | 输入块]
+
+        // 下一个输出样本在上采样时间轴上相对当前块第 0 个输入样本的位置
+        size_t m_next_output;
+    };
+
+} // namespace sstv::dsp
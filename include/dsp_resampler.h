@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstddef>
+#include <span>
 #include <samplerate.h> // libsamplerate 头文件
 
 namespace sstv::dsp {
@@ -24,6 +25,19 @@ namespace sstv::dsp {
         Resampler& operator=(const Resampler&) = delete;
 
         std::vector<float> process_block(const float* input, size_t count);
+
+        /**
+         * @brief 无分配的流式接口：重采样结果写入调用方提供的 output
+         * @param output 容量至少为 max_output_size(input.size())
+         * @return 实际写入 output 的样本数
+         */
+        size_t process_into(std::span<const float> input, std::span<float> output);
+
+        // 输入 input_count 个样本时输出样本数的上界（考虑到 ratio 和内部缓存）
+        [[nodiscard]] size_t max_output_size(size_t input_count) const {
+            return static_cast<size_t>(input_count * m_ratio) + 128;
+        }
+
         void reset();
 
     private:
@@ -0,0 +1,273 @@
+// include/dsp_simd.h
+#pragma once
+
+#include <cstddef>
+
+// 指令集选择：AVX2+FMA（需显式开启 SSTV_ENABLE_AVX2）> SSE2（x86-64 基线）> NEON（AArch64 基线）> 标量
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    #define SSTV_SIMD_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SSTV_SIMD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+    #define SSTV_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace sstv::dsp::simd {
+
+#if defined(SSTV_SIMD_AVX2)
+inline float hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+    return _mm_cvtss_f32(lo);
+}
+#elif defined(SSTV_SIMD_SSE2)
+inline float hsum(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+// 点积: sum_{k=0}^{n-1} a[k] * b[k]，两个数组均要求连续存放
+inline float dot_product(const float* a, const float* b, size_t n) {
+    size_t k = 0;
+    float sum = 0.0f;
+#if defined(SSTV_SIMD_AVX2)
+    __m256 acc = _mm256_setzero_ps();
+    for (; k + 8 <= n; k += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k), acc);
+    }
+    sum = hsum(acc);
+#elif defined(SSTV_SIMD_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; k + 4 <= n; k += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + k), _mm_loadu_ps(b + k)));
+    }
+    sum = hsum(acc);
+#elif defined(SSTV_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; k + 4 <= n; k += 4) {
+        acc = vfmaq_f32(acc, vld1q_f32(a + k), vld1q_f32(b + k));
+    }
+    sum = vaddvq_f32(acc);
+#endif
+    for (; k < n; ++k) sum += a[k] * b[k];
+    return sum;
+}
+
+// FIR 块卷积: out[i] = sum_{k=0}^{taps-1} coeffs[k] * x[i + k]
+// coeffs 为时间反转后的系数，x 为线性（非循环）输入，长度至少为 count + taps - 1
+// 每次迭代产生 4 个输出，系数只加载一次，供 4 个累加器共享
+inline void fir_block(const float* coeffs, size_t taps, const float* x, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* x0 = x + i;
+        size_t k = 0;
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+#if defined(SSTV_SIMD_AVX2)
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+        for (; k + 8 <= taps; k += 8) {
+            __m256 c = _mm256_loadu_ps(coeffs + k);
+            a0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(x0 + k), a0);
+            a1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(x0 + k + 1), a1);
+            a2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(x0 + k + 2), a2);
+            a3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(x0 + k + 3), a3);
+        }
+        s0 = hsum(a0); s1 = hsum(a1); s2 = hsum(a2); s3 = hsum(a3);
+#elif defined(SSTV_SIMD_SSE2)
+        __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+        for (; k + 4 <= taps; k += 4) {
+            __m128 c = _mm_loadu_ps(coeffs + k);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(c, _mm_loadu_ps(x0 + k)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(c, _mm_loadu_ps(x0 + k + 1)));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(c, _mm_loadu_ps(x0 + k + 2)));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(c, _mm_loadu_ps(x0 + k + 3)));
+        }
+        s0 = hsum(a0); s1 = hsum(a1); s2 = hsum(a2); s3 = hsum(a3);
+#elif defined(SSTV_SIMD_NEON)
+        float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+        float32x4_t a2 = vdupq_n_f32(0.0f), a3 = vdupq_n_f32(0.0f);
+        for (; k + 4 <= taps; k += 4) {
+            float32x4_t c = vld1q_f32(coeffs + k);
+            a0 = vfmaq_f32(a0, c, vld1q_f32(x0 + k));
+            a1 = vfmaq_f32(a1, c, vld1q_f32(x0 + k + 1));
+            a2 = vfmaq_f32(a2, c, vld1q_f32(x0 + k + 2));
+            a3 = vfmaq_f32(a3, c, vld1q_f32(x0 + k + 3));
+        }
+        s0 = vaddvq_f32(a0); s1 = vaddvq_f32(a1); s2 = vaddvq_f32(a2); s3 = vaddvq_f32(a3);
+#endif
+        // 剩余抽头
+        for (; k < taps; ++k) {
+            float c = coeffs[k];
+            s0 += c * x0[k];
+            s1 += c * x0[k + 1];
+            s2 += c * x0[k + 2];
+            s3 += c * x0[k + 3];
+        }
+        out[i] = s0; out[i + 1] = s1; out[i + 2] = s2; out[i + 3] = s3;
+    }
+    // 剩余输出
+    for (; i < count; ++i) {
+        out[i] = dot_product(coeffs, x + i, taps);
+    }
+}
+
+// 奇对称、仅奇数偏移非零的 FIR（希尔伯特变换）块卷积:
+// out[j] = sum_{t=0}^{HALF_TAPS-1} h[t] * (center[j - (2t+1)] - center[j + (2t+1)])
+// 偶数偏移项恒为 0，在编译期就被略去；利用奇对称再把乘法减半
+// 向量化方向为输出序号 j（系数广播，输入连续加载）
+// 为保证与逐样本路径逐位一致，这里使用非融合的乘加
+template <size_t HALF_TAPS>
+inline void odd_antisymmetric_fir_block(const float* h, const float* center, float* out, size_t count) {
+    size_t j = 0;
+#if defined(SSTV_SIMD_AVX2)
+    for (; j + 8 <= count; j += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t t = 0; t < HALF_TAPS; ++t) {
+            const size_t k = 2 * t + 1;
+            __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(center + j - k), _mm256_loadu_ps(center + j + k));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(h[t]), diff));
+        }
+        _mm256_storeu_ps(out + j, acc);
+    }
+#elif defined(SSTV_SIMD_SSE2)
+    for (; j + 4 <= count; j += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (size_t t = 0; t < HALF_TAPS; ++t) {
+            const size_t k = 2 * t + 1;
+            __m128 diff = _mm_sub_ps(_mm_loadu_ps(center + j - k), _mm_loadu_ps(center + j + k));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(h[t]), diff));
+        }
+        _mm_storeu_ps(out + j, acc);
+    }
+#elif defined(SSTV_SIMD_NEON)
+    for (; j + 4 <= count; j += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (size_t t = 0; t < HALF_TAPS; ++t) {
+            const size_t k = 2 * t + 1;
+            float32x4_t diff = vsubq_f32(vld1q_f32(center + j - k), vld1q_f32(center + j + k));
+            acc = vaddq_f32(acc, vmulq_f32(vdupq_n_f32(h[t]), diff));
+        }
+        vst1q_f32(out + j, acc);
+    }
+#endif
+    for (; j < count; ++j) {
+        float acc = 0.0f;
+        for (size_t t = 0; t < HALF_TAPS; ++t) {
+            const size_t k = 2 * t + 1;
+            acc += h[t] * (center[j - k] - center[j + k]);
+        }
+        out[j] = acc;
+    }
+}
+
+// 复系数折叠（多相滤波器组）: out[j] = sum_{p=0}^{branches-1} c[p*width + j] * x[p*width + j]，j < width
+// 复系数 c 的实部 / 虚部分别存放于 c_re / c_im，x 为实数输入
+// 向量化方向为 j，每组 j 的累加器在全部分支上保持在寄存器中
+inline void complex_fold(const float* c_re, const float* c_im, const float* x, size_t branches, size_t width,
+                         float* out_re, float* out_im) {
+    size_t j = 0;
+#if defined(SSTV_SIMD_AVX2)
+    for (; j + 8 <= width; j += 8) {
+        __m256 re = _mm256_setzero_ps(), im = _mm256_setzero_ps();
+        for (size_t p = 0, k = j; p < branches; ++p, k += width) {
+            const __m256 v = _mm256_loadu_ps(x + k);
+            re = _mm256_fmadd_ps(_mm256_loadu_ps(c_re + k), v, re);
+            im = _mm256_fmadd_ps(_mm256_loadu_ps(c_im + k), v, im);
+        }
+        _mm256_storeu_ps(out_re + j, re);
+        _mm256_storeu_ps(out_im + j, im);
+    }
+#elif defined(SSTV_SIMD_SSE2)
+    for (; j + 4 <= width; j += 4) {
+        __m128 re = _mm_setzero_ps(), im = _mm_setzero_ps();
+        for (size_t p = 0, k = j; p < branches; ++p, k += width) {
+            const __m128 v = _mm_loadu_ps(x + k);
+            re = _mm_add_ps(re, _mm_mul_ps(_mm_loadu_ps(c_re + k), v));
+            im = _mm_add_ps(im, _mm_mul_ps(_mm_loadu_ps(c_im + k), v));
+        }
+        _mm_storeu_ps(out_re + j, re);
+        _mm_storeu_ps(out_im + j, im);
+    }
+#elif defined(SSTV_SIMD_NEON)
+    for (; j + 4 <= width; j += 4) {
+        float32x4_t re = vdupq_n_f32(0.0f), im = vdupq_n_f32(0.0f);
+        for (size_t p = 0, k = j; p < branches; ++p, k += width) {
+            const float32x4_t v = vld1q_f32(x + k);
+            re = vfmaq_f32(re, vld1q_f32(c_re + k), v);
+            im = vfmaq_f32(im, vld1q_f32(c_im + k), v);
+        }
+        vst1q_f32(out_re + j, re);
+        vst1q_f32(out_im + j, im);
+    }
+#endif
+    for (; j < width; ++j) {
+        float re = 0.0f, im = 0.0f;
+        for (size_t p = 0, k = j; p < branches; ++p, k += width) {
+            re += c_re[k] * x[k];
+            im += c_im[k] * x[k];
+        }
+        out_re[j] = re;
+        out_im[j] = im;
+    }
+}
+
+// 基 2 蝶形（实部 / 虚部分开存放）: v = b * w; a' = a + v; b' = a - v，j < n
+inline void radix2_butterflies(float* ar, float* ai, float* br, float* bi, const float* wr, const float* wi,
+                               size_t n) {
+    size_t j = 0;
+#if defined(SSTV_SIMD_AVX2)
+    for (; j + 8 <= n; j += 8) {
+        const __m256 xr = _mm256_loadu_ps(br + j), xi = _mm256_loadu_ps(bi + j);
+        const __m256 cr = _mm256_loadu_ps(wr + j), ci = _mm256_loadu_ps(wi + j);
+        const __m256 vr = _mm256_fmsub_ps(xr, cr, _mm256_mul_ps(xi, ci));
+        const __m256 vi = _mm256_fmadd_ps(xr, ci, _mm256_mul_ps(xi, cr));
+        const __m256 ur = _mm256_loadu_ps(ar + j), ui = _mm256_loadu_ps(ai + j);
+        _mm256_storeu_ps(ar + j, _mm256_add_ps(ur, vr));
+        _mm256_storeu_ps(ai + j, _mm256_add_ps(ui, vi));
+        _mm256_storeu_ps(br + j, _mm256_sub_ps(ur, vr));
+        _mm256_storeu_ps(bi + j, _mm256_sub_ps(ui, vi));
+    }
+#elif defined(SSTV_SIMD_SSE2)
+    for (; j + 4 <= n; j += 4) {
+        const __m128 xr = _mm_loadu_ps(br + j), xi = _mm_loadu_ps(bi + j);
+        const __m128 cr = _mm_loadu_ps(wr + j), ci = _mm_loadu_ps(wi + j);
+        const __m128 vr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+        const __m128 vi = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+        const __m128 ur = _mm_loadu_ps(ar + j), ui = _mm_loadu_ps(ai + j);
+        _mm_storeu_ps(ar + j, _mm_add_ps(ur, vr));
+        _mm_storeu_ps(ai + j, _mm_add_ps(ui, vi));
+        _mm_storeu_ps(br + j, _mm_sub_ps(ur, vr));
+        _mm_storeu_ps(bi + j, _mm_sub_ps(ui, vi));
+    }
+#elif defined(SSTV_SIMD_NEON)
+    for (; j + 4 <= n; j += 4) {
+        const float32x4_t xr = vld1q_f32(br + j), xi = vld1q_f32(bi + j);
+        const float32x4_t cr = vld1q_f32(wr + j), ci = vld1q_f32(wi + j);
+        const float32x4_t vr = vmlsq_f32(vmulq_f32(xr, cr), xi, ci);
+        const float32x4_t vi = vmlaq_f32(vmulq_f32(xr, ci), xi, cr);
+        const float32x4_t ur = vld1q_f32(ar + j), ui = vld1q_f32(ai + j);
+        vst1q_f32(ar + j, vaddq_f32(ur, vr));
+        vst1q_f32(ai + j, vaddq_f32(ui, vi));
+        vst1q_f32(br + j, vsubq_f32(ur, vr));
+        vst1q_f32(bi + j, vsubq_f32(ui, vi));
+    }
+#endif
+    for (; j < n; ++j) {
+        const float vr = br[j] * wr[j] - bi[j] * wi[j];
+        const float vi = br[j] * wi[j] + bi[j] * wr[j];
+        const float ur = ar[j], ui = ai[j];
+        ar[j] = ur + vr; ai[j] = ui + vi;
+        br[j] = ur - vr; bi[j] = ui - vi;
+    }
+}
+
+} // namespace sstv::dsp::simd
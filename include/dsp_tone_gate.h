@@ -0,0 +1,52 @@
+// include/dsp_tone_gate.h
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sstv::dsp {
+
+// 空闲信道音调检测：抽取式 Goertzel 滤波器组
+//
+// 每 DUTY_CYCLE 个 BLOCK_SIZE 样本块只分析其中一块，对一组覆盖前导音 (1900Hz) 及 AFC 捕获范围的频点
+// 计算 Goertzel 能量，取最大频点能量与块能量之比作为“纯度”：理想单音在频点上的纯度为 1，
+// 白噪声约为 2 / BLOCK_SIZE。频点间隔为半个频率分辨率，失谐最坏情况下单音纯度仍约 0.8。
+// 连续 CONFIRM_BLOCKS 个分析块都检出才判定为有音调，以压低带通噪声的误触发；前导音各段 (1900/1500/2300Hz)
+// 都在频点组范围内，11025Hz 下分析周期约 46ms，检出延迟不超过约 105ms
+class ToneGate {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;  // 11.6ms @ 11025Hz，分辨率约 86Hz
+    static constexpr size_t DUTY_CYCLE = 4;    // 每 4 块分析 1 块
+    static constexpr size_t CONFIRM_BLOCKS = 2;
+
+    /**
+     * @param sample_rate 输入采样率
+     * @param center_freq 频点组中心 (Hz)
+     * @param half_span 频点组覆盖 center_freq ± half_span (Hz)
+     * @param purity_threshold 判定为音调的最小纯度
+     * @param energy_floor 块均方值低于此值视为静音
+     */
+    explicit ToneGate(double sample_rate, double center_freq = 1900.0, double half_span = 500.0,
+                      float purity_threshold = 0.2f, float energy_floor = 1e-8f);
+
+    // 处理一段样本，返回其中是否有分析块检测到音调
+    bool process(std::span<const float> input);
+    void reset();
+
+    [[nodiscard]] size_t bin_count() const { return m_coeffs.size(); }
+
+private:
+    bool finish_block();
+
+    std::vector<float> m_coeffs;  // 各频点的 2cos(w)
+    std::vector<float> m_s1;      // Goertzel 状态 s[n-1]
+    std::vector<float> m_s2;      // Goertzel 状态 s[n-2]
+    float m_energy = 0.0f;        // 当前分析块的能量
+    size_t m_position = 0;        // 在 DUTY_CYCLE * BLOCK_SIZE 周期中的位置
+    size_t m_consecutive = 0;     // 连续检出的分析块数
+    float m_purity_threshold;
+    float m_energy_floor;
+};
+
+} // namespace sstv::dsp
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sstv {
+
+// Memory mapping of a whole file (POSIX mmap / Win32 file mapping)
+class MappedFile {
+public:
+    // Map an existing file read-only
+    explicit MappedFile(const std::string& path);
+    // Create (or truncate) a zero-filled file of `size` bytes and map it writable
+    MappedFile(const std::string& path, size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const uint8_t* data() const { return m_data; }
+    // nullptr for read-only mappings
+    [[nodiscard]] uint8_t* writable_data() { return m_writable ? const_cast<uint8_t*>(m_data) : nullptr; }
+    [[nodiscard]] size_t size() const { return m_size; }
+
+    // Tell the OS a range has been consumed. The pages stay file-backed and
+    // are faulted in again on access; they just stop counting towards RSS.
+    void release(size_t offset, size_t length);
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_writable = false;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+// Sample type of raw (headerless) files; WAV files are always recognised by their header
+enum class SampleFormat {
+    AUTO,     // By extension: .s16/.pcm -> INT16, anything else -> FLOAT32
+    FLOAT32,
+    INT16
+};
+
+// Sequential reader for raw float32, raw int16 and WAV (PCM16 / IEEE float32) recordings.
+//
+// The file is memory-mapped and handed out block by block as mono float
+// samples. Raw float32 mono data is returned straight from the mapped pages;
+// other layouts are converted into one reused block buffer. Pages behind the
+// read position are released as reading progresses, so resident memory stays
+// constant regardless of recording length. If the file cannot be mapped, the
+// reader falls back to buffered reads with a bounded read-ahead buffer.
+// Multi-channel WAV files are read from their first channel.
+class AudioFileReader {
+public:
+    static constexpr size_t DEFAULT_BLOCK_FRAMES = 4096;
+
+    explicit AudioFileReader(const std::string& path, SampleFormat format = SampleFormat::AUTO);
+    ~AudioFileReader();
+
+    AudioFileReader(const AudioFileReader&) = delete;
+    AudioFileReader& operator=(const AudioFileReader&) = delete;
+
+    // Next block of at most max_frames samples; empty at end of file.
+    // The span stays valid until the next call.
+    std::span<const float> next_block(size_t max_frames = DEFAULT_BLOCK_FRAMES);
+
+    // The whole recording as one float array if it can be used in place
+    // (mapped raw float32 mono data), otherwise empty
+    [[nodiscard]] std::span<const float> contiguous() const;
+
+    void rewind();
+
+    [[nodiscard]] bool is_wav() const { return m_is_wav; }
+    [[nodiscard]] bool is_mapped() const { return m_mapped != nullptr; }
+    [[nodiscard]] SampleFormat format() const { return m_format; }
+    [[nodiscard]] int channels() const { return m_channels; }
+    // Sample rate from the WAV header, 0 for raw files
+    [[nodiscard]] double sample_rate() const { return m_sample_rate; }
+    [[nodiscard]] size_t frame_count() const { return m_frame_count; }
+    [[nodiscard]] size_t position() const { return m_position; }
+
+private:
+    // Bytes consumed between two page releases, and the streaming read-ahead size
+    static constexpr size_t RELEASE_GRANULARITY = 4 * 1024 * 1024;
+    static constexpr size_t READ_AHEAD_BYTES = 256 * 1024;
+
+    void read_bytes(size_t offset, void* dst, size_t length);
+    void parse_wav_header(size_t file_size);
+    void convert(const uint8_t* src, float* dst, size_t frames) const;
+
+    std::unique_ptr<MappedFile> m_mapped;
+    std::ifstream m_stream;
+
+    bool m_is_wav = false;
+    SampleFormat m_format = SampleFormat::FLOAT32;
+    int m_channels = 1;
+    double m_sample_rate = 0.0;
+    size_t m_bytes_per_sample = sizeof(float);
+    size_t m_frame_stride = sizeof(float);  // Bytes per frame (all channels)
+    size_t m_data_offset = 0;
+    size_t m_frame_count = 0;
+
+    size_t m_position = 0;       // Frames already handed out
+    size_t m_released_bytes = 0; // Mapped data bytes already released
+
+    std::vector<float> m_block_buffer;
+    std::vector<uint8_t> m_read_buffer;
+};
+
+} // namespace sstv
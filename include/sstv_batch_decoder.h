@@ -0,0 +1,50 @@
+#pragma once
+
+#include "sstv_types.h"
+#include "dsp_freq_estimator.h"
+#include "dsp_polyphase_resampler.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sstv {
+
+// One image found in a recording
+struct DecodedImage {
+    SSTVMode mode;
+    size_t sample_offset = 0;   // Input-rate sample index where the VIS header starts (estimated)
+    size_t data_offset = 0;     // Input-rate sample index where the VIS header ended / image data starts
+    int width = 0;
+    int height = 0;
+    int lines_decoded = 0;
+    bool complete = false;      // False if the recording ended before the last line
+    std::vector<Pixel> pixels;  // width * height, row-major
+};
+
+struct BatchDecodeOptions {
+    size_t max_threads = 0;     // Segment decoding threads, 0 = std::thread::hardware_concurrency()
+    size_t chunk_size = 4096;   // Samples per Decoder::process call while decoding a segment
+    dsp::DiscriminatorMode discriminator = dsp::DiscriminatorMode::ATAN2;
+    dsp::ResamplerMode resampler = dsp::ResamplerMode::LIBSAMPLERATE; // Used by the scan and every segment Decoder
+    bool tone_gate = true;      // Run the scan's front end only around leader-tone energy; disable for very weak signals
+};
+
+// Faster-than-realtime decoding of whole recordings.
+//
+// A first pass looks for VIS headers: a duty-cycled Goertzel tone gate
+// (dsp::ToneGate) runs over the raw input, and the VIS front end (resampler,
+// bandpass, FM discriminator, VISDecoder) only runs from shortly before
+// leader-tone energy shows up until the tone has been gone for a while. The
+// body of every image found is skipped. Each detected transmission is then
+// decoded by its own Decoder on a separate thread. Images are returned in
+// recording order.
+std::vector<DecodedImage> decode_buffer(const float* samples, size_t count, double sample_rate,
+                                        const BatchDecodeOptions& options = {});
+
+// Same as decode_buffer() for a recording on disk (raw float32, raw int16 or
+// WAV, see AudioFileReader). WAV files use the sample rate from their header.
+std::vector<DecodedImage> decode_file(const std::string& path, double sample_rate,
+                                      const BatchDecodeOptions& options = {});
+
+} // namespace sstv
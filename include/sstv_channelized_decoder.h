@@ -0,0 +1,103 @@
+#pragma once
+
+#include "sstv_decoder.h"
+#include "dsp_channelizer.h"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace sstv {
+
+// Decodes several SSTV transmissions that share one wideband feed at
+// different audio offsets.
+//
+// A dsp::Channelizer (polyphase FFT filter bank) splits the input into
+// equally spaced sub-channels, decimated to the lowest rate that still holds
+// the channel band (8000 Hz for 48 kHz input), and every selected sub-channel
+// runs its own Decoder (VIS search, demodulation,
+// frame output). The split costs one shared FFT per decimated sample however
+// many channels are decoded, instead of a full-rate bandpass and resampler
+// per channel. Sub-channels are at most `max_channel_spacing` apart, so a
+// transmission sits within half a spacing of its channel's centre; each
+// Decoder's AFC (the VIS leader-tone estimate, then the demodulator's
+// per-line tracking) removes the rest, and signal_offset() reports where the
+// transmission really is.
+//
+// Each channel passes CHANNEL_CENTER_HZ +- CHANNEL_PASSBAND_HZ around its
+// offset, so transmissions closer together than about twice that overlap and
+// disturb each other, and one between two selected channels may be decoded by
+// both. Below an offset of about -500 Hz the lowest tones fold over 0 Hz
+// onto their own mirror image, and the channel no longer decodes.
+//
+// Everything runs on the thread calling process(), channel by channel;
+// callbacks carry the index of the channel (its position in `offsets`).
+class ChannelizedDecoder {
+public:
+    static constexpr double CHANNEL_CENTER_HZ = 1700.0;      // Middle of the 1100-2300 Hz SSTV band
+    static constexpr double CHANNEL_PASSBAND_HZ = 1200.0;    // 500-2900 Hz: all tones +- half a spacing
+    static constexpr double CHANNEL_STOPBAND_HZ = 1800.0;
+    static constexpr double DEFAULT_MAX_CHANNEL_SPACING = 800.0;  // Well within the VIS AFC capture range
+    static constexpr size_t MAX_BLOCK_SAMPLES = 4096;        // process() splits larger blocks
+
+    // `offsets` lists the audio offsets (Hz) to decode, each snapped to the
+    // nearest sub-channel: a transmission at offset d has its 1900 Hz leader
+    // tone at 1900 + d in the input. The sub-channel count is the smallest
+    // power of two that keeps the spacing at or below `max_channel_spacing`.
+    // `resampler` is passed on to every channel's Decoder, which brings the
+    // sub-channel rate (channel_rate()) to INTERNAL_SAMPLE_RATE.
+    ChannelizedDecoder(double sample_rate, std::vector<double> offsets,
+                       double max_channel_spacing = DEFAULT_MAX_CHANNEL_SPACING,
+                       dsp::ResamplerMode resampler = dsp::ResamplerMode::POLYPHASE);
+
+    ChannelizedDecoder(const ChannelizedDecoder&) = delete;
+    ChannelizedDecoder& operator=(const ChannelizedDecoder&) = delete;
+
+    // Push wideband samples at the constructor's sample_rate
+    void process(const float* samples, size_t count);
+    // Decode samples the channels' decoders hold back (see Decoder::flush)
+    void flush();
+    // Reset the filter bank and every channel
+    void reset();
+
+    [[nodiscard]] size_t channel_count() const { return m_decoders.size(); }
+    [[nodiscard]] double channel_rate() const { return m_channelizer.output_rate(); }
+    [[nodiscard]] double channel_spacing() const { return m_channelizer.channel_spacing(); }
+    [[nodiscard]] const dsp::Channelizer& channelizer() const { return m_channelizer; }
+    // The channel's offset after snapping to the sub-channel grid
+    [[nodiscard]] double channel_offset(size_t channel) const;
+    // channel_offset() plus the channel decoder's current AFC estimate (see
+    // Decoder::afc_offset): the offset of the transmission being decoded
+    [[nodiscard]] double signal_offset(size_t channel) const;
+
+    // The channel's own Decoder, for anything not forwarded below (frame
+    // manager, image writer, processing mode, ...). Its mode-detected,
+    // line-decoded and image-complete callbacks are owned by this class.
+    [[nodiscard]] Decoder& decoder(size_t channel);
+    [[nodiscard]] const Decoder& decoder(size_t channel) const;
+    [[nodiscard]] DecoderStats channel_stats(size_t channel) const { return decoder(channel).stats(); }
+
+    // Applied to every channel (see the Decoder setters of the same name)
+    void set_tone_gate_enabled(bool enabled);
+    void set_vis_engine(VISEngine engine);
+    void set_sync_mode(SyncMode mode);
+    void set_image_timeout_lines(int lines);
+
+    void set_on_mode_detected_callback(ChannelModeDetectedCallback cb) { m_on_mode_detected_cb = std::move(cb); }
+    void set_on_line_decoded_callback(ChannelLineDecodedCallback cb) { m_on_line_decoded_cb = std::move(cb); }
+    void set_on_image_complete_callback(ChannelImageCompleteCallback cb) { m_on_image_complete_cb = std::move(cb); }
+
+private:
+    dsp::Channelizer m_channelizer;
+    std::vector<size_t> m_subchannels;       // Channel -> channelizer sub-channel (FFT bin)
+    std::vector<std::unique_ptr<Decoder>> m_decoders;
+    std::vector<float> m_channel_buffer;     // One stride of decimated samples per channel
+    size_t m_stride;
+
+    ChannelModeDetectedCallback m_on_mode_detected_cb;
+    ChannelLineDecodedCallback m_on_line_decoded_cb;
+    ChannelImageCompleteCallback m_on_image_complete_cb;
+};
+
+} // namespace sstv
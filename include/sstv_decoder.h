@@ -1,14 +1,27 @@
 #pragma once
 
 #include "sstv_types.h"
+#include "sstv_stats.h"
+#include "sstv_trace.h"
+#include "sstv_frame_manager.h"
+#include "sstv_freq_track.h"
+#include "sstv_image_writer.h"
 #include "dsp_filters.h"
 #include "dsp_freq_estimator.h"
 #include "dsp_resampler.h"
+#include "dsp_polyphase_resampler.h"
+#include "dsp_fused_pipeline.h"
+#include "dsp_tone_gate.h"
 #include "sstv_vis_decoder.h"
-#include "sstv_pd_demodulator.h"
+#include "sstv_vis_goertzel.h"
+#include "sstv_demodulator.h"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
+#include <span>
 #include <functional>
 #include <memory>
 #include <iostream>
@@ -17,10 +30,62 @@
 
 namespace sstv {
 
+// Point-in-time copy of a Decoder's monitoring counters (see Decoder::stats()).
+// All counts are cumulative since construction or the last reset_stats().
+struct DecoderStats {
+    uint64_t samples_processed = 0;       // Input samples passed to process()
+    uint64_t gated_samples = 0;           // Internal-rate samples skipped by the tone gate (incl. later replayed)
+    uint64_t gate_openings = 0;           // Idle -> full-rate transitions of the tone gate
+
+    // Cumulative wall time per stage (ns). With the fused pipeline, bandpass,
+    // estimator and state machine run interleaved per tile and are reported
+    // together as fused_front_end_ns; with the polyphase front end the bandpass
+    // is part of resampler_ns.
+    uint64_t resampler_ns = 0;
+    uint64_t bandpass_ns = 0;
+    uint64_t estimator_ns = 0;
+    uint64_t state_machine_ns = 0;
+    uint64_t fused_front_end_ns = 0;
+
+    // VIS header search. With the Goertzel engine, lost leaders are counted
+    // under LEADER_BURST_1 and framing errors under START_BIT. Parity errors
+    // and unknown modes are not also counted in vis_resets, so the counters
+    // can be summed.
+    std::array<uint64_t, VISDecoder::STATE_COUNT> vis_resets{}; // Abandoned headers, by VISDecoder::State
+    uint64_t vis_parity_errors = 0;
+    uint64_t vis_headers_decoded = 0;
+    uint64_t vis_unknown_modes = 0;
+
+    // Image demodulation
+    uint64_t pd_syncs_detected = 0;
+    uint64_t pd_sync_timeouts = 0;
+    uint64_t lines_emitted = 0;
+    uint64_t images_completed = 0;
+    uint64_t images_cancelled = 0;        // cancel_image() while an image was in progress
+    uint64_t images_timed_out = 0;        // Abandoned after losing line sync (set_image_timeout_lines)
+
+    double afc_offset = 0.0;              // Current frequency offset estimate (Hz)
+};
+
+// How Decoder::process() cuts the caller's blocks (see Decoder::set_processing_mode)
+enum class ProcessingMode {
+    BALANCED,     // Each block is decoded as passed in (default)
+    LOW_LATENCY,  // Blocks are split into ~5 ms tiles, callbacks fire as soon as a line is done
+    THROUGHPUT    // Blocks are regrouped into L2-sized tiles, line callbacks fire at the end of each tile
+};
+
 // The top-level SSTV Decoder class
 class Decoder {
 public:
-    explicit Decoder(double sample_rate);
+    static constexpr int FIR_TAP_COUNT = 31; // Example tap count, adjust for desired filter quality
+    static constexpr double INTERNAL_SAMPLE_RATE = 11025.0; // Target sample rate for internal processing
+
+    // `resampler` selects how input audio is brought to INTERNAL_SAMPLE_RATE.
+    // POLYPHASE folds the 300-3000 Hz bandpass into a fixed-ratio polyphase
+    // decimator (one pass instead of resampler + FIR). It needs an integer
+    // input rate with a small reduced ratio (44100, 48000, 22050, ...);
+    // other rates fall back to LIBSAMPLERATE.
+    explicit Decoder(double sample_rate, dsp::ResamplerMode resampler = dsp::ResamplerMode::LIBSAMPLERATE);
     ~Decoder();
 
     // Core entry point: Push audio samples into the decoder
@@ -31,10 +96,169 @@ public:
     // Reset the decoder to its initial state (e.g., to search for a new transmission)
     void reset();
 
+    // Trade callback latency for throughput.
+    // - LOW_LATENCY runs the whole chain on tiles of LOW_LATENCY_TILE_MS of
+    //   input, so a line's callbacks fire before the rest of a large block is
+    //   even resampled. Pair it with small blocks (preferred_block_size()).
+    // - THROUGHPUT regroups input into tiles of THROUGHPUT_TILE_SAMPLES
+    //   internal-rate samples and runs them through the tile-fused front end
+    //   (see set_fused_pipeline_enabled). Smaller blocks are held back until a
+    //   tile is full, so call flush() at the end of the stream. Line callbacks
+    //   (line decoded / line ready) are queued and fire at the end of each tile.
+    //   Other callbacks first deliver the queued lines, so event order is
+    //   unchanged. Calls a callback makes act after the tile, not the next sample.
+    // The decoded output does not depend on the mode, except where the
+    // front end itself depends on block size (the libsamplerate resampler).
+    // Switching flushes staged samples. Does not affect replay().
+    void set_processing_mode(ProcessingMode mode);
+    [[nodiscard]] ProcessingMode processing_mode() const { return m_processing_mode; }
+    // Input block size (samples at the decoder's rate) that suits the mode:
+    // one tile for LOW_LATENCY and THROUGHPUT, DEFAULT_BLOCK_SIZE otherwise
+    [[nodiscard]] size_t preferred_block_size() const;
+    // Decode samples held back by THROUGHPUT mode; no-op otherwise and from inside a callback
+    void flush();
+
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1024;
+    static constexpr double LOW_LATENCY_TILE_MS = 5.0;
+    static constexpr size_t THROUGHPUT_TILE_SAMPLES = 8192;  // ~740 ms, ~130 KB of working set
+
+    // Record the post-FrequencyEstimator stream (bandpassed sample + frequency)
+    // into `writer` while decoding, for later replay(). The writer is not
+    // owned and must outlive the recording; pass nullptr to stop. Samples the
+    // tone gate skips are not recorded, so disable the gate for a gap-free track.
+    void set_freq_track_writer(FreqTrackWriter* writer) { m_track_writer = writer; }
+
+    // Stream every image into `writer` (see ImageWriter): rows are handed to
+    // its background thread as they are decoded, and the file is finished and
+    // renamed into place when the image ends, however it ends. Images dropped
+    // by reset() are discarded. The writer is not owned and must outlive its
+    // use; pass nullptr to stop. Switching drops the image in progress from
+    // the old writer; the new one starts with the next image.
+    void set_image_writer(ImageWriter* writer);
+
+    // Feed a recorded stream straight into the VIS / PD state machines,
+    // skipping resampling, bandpass and FM discrimination. The stream must be
+    // at INTERNAL_SAMPLE_RATE, as recorded by set_freq_track_writer(); the
+    // decoder's own sample rate does not matter. Callbacks, stats and image
+    // lifecycle behave as with process().
+    void replay(std::span<const float> filtered, std::span<const FreqSample> frequencies);
+    // Replay the rest of a track file. Throws if it was recorded at another rate.
+    void replay(FreqTrackReader& track);
+
+    // Select the FM discriminator: exact double-precision atan2 (default) or the
+    // polynomial approximation (<= 0.021 Hz error, see dsp::DiscriminatorMode)
+    void set_discriminator_mode(dsp::DiscriminatorMode mode) { m_freq_estimator->set_discriminator_mode(mode); }
+
+    // Select how PD line syncs are located: the per-sample envelope threshold
+    // (default) or a correlation search over several candidate positions around
+    // the predicted sync, which also corrects slant from sample-rate error.
+    // Correlation mode emits each line pair one line pair later. Takes effect
+    // with the next image.
+    void set_sync_mode(SyncMode mode);
+    [[nodiscard]] SyncMode sync_mode() const { return m_sync_mode; }
+
+    // Run bandpass, Hilbert/FM discrimination and the protocol state machine in
+    // one L1-resident pass per tile instead of separate whole-block passes.
+    // Output is bit-identical to the default path, except that a reset() fired
+    // from inside a block takes effect at the next tile instead of the next block.
+    // Has no effect with the polyphase front end, which already filters while resampling.
+    void set_fused_pipeline_enabled(bool enabled) { m_use_fused_pipeline = enabled; }
+
+    // Idle-channel tone gate. While searching for a VIS header, a duty-cycled
+    // Goertzel bank (dsp::ToneGate) watches for leader-tone energy around
+    // 1900 Hz, and until it finds some the bandpass, FM discriminator and
+    // VIS state machine are skipped. Skipped samples are kept in a look-back
+    // ring (GATE_LOOKBACK_SAMPLES) and replayed through the full path when the
+    // gate opens, so the preamble is not lost. The gate closes again after
+    // GATE_HOLD_MS without tone energy while the VIS decoder is idle. Resampling
+    // still runs on every sample. Off by default.
+    void set_tone_gate_enabled(bool enabled);
+    [[nodiscard]] bool tone_gate_enabled() const { return m_tone_gate_enabled; }
+
+    // Select the VIS header detector. FM (default) averages the per-sample
+    // discriminator output; GOERTZEL correlates the bandpassed audio against
+    // the VIS tones in blocks (see GoertzelVISDecoder), which holds up better
+    // at low SNR and skips the FM discriminator entirely while searching. On
+    // detection the discriminator is warmed up on the samples just before the
+    // stop bit and the image data is handed over in the same block. Switching
+    // restarts the VIS search.
+    void set_vis_engine(VISEngine engine);
+    [[nodiscard]] VISEngine vis_engine() const { return m_vis_engine; }
+
+    // Decode into a decoder-owned, contiguous row-major frame buffer. The
+    // storage is allocated once, sized for the largest supported mode, and is
+    // never reallocated (disabling stops writing but keeps it), so views of
+    // frame() stay valid for the decoder's lifetime. It is cleared whenever a
+    // new mode is detected.
+    void set_frame_buffer_enabled(bool enabled);
+    [[nodiscard]] bool frame_buffer_enabled() const { return m_frame_buffer_enabled; }
+
+    // The current (or last) image: frame_height() rows of frame_width() pixels.
+    // Empty until the frame buffer is enabled and a mode has been detected.
+    [[nodiscard]] std::span<const Pixel> frame() const {
+        return {m_frame_buffer.data(), static_cast<size_t>(m_frame_width) * m_frame_height};
+    }
+    [[nodiscard]] int frame_width() const { return m_frame_width; }
+    [[nodiscard]] int frame_height() const { return m_frame_height; }
+
+    // Decode every image into its own slot of a FrameManager with `slots`
+    // preallocated buffers. Finished frames (complete, cancelled or timed
+    // out) are queued for a consumer thread, which takes them with
+    // frame_manager()->try_acquire() / wait_acquire() without copying, while
+    // the decoder goes straight on with the next VIS search. The manager is
+    // created on the first call and keeps its slot count and storage for the
+    // decoder's lifetime; disabling only stops new images from using it.
+    // Works alongside set_frame_buffer_enabled().
+    void set_frame_manager_enabled(bool enabled, size_t slots = FrameManager::MIN_SLOTS);
+    [[nodiscard]] bool frame_manager_enabled() const { return m_frame_manager_enabled; }
+    // nullptr until set_frame_manager_enabled(true) was called
+    [[nodiscard]] FrameManager* frame_manager() { return m_frame_manager.get(); }
+
+    // Abandon the image being decoded. The partial frame is reported as
+    // FrameStatus::CANCELLED and the VIS search resumes immediately; filter,
+    // resampler and discriminator state is kept. No effect while searching.
+    // Called from a decoder callback, it takes effect at the next sample.
+    void cancel_image();
+
+    // Abandon an image as FrameStatus::TIMED_OUT once `lines` line periods pass
+    // without a valid line sync (a sync pulse that actually sits at 1200 Hz).
+    // 0 (default) never times out. Takes effect with the next image.
+    void set_image_timeout_lines(int lines) { m_image_timeout_lines = std::max(lines, 0); }
+    [[nodiscard]] int image_timeout_lines() const { return m_image_timeout_lines; }
+
+    // Monitoring counters. stats() only performs relaxed atomic loads and may be
+    // called from any thread while another thread is inside process(); the
+    // snapshot is not taken atomically as a whole. reset_stats() must not run
+    // concurrently with process(). Compiled to no-ops with SSTV_ENABLE_STATS=OFF.
+    [[nodiscard]] DecoderStats stats() const;
+    void reset_stats();
+
+    // Frequency offset (Hz) the decoder is correcting for right now: the VIS
+    // decoder's leader-tone estimate while searching (valid in the
+    // mode-detected callback), the demodulator's per-line estimate while an
+    // image is decoded. Unlike DecoderStats::afc_offset, also available with
+    // SSTV_ENABLE_STATS=OFF. Not safe to call concurrently with process().
+    [[nodiscard]] double afc_offset() const;
+
+    // Per-sample state trace (see sstv_trace.h). Only recorded when built with
+    // SSTV_ENABLE_TRACE=ON; otherwise trace() stays empty and the hooks compile
+    // away. The ring survives reset(), so after a failed decode it still holds
+    // the samples that led up to the failure. Not safe to read concurrently
+    // with process().
+    [[nodiscard]] const TraceBuffer& trace() const { return m_trace; }
+    void clear_trace() { m_trace.clear(); }
+    // Write the retained records as CSV, oldest first
+    void dump_trace(std::ostream& out) const;
+
     // Callbacks for UI or storage
     void set_on_mode_detected_callback(ModeDetectedCallback cb) { m_on_mode_detected_cb = std::move(cb); }
     void set_on_line_decoded_callback(LineDecodedCallback cb) { m_on_line_decoded_cb = std::move(cb); }
     void set_on_image_complete_callback(ImageCompleteCallback cb) { m_on_image_complete_cb = std::move(cb); }
+    // Fired after a row of frame() was written (frame buffer mode only)
+    void set_on_line_ready_callback(LineReadyCallback cb) { m_on_line_ready_cb = std::move(cb); }
+    // Fired when an image ends for any reason, after the image-complete callback
+    // and after the frame (if any) was queued in the frame manager
+    void set_on_image_finished_callback(ImageFinishedCallback cb) { m_on_image_finished_cb = std::move(cb); }
 
 private:
     enum class State {
@@ -51,22 +275,154 @@ private:
     std::unique_ptr<dsp::FIRFilter> m_bandpass_filter;
     std::unique_ptr<dsp::FrequencyEstimator> m_freq_estimator;
     std::unique_ptr<dsp::Resampler> m_resampler;
+    std::unique_ptr<dsp::PolyphaseResampler> m_polyphase_resampler; // Replaces m_resampler + m_bandpass_filter
+
+    // Tile-fused front end over the same filter/estimator instances
+    using FusedFrontEnd = dsp::FusedFrontEnd<dsp::FIRFilter, dsp::FrequencyEstimator>;
+    std::unique_ptr<FusedFrontEnd> m_fused_front_end;
+    bool m_use_fused_pipeline = false;
+
+    // Idle-channel tone gate (see set_tone_gate_enabled)
+    static constexpr size_t GATE_LOOKBACK_SAMPLES = 4096; // ~370 ms at INTERNAL_SAMPLE_RATE
+    static constexpr double GATE_HOLD_MS = 500.0;
+    std::unique_ptr<dsp::ToneGate> m_tone_gate;
+    bool m_tone_gate_enabled = false;
+    bool m_gate_open = true;
+    size_t m_gate_idle_samples = 0;     // Open: samples since the last tone / VIS activity
+    size_t m_gate_skipped = 0;          // Closed: samples skipped since the gate closed
+    std::vector<float> m_gate_lookback; // Ring of the most recent skipped samples
+    size_t m_gate_lookback_pos = 0;
+    std::vector<float> m_gate_replay;   // Look-back + current block, handed to the full path
+
+    // Block-rate VIS engine (see set_vis_engine), created on first use.
+    // stats() reads it through m_goertzel_vis_stats, published with release
+    // once the engine is fully built
+    VISEngine m_vis_engine = VISEngine::FM;
+    std::unique_ptr<GoertzelVISDecoder> m_goertzel_vis;
+    std::atomic<const GoertzelVISDecoder*> m_goertzel_vis_stats{nullptr};
+
+    // Reusable per-call scratch buffers (grown to the largest chunk seen, never shrunk)
+    std::vector<float> m_resampled_buffer;
+    std::vector<float> m_filtered_buffer;
+    std::vector<FreqSample> m_frequency_buffer;
+
+    template <typename T>
+    static void grow_scratch(std::vector<T>& buffer, size_t size) {
+        if (buffer.size() < size) buffer.resize(size);
+    }
 
     // Protocol Components
     std::unique_ptr<VISDecoder> m_vis_decoder;
-    std::unique_ptr<PDDemodulator> m_pd_demodulator;
+    // One demodulator per family (see sstv_demodulator.h), created from the
+    // registered factory the first time that family is detected. Each one is
+    // also published to m_demodulator_stats (release) so stats() can read it
+    // from another thread while process() is creating the next
+    std::array<std::unique_ptr<ImageDemodulator>, FAMILY_COUNT> m_demodulators;
+    std::array<std::atomic<const ImageDemodulator*>, FAMILY_COUNT> m_demodulator_stats{};
+    ImageDemodulator* m_demodulator = nullptr;  // Active while decoding image data
+    SyncMode m_sync_mode = SyncMode::THRESHOLD;
+    ImageDemodulator* demodulator_for(SSTVFamily family);
 
     // Current Mode detected by VIS
     SSTVMode m_current_mode;
 
+    // Optional whole-image output (see set_frame_buffer_enabled)
+    std::vector<Pixel> m_frame_buffer;
+    bool m_frame_buffer_enabled = false;
+    int m_frame_width = 0;
+    int m_frame_height = 0;
+
+    FreqTrackWriter* m_track_writer = nullptr;
+    ImageWriter* m_image_writer = nullptr;
+
+    // Multi-frame output and image lifecycle (see set_frame_manager_enabled / cancel_image)
+    std::unique_ptr<FrameManager> m_frame_manager;
+    bool m_frame_manager_enabled = false;
+    FrameInfo m_frame_info;             // The image in progress (or the last one)
+    uint64_t m_images_started = 0;
+    int m_image_timeout_lines = 0;
+    double m_image_timeout_samples = 0.0;
+    bool m_in_process = false;
+    bool m_cancel_requested = false;
+
+    // Decoder-level counters; VIS/PD counters live in their components
+    struct Counters {
+        StatCounter samples_processed;
+        StatCounter gated_samples;
+        StatCounter gate_openings;
+        StatCounter resampler_ns;
+        StatCounter bandpass_ns;
+        StatCounter estimator_ns;
+        StatCounter state_machine_ns;
+        StatCounter fused_front_end_ns;
+        StatCounter lines_emitted;
+        StatCounter images_completed;
+        StatCounter images_cancelled;
+        StatCounter images_timed_out;
+        StatGauge afc_offset;
+    };
+    Counters m_stats;
+
+    // Shared by the VIS decoder and the PD demodulator; ticked once per state-machine sample
+    TraceBuffer m_trace;
+
     // Callback handlers
     ModeDetectedCallback m_on_mode_detected_cb;
     LineDecodedCallback m_on_line_decoded_cb;
     ImageCompleteCallback m_on_image_complete_cb;
+    LineReadyCallback m_on_line_ready_cb;
+    ImageFinishedCallback m_on_image_finished_cb;
+
+    // Processing mode (see set_processing_mode)
+    ProcessingMode m_processing_mode = ProcessingMode::BALANCED;
+    size_t m_tile_samples = 0;          // Input samples per tile (LOW_LATENCY / THROUGHPUT)
+    std::vector<float> m_staging;       // THROUGHPUT: start of the next tile
+    struct DeferredLine {
+        int line_index;
+        bool ready;                     // Fire the line-ready callback
+        size_t offset;                  // Into m_deferred_pixels
+        size_t count;
+    };
+    bool m_defer_lines = false;
+    std::vector<DeferredLine> m_deferred_lines;
+    std::vector<Pixel> m_deferred_pixels;
+
+    // Split / regroup the caller's block according to m_processing_mode
+    void process_tiles(std::span<const float> input);
+    // One THROUGHPUT tile, with line callbacks deferred to its end
+    void process_tile(std::span<const float> tile);
+    void process_staged();
+    void flush_deferred_lines();
+
+    // Resample / filter / discriminate one input block and run the state machine
+    void process_block(std::span<const float> input);
+    // Bandpass (unless the resampler already did) -> discriminator -> state machine
+    void run_front_end(std::span<const float> input, bool prefiltered);
+    // Tone gate: returns false if the block was skipped, otherwise the span to decode
+    // (possibly extended with replayed look-back samples)
+    bool gate_admits(std::span<const float>& input);
+    void reset_gate();
+    // Goertzel VIS search on bandpassed samples; on detection hands the rest to the state machine
+    void search_goertzel_vis(std::span<const float> filtered);
+    // Offset / activity of whichever VIS engine is selected
+    [[nodiscard]] double vis_afc_offset() const;
+    [[nodiscard]] bool vis_idle() const;
+
+    // Per-sample protocol state machine (VIS search / image demodulation)
+    void run_state_machine(const float* samples, const FreqSample* frequencies, size_t count);
+
+    // Back to VIS search without clearing the filters, resampler or discriminator
+    void restart_search();
+    // Claim frame storage and arm the timeout for a newly detected image
+    void begin_image();
+    // Report the image in progress (frame manager + image-finished callback)
+    void finish_image(FrameStatus status);
+    // Cancel / time out the image in progress and restart the search
+    void abandon_image(FrameStatus status);
 
     // Internal callback wrappers to handle mode state changes
     void handle_mode_detected(const SSTVMode& mode);
-    void handle_line_decoded(int line_idx, const std::vector<Pixel>& pixels);
+    void handle_line_decoded(int line_idx, std::span<const Pixel> pixels);
     void handle_image_complete(int width, int height);
 };
 
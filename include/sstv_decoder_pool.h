@@ -0,0 +1,131 @@
+#pragma once
+
+#include "sstv_decoder.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sstv {
+
+// Runs many independent Decoder pipelines on a fixed pool of worker threads.
+//
+// Each channel owns its own Resampler -> FIRFilter -> FrequencyEstimator ->
+// VISDecoder/PDDemodulator chain. Submitted blocks are queued per channel and
+// always processed in submission order; a channel is never processed by two
+// workers at the same time, so callbacks of one channel are never concurrent.
+// Idle workers steal scheduled channels from busy workers' queues.
+class DecoderPool {
+public:
+    // worker_count == 0 uses std::thread::hardware_concurrency()
+    DecoderPool(size_t channel_count, double sample_rate, size_t worker_count = 0);
+    // Decodes every block submitted so far (see wait_idle()) before stopping
+    // the workers. Must not race submit() or reset_channel().
+    ~DecoderPool();
+
+    DecoderPool(const DecoderPool&) = delete;
+    DecoderPool& operator=(const DecoderPool&) = delete;
+
+    // Queue a block of samples for a channel. The samples are copied, so the
+    // caller may reuse its buffer immediately. Safe to call from any thread.
+    void submit(size_t channel, const float* samples, size_t count);
+
+    // Block until every submitted sample has been processed. An exception
+    // thrown by a callback (or a queued command) does not stop the worker:
+    // the item counts as done, decoding goes on, and the first such exception
+    // is rethrown here.
+    void wait_idle();
+
+    // Reset a single channel. The reset is queued behind the channel's pending
+    // blocks and runs on its worker; returns once it has been applied. Must
+    // not be called from a callback.
+    void reset_channel(size_t channel);
+
+    // Monitoring counters of one channel's decoder; safe to call while workers
+    // are decoding (see Decoder::stats())
+    [[nodiscard]] DecoderStats channel_stats(size_t channel) const;
+
+    [[nodiscard]] size_t channel_count() const { return m_channels.size(); }
+    [[nodiscard]] size_t worker_count() const { return m_workers.size(); }
+
+    // Idle-channel tone gate on every channel (see Decoder::set_tone_gate_enabled),
+    // queued and applied like set_sync_mode()
+    void set_tone_gate_enabled(bool enabled);
+    // VIS engine on every channel (see Decoder::set_vis_engine), queued and
+    // applied like set_sync_mode()
+    void set_vis_engine(VISEngine engine);
+    // PD line-sync mode on every channel (see Decoder::set_sync_mode). Queued
+    // behind each channel's pending blocks and applied between two of them;
+    // returns without waiting
+    void set_sync_mode(SyncMode mode);
+    // Image timeout on every channel (see Decoder::set_image_timeout_lines),
+    // queued and applied like set_sync_mode()
+    void set_image_timeout_lines(int lines);
+
+    // Callbacks run on worker threads. Install them before submitting samples.
+    void set_on_mode_detected_callback(ChannelModeDetectedCallback cb);
+    void set_on_line_decoded_callback(ChannelLineDecodedCallback cb);
+    void set_on_image_complete_callback(ChannelImageCompleteCallback cb);
+
+private:
+    // A block of samples, or a command run on the channel's decoder in its place
+    struct Item {
+        std::vector<float> samples;
+        std::function<void(Decoder&)> command;
+    };
+
+    struct Channel {
+        std::unique_ptr<Decoder> decoder;
+        std::mutex mutex;
+        std::deque<Item> pending;                // Items waiting to run, in submission order
+        std::vector<std::vector<float>> spare;   // Recycled block buffers
+        bool scheduled = false;                  // Queued on a worker or running
+        uint64_t commands_queued = 0;
+        uint64_t commands_done = 0;              // reset_channel() waits on this
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> tasks;  // Channel indices; owner pops front, thieves pop back
+        std::thread thread;
+    };
+
+    void worker_loop(size_t worker_idx);
+    bool pop_task(size_t worker_idx, size_t& channel_idx);
+    void push_task(size_t worker_idx, size_t channel_idx);
+    void run_channel(size_t worker_idx, size_t channel_idx);
+    // Queue a command behind the channel's pending items; returns its ticket (see commands_done)
+    uint64_t submit_command(size_t channel_idx, std::function<void(Decoder&)> command);
+
+    std::vector<std::unique_ptr<Channel>> m_channels;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Worker wake-up
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_cv;
+    size_t m_queued_tasks = 0;
+    bool m_stopping = false;
+
+    // wait_idle() support
+    std::mutex m_idle_mutex;
+    std::condition_variable m_idle_cv;
+    std::atomic<size_t> m_pending_items{0};  // Blocks and commands not yet run
+    std::exception_ptr m_error;              // First exception raised on a worker (guarded by m_idle_mutex)
+
+    ChannelModeDetectedCallback m_on_mode_detected_cb;
+    ChannelLineDecodedCallback m_on_line_decoded_cb;
+    ChannelImageCompleteCallback m_on_image_complete_cb;
+
+    // Upper bound on items a worker runs per channel before yielding it
+    static constexpr size_t BLOCKS_PER_TASK = 8;
+};
+
+} // namespace sstv
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "sstv_types.h"
+#include "sstv_stats.h"
+#include "sstv_trace.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace sstv {
+
+// How line syncs are located (families that support both)
+enum class SyncMode {
+    THRESHOLD,   // Per-sample envelope threshold (default)
+    CORRELATION  // Template correlation over candidate positions around the predicted sync; one sync period of latency
+};
+
+// Image-data demodulator of one SSTV family. The Decoder drives the active
+// one from the end of the VIS header to the end of the image.
+//
+// The hot loop makes a single virtual call per block: process_block() runs
+// its own per-sample loop and only returns at points where the Decoder has
+// to look at the image lifecycle (a line emitted, the image complete, the
+// sync gap limit reached). Implementations should be `final`.
+class ImageDemodulator {
+public:
+    // Monitoring counters (see sstv_stats.h), readable from other threads
+    struct Stats {
+        StatCounter syncs_detected;  // Line syncs found
+        StatCounter sync_timeouts;   // Line syncs expected but not found
+    };
+
+    virtual ~ImageDemodulator() = default;
+
+    // Prepare for a new image of `desc`, a mode of this family. Buffers are
+    // sized for the mode here, so steady-state decoding does not allocate.
+    virtual void configure(const ModeDescriptor& desc) = 0;
+    // Drop the image in progress
+    virtual void reset() = 0;
+    // Frequency offset measured on the VIS leader (Hz)
+    virtual void set_afc_offset(double afc_offset) = 0;
+    // Optional row-major frame the rows are written into; an empty span uses an internal line buffer
+    virtual void set_frame_buffer(std::span<Pixel> frame) = 0;
+    virtual void set_sync_mode(SyncMode mode) = 0;
+    // nullptr disables; records nothing unless built with SSTV_ENABLE_TRACE
+    virtual void set_trace(TraceBuffer* trace) = 0;
+
+    // Consume bandpassed samples and their instantaneous frequencies (equal
+    // lengths). Returns after the sample that emitted a line or completed the
+    // image, or once samples_since_sync() reaches sync_gap_limit (> 0).
+    // Returns the number of samples consumed, at least 1 for non-empty input.
+    virtual size_t process_block(std::span<const float> samples, std::span<const FreqSample> freqs,
+                                 double sync_gap_limit = 0.0) = 0;
+
+    // Frequency offset currently tracked (Hz)
+    [[nodiscard]] virtual double get_afc_offset() const = 0;
+    [[nodiscard]] virtual int lines_decoded() const = 0;
+    // Samples since the last line sync that passed validation
+    [[nodiscard]] virtual double samples_since_sync() const = 0;
+    // Average samples per image line of the configured mode
+    [[nodiscard]] virtual double line_samples() const = 0;
+
+    [[nodiscard]] virtual const Stats& stats() const = 0;
+    virtual void reset_stats() = 0;
+};
+
+// Creates a family's demodulator at the given sample rate, reporting through the callbacks
+using DemodulatorFactory = std::unique_ptr<ImageDemodulator> (*)(double sample_rate,
+                                                                 LineDecodedCallback on_line_decoded,
+                                                                 ImageCompleteCallback on_image_complete);
+
+// Number of real families (SSTVFamily::UNKNOWN excluded)
+inline constexpr size_t FAMILY_COUNT = static_cast<size_t>(SSTVFamily::UNKNOWN);
+
+// Factory registered for `family`, or nullptr if the family has no demodulator.
+// The table lives in sstv_demodulator.cpp: a new family adds its entry there.
+[[nodiscard]] DemodulatorFactory find_demodulator_factory(SSTVFamily family);
+
+} // namespace sstv
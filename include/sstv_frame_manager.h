@@ -0,0 +1,126 @@
+#pragma once
+
+#include "sstv_types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace sstv {
+
+// How a frame ended
+enum class FrameStatus {
+    COMPLETE,   // Every line was decoded
+    CANCELLED,  // Decoder::cancel_image()
+    TIMED_OUT   // No valid line sync for the configured number of lines
+};
+
+struct FrameInfo {
+    SSTVMode mode;
+    int width = 0;
+    int height = 0;
+    int lines_decoded = 0;     // Rows [0, lines_decoded) hold image data, the rest are black
+    FrameStatus status = FrameStatus::COMPLETE;
+    uint64_t sequence = 0;     // Per-decoder image counter, in the order images were started
+};
+
+// Fired on the decoder thread whenever an image ends, however it ended
+using ImageFinishedCallback = std::function<void(const FrameInfo& info)>;
+
+// Fixed pool of preallocated image buffers shared between one decoder thread
+// (the producer) and any number of consumer threads.
+//
+// The decoder writes rows straight into the active slot. A finished frame is
+// moved to the ready queue as is, and a consumer takes it with try_acquire() /
+// wait_acquire(). The Frame handle owns the slot until release() or
+// destruction, so the pixels are never copied and never overwritten while
+// held. All slots are allocated in the constructor.
+//
+// If no slot is free when a new image starts, the oldest frame nobody has
+// acquired yet is recycled. If every slot is held by a consumer, the image
+// is decoded without frame storage. Both cases count as dropped_frames().
+class FrameManager {
+public:
+    static constexpr size_t MIN_SLOTS = 2;
+
+    // Move-only handle to a finished frame. Must not outlive its manager.
+    class Frame {
+    public:
+        Frame() = default;
+        Frame(Frame&& other) noexcept { *this = std::move(other); }
+        Frame& operator=(Frame&& other) noexcept;
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+        ~Frame() { release(); }
+
+        [[nodiscard]] explicit operator bool() const { return m_manager != nullptr; }
+        // Row-major, info().height rows of info().width pixels
+        [[nodiscard]] std::span<const Pixel> pixels() const { return m_pixels; }
+        [[nodiscard]] const FrameInfo& info() const { return m_info; }
+
+        // Hand the slot back to the decoder; the handle becomes empty
+        void release();
+
+    private:
+        friend class FrameManager;
+        Frame(FrameManager* manager, size_t slot, std::span<const Pixel> pixels, const FrameInfo& info)
+            : m_manager(manager), m_slot(slot), m_pixels(pixels), m_info(info) {}
+
+        FrameManager* m_manager = nullptr;
+        size_t m_slot = 0;
+        std::span<const Pixel> m_pixels;
+        FrameInfo m_info;
+    };
+
+    explicit FrameManager(size_t slot_count = MIN_SLOTS, size_t slot_pixels = MAX_MODE_PIXELS);
+
+    FrameManager(const FrameManager&) = delete;
+    FrameManager& operator=(const FrameManager&) = delete;
+
+    // Producer: claim a cleared slot for a new info.width x info.height image.
+    // Returns an empty span (and counts a dropped frame) if no slot can be
+    // claimed or the image does not fit. Any frame still active is discarded first.
+    std::span<Pixel> begin_frame(const FrameInfo& info);
+    // Producer: move the active frame to the ready queue
+    void publish_frame(int lines_decoded, FrameStatus status);
+    // Producer: return the active slot without publishing it
+    void discard_frame();
+    [[nodiscard]] bool frame_active() const { return m_active != NO_SLOT; }
+
+    // Consumer: oldest ready frame, or an empty handle
+    [[nodiscard]] Frame try_acquire();
+    // Consumer: as try_acquire(), waiting up to `timeout` for a frame
+    [[nodiscard]] Frame wait_acquire(std::chrono::milliseconds timeout);
+
+    [[nodiscard]] size_t slot_count() const { return m_slots.size(); }
+    [[nodiscard]] size_t ready_count() const;
+    [[nodiscard]] uint64_t dropped_frames() const;
+
+private:
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    struct Slot {
+        std::vector<Pixel> pixels;
+        FrameInfo info;
+    };
+
+    Frame take_ready();  // m_mutex held, m_ready not empty
+    void release_slot(size_t slot);
+
+    std::vector<Slot> m_slots;
+    size_t m_active = NO_SLOT;  // Producer-owned
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready_cv;
+    std::vector<size_t> m_free;
+    std::vector<size_t> m_ready;  // FIFO, oldest first (at most slot_count entries)
+    uint64_t m_dropped = 0;
+};
+
+} // namespace sstv
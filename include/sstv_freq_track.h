@@ -0,0 +1,134 @@
+#pragma once
+
+#include "sstv_audio_file.h"
+#include "sstv_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sstv {
+
+// Storage of the samples in a frequency-track file
+enum class TrackEncoding : uint32_t {
+    FLOAT32 = 0,  // float frequency (Hz) and filtered sample: exact in SSTV_FLOAT32_PIPELINE builds, float-rounded otherwise
+    INT16 = 1     // Half the size: frequency in FREQ_STEP_HZ steps, sample scaled per chunk
+};
+
+// Frequency-track cache: the decoder's post-FrequencyEstimator stream (the
+// bandpassed sample plus its instantaneous frequency), saved so that the VIS
+// and PD state machines can be re-run on a recording without repeating
+// resampling, FIR filtering and FM discrimination.
+//
+// File layout (little endian, every field naturally aligned so the file can
+// be used straight from a memory mapping):
+//   header  "SSTVFTRK", u32 version, u32 encoding, f64 sample_rate,
+//           u32 chunk_samples, u32 reserved                       (32 bytes)
+//   chunks  u32 magic "CHNK", u32 count, f32 sample_scale, u32 reserved,
+//           count frequencies, then count samples                  (planar)
+// FLOAT32 chunks store both arrays as float. INT16 chunks store the
+// frequency as round(freq / FREQ_STEP_HZ) and the sample as
+// round(sample / sample_scale), with sample_scale = chunk peak / 32767.
+// Either way a payload is a multiple of 4 bytes (8 or 4 per sample), so
+// every chunk header and float array is 4-byte aligned. An INT16 sample
+// array starts 2 * count bytes in, which for an odd count is only 2-byte
+// aligned, as int16 needs. The last chunk may be shorter than chunk_samples.
+namespace track_format {
+    inline constexpr char MAGIC[8] = {'S', 'S', 'T', 'V', 'F', 'T', 'R', 'K'};
+    inline constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;  // "CHNK"
+    inline constexpr uint32_t VERSION = 1;
+    inline constexpr size_t HEADER_BYTES = 32;
+    inline constexpr size_t CHUNK_HEADER_BYTES = 16;
+    // +-8191.75 Hz, which covers the discriminator output range at 11025 Hz
+    inline constexpr float FREQ_STEP_HZ = 0.25f;
+}
+
+class FreqTrackWriter {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SAMPLES = 65536;  // ~6 s at 11025 Hz
+
+    // Throws std::runtime_error if the file cannot be created
+    FreqTrackWriter(const std::string& path, double sample_rate,
+                    TrackEncoding encoding = TrackEncoding::FLOAT32,
+                    size_t chunk_samples = DEFAULT_CHUNK_SAMPLES);
+    // Writes the pending partial chunk; errors at this point are swallowed, call close() to see them
+    ~FreqTrackWriter();
+
+    FreqTrackWriter(const FreqTrackWriter&) = delete;
+    FreqTrackWriter& operator=(const FreqTrackWriter&) = delete;
+
+    // `filtered` and `frequencies` must have the same length
+    void append(std::span<const float> filtered, std::span<const FreqSample> frequencies);
+    // Write the pending partial chunk and close the file. Further appends throw.
+    void close();
+
+    [[nodiscard]] TrackEncoding encoding() const { return m_encoding; }
+    [[nodiscard]] uint64_t samples_written() const { return m_samples_written; }
+
+private:
+    void write_chunk();
+
+    std::ofstream m_stream;
+    TrackEncoding m_encoding;
+    size_t m_chunk_samples;
+    uint64_t m_samples_written = 0;
+
+    // Samples of the chunk being filled
+    std::vector<float> m_samples;
+    std::vector<float> m_frequencies;
+    std::vector<uint8_t> m_encoded;
+};
+
+// Sequential reader for frequency-track files.
+//
+// The file is memory-mapped and validated chunk by chunk when opened.
+// FLOAT32 chunks are returned straight from the mapped pages (float pipeline
+// builds) or converted into a reused buffer; INT16 chunks are always decoded
+// into the reused buffers.
+class FreqTrackReader {
+public:
+    struct Chunk {
+        std::span<const float> samples;
+        std::span<const FreqSample> frequencies;
+        [[nodiscard]] bool empty() const { return samples.empty(); }
+        [[nodiscard]] size_t size() const { return samples.size(); }
+    };
+
+    // Throws std::runtime_error if the file is missing, truncated or not a track file
+    explicit FreqTrackReader(const std::string& path);
+
+    // Cheap check of the file header, for callers that accept audio and tracks alike
+    [[nodiscard]] static bool is_track_file(const std::string& path);
+
+    // Next chunk, empty at end of file. The spans stay valid until the next call.
+    Chunk next_chunk();
+    void rewind() { m_next_chunk = 0; }
+
+    [[nodiscard]] double sample_rate() const { return m_sample_rate; }
+    [[nodiscard]] TrackEncoding encoding() const { return m_encoding; }
+    [[nodiscard]] size_t chunk_count() const { return m_chunks.size(); }
+    [[nodiscard]] uint64_t sample_count() const { return m_sample_count; }
+
+private:
+    struct ChunkRef {
+        size_t offset;  // Of the frequency array
+        size_t count;
+        float sample_scale;
+    };
+
+    MappedFile m_file;
+    TrackEncoding m_encoding = TrackEncoding::FLOAT32;
+    double m_sample_rate = 0.0;
+    uint64_t m_sample_count = 0;
+    std::vector<ChunkRef> m_chunks;
+    size_t m_next_chunk = 0;
+
+    std::vector<float> m_samples;
+    std::vector<FreqSample> m_frequencies;
+};
+
+} // namespace sstv
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "sstv_frame_manager.h"
+#include "sstv_spsc_ring.h"
+#include "sstv_types.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sstv {
+
+enum class ImageFormat {
+    RAW,  // Headerless row-major RGB24, written through a memory-mapped file
+    PNG   // 8-bit RGB PNG, filtered and deflated row by row (see PngEncoder)
+};
+
+// Fired on the writer thread once an image file is complete and in place
+using ImageWrittenCallback = std::function<void(const std::string& path, const FrameInfo& info)>;
+
+// Asynchronous image output stage.
+//
+// The decoder thread hands over image lifecycle events and decoded rows
+// (begin_image / write_line / end_image, normally through
+// Decoder::set_image_writer). Each call only copies the row into a
+// preallocated slot and passes the slot index through a wait-free SPSC ring:
+// it never allocates, throws or touches the file system, and by default never
+// blocks. A background
+// thread takes the rows in order and streams them into the output file, so
+// encoding never stalls demodulation, and the file is finished as soon as the
+// image's last row has been encoded.
+//
+// Every image is written under `path + ".part"` and renamed into place when
+// it ends, so a file at the final path is always complete. Rows that never
+// arrived (lost sync, cancelled or timed-out images) are left black. If the
+// writer thread falls behind by more than the queue, rows that do not fit are
+// dropped (lines_dropped()) and an image that starts with no room at all is
+// not written (images_dropped()), unless set_wait_when_full() is on.
+class ImageWriter {
+public:
+    static constexpr size_t DEFAULT_QUEUE_LINES = 1024;  // Two PD240 images
+
+    // `path` may contain "{}", replaced by the image's FrameInfo::sequence;
+    // without it every image overwrites the same file
+    ImageWriter(std::string path, ImageFormat format, size_t queue_lines = DEFAULT_QUEUE_LINES);
+    // Writes out everything queued (an image still open is finished as is), then joins the thread
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    // PNG for a ".png" extension (any case), RAW otherwise
+    [[nodiscard]] static ImageFormat format_for_path(const std::string& path);
+    [[nodiscard]] std::string path_for(uint64_t sequence) const;
+    [[nodiscard]] ImageFormat format() const { return m_format; }
+
+    // Producer thread only (one thread, normally the decoder's).
+    // begin_image() discards an image that was never ended.
+    void begin_image(const FrameInfo& info) noexcept;
+    void write_line(int line_index, std::span<const Pixel> pixels) noexcept;
+    // `info` carries the final lines_decoded / status, passed on to the callback
+    void end_image(const FrameInfo& info) noexcept;
+    // Drop the open image and its partial file
+    void discard_image() noexcept;
+
+    // Block until every event queued so far has been written. Rethrows the
+    // first error the writer thread hit since the last flush() (the image it
+    // occurred in is abandoned; later images are still written). Must not be
+    // called from the image-written callback.
+    void flush();
+
+    // For input that is not real time (decoding a file): when the queue is
+    // full, the producer waits for the writer thread instead of dropping rows.
+    // Producer thread only.
+    void set_wait_when_full(bool wait) { m_wait_when_full = wait; }
+    [[nodiscard]] bool wait_when_full() const { return m_wait_when_full; }
+
+    // Set before the first image; runs on the writer thread
+    void set_on_image_written_callback(ImageWrittenCallback cb) { m_on_image_written_cb = std::move(cb); }
+
+    [[nodiscard]] uint64_t images_written() const { return m_images_written.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t images_dropped() const { return m_images_dropped.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t lines_dropped() const { return m_lines_dropped.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t queued_events() const { return m_queue.size(); }
+
+private:
+    enum class EventKind : uint8_t { BEGIN, LINE, END, DISCARD };
+
+    struct Event {
+        EventKind kind = EventKind::LINE;
+        int line_index = 0;
+        size_t pixel_count = 0;
+        FrameInfo info;
+        std::vector<Pixel> pixels;  // MAX_MODE_WIDTH, allocated once
+    };
+
+    class Output;  // The file being written (writer thread only)
+
+    bool acquire_slot(uint32_t& slot) noexcept;
+    void post(uint32_t slot) noexcept;
+    void run();
+    void handle(Event& event);
+    void finish_output();
+    void abandon_output() noexcept;
+
+    std::string m_path;
+    ImageFormat m_format;
+
+    std::vector<Event> m_events;
+    SpscRing<uint32_t> m_queue;  // Producer -> writer thread
+    SpscRing<uint32_t> m_free;   // Writer thread -> producer
+
+    // Producer-owned
+    uint32_t m_reserve = 0;      // Slot kept back so an open image can always be ended
+    bool m_has_reserve = false;
+    bool m_image_open = false;
+    bool m_wait_when_full = false;
+
+    // Counters: m_posted / lines / images dropped are written by the producer only
+    std::atomic<uint64_t> m_posted{0};
+    std::atomic<uint64_t> m_handled{0};
+    std::atomic<uint64_t> m_wake{0};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint64_t> m_images_written{0};
+    std::atomic<uint64_t> m_images_dropped{0};
+    std::atomic<uint64_t> m_lines_dropped{0};
+
+    // Writer thread
+    std::unique_ptr<Output> m_output;
+    FrameInfo m_output_info;
+    ImageWrittenCallback m_on_image_written_cb;
+
+    std::mutex m_error_mutex;
+    std::exception_ptr m_error;
+
+    std::thread m_thread;  // Last: started once everything above exists
+};
+
+} // namespace sstv
@@ -1,17 +1,43 @@
 // include/sstv_pd_demodulator.h
 #pragma once
 
-#include "sstv_types.h"
-#include "dsp_filters.h"
+#include "sstv_demodulator.h"
+#include "dsp_biquad_bank.h"
+#include "dsp_sliding_median.h"
+#include <array>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <deque>
+#include <span>
 #include <cmath>
 
 namespace sstv {
 
-class PDDemodulator {
+// PD 家族的图像解调器（在 sstv_demodulator.cpp 中注册为 SSTVFamily::PD 的工厂）
+// 行同步定位方式（SyncMode）：
+// THRESHOLD   逐样本门限：1200Hz 包络越过自适应门限即判为同步（默认）
+// CORRELATION 多候选：缓存一个行组的频率样本，在预测位置附近对同步 + 后沿模板做相关，延迟一个行组输出
+class PDDemodulator final : public ImageDemodulator {
 public:
+    enum class SegmentType {
+        IDLE,       // 等待同步信号
+        SYNC,       // 1200Hz 同步脉冲 (20ms)
+        PORCH,      // 1500Hz 黑色后沿 (2.08ms)
+        Y1,         // 第 N 行亮度 (121.6ms)
+        RY,         // 第 N & N+1 行红色差 Cr (121.6ms)
+        BY,         // 第 N & N+1 行蓝色差 Cb (121.6ms)
+        Y2          // 第 N+1 行亮度 (121.6ms)
+    };
+    static constexpr size_t SEGMENT_COUNT = static_cast<size_t>(SegmentType::Y2) + 1;
+    static constexpr std::string_view segment_name(SegmentType segment) {
+        constexpr std::array<std::string_view, SEGMENT_COUNT> names = {"IDLE", "SYNC", "PORCH", "Y1", "RY", "BY", "Y2"};
+        return names[static_cast<size_t>(segment)];
+    }
+
+    // 监控计数器（见 ImageDemodulator::Stats）
+    // syncs_detected：IDLE -> SYNC（每个行组一次）；sync_timeouts：同步段超时仍未检测到 1200 -> 1500 跳变沿
+    using Stats = ImageDemodulator::Stats;
+
     /**
      * @brief 构造函数
      * @param sample_rate 音频输入采样率
@@ -28,6 +54,7 @@ public:
      * @param timings 定时信息
      */
     void configure(const SSTVMode& mode, const PDTimings& timings);
+    void configure(const ModeDescriptor& desc) override { configure(desc.mode, desc.pd_timings); }
 
     /**
      * @brief 处理从频率估计器得到的频率流
@@ -35,42 +62,104 @@ public:
      * @param freq 原始频率 (Hz)
      * @return 如果图像传输完成返回 true
      */
-    bool process(float sample, double freq);
+    bool process(float sample, FreqSample freq);
+
+    /**
+     * @brief 块处理：1200/1500Hz 包络按 ENVELOPE_BLOCK 个样本一块向量化计算，再逐样本推进状态机
+     * 每输出一行（含图像完成）后立即返回，回调中请求的操作因此仍在下一个样本生效；
+     * sync_gap_limit > 0 时，samples_since_sync() 达到该值后也立即返回。结果与逐样本调用 process 完全一致
+     * @param samples 原始样点
+     * @param freqs 原始频率 (Hz)，与 samples 等长
+     * @return 实际消耗的样本数（输入非空时至少为 1）
+     */
+    size_t process_block(std::span<const float> samples, std::span<const FreqSample> freqs,
+                         double sync_gap_limit = 0.0) override;
 
     /**
      * @brief 重置解调器状态，准备接收新的一帧
      */
-    void reset();
+    void reset() override;
 
     /**
      * @brief 设置初始频率偏移（从 VIS 解码器传递的 AFC 偏移）
      * @param afc_offset 频率偏移量 (Hz)
      */
-    void set_afc_offset(double afc_offset);
+    void set_afc_offset(double afc_offset) override;
+
+    /**
+     * @brief 设置可选的整帧缓冲区（按行优先存放，行宽为当前模式宽度）
+     * 设置后每行像素直接写入 frame 中对应的行，行回调收到的 span 也指向帧内；
+     * 容量不足以容纳某一行时，该行退回使用内部行缓冲区。传入空 span 取消
+     */
+    void set_frame_buffer(std::span<Pixel> frame) override { m_frame_buffer = frame; }
+
+    /**
+     * @brief 选择行同步定位方式，下一次 configure 时生效
+     * CORRELATION 模式下每个同步脉冲的位置在预测点 ± SYNC_SEARCH_MS 内逐样本打分，取得分最高的候选；
+     * 得分过低时按跟踪的行组周期外推。行组 N 的各段按同步 N 与 N+1 的实测间隔等比例划分，
+     * 因此采样率偏差造成的倾斜在解调时直接得到校正
+     */
+    void set_sync_mode(SyncMode mode) override { m_sync_mode = mode; }
+    [[nodiscard]] SyncMode sync_mode() const { return m_sync_mode; }
+
+    // 当前（行同步跟踪后的）频偏 (Hz)
+    [[nodiscard]] double get_afc_offset() const override { return m_afc_offset; }
+
+    // 已输出的行数
+    [[nodiscard]] int lines_decoded() const override { return m_current_line_idx; }
+    // 距上一个有效同步脉冲（AFC 窗口内过半样本落在 1200Hz ± FREQ_TOLERANCE）的采样数，用于判断失锁
+    [[nodiscard]] double samples_since_sync() const override { return m_samples_since_sync; }
+    // 一个行组（同步 + 后沿 + 4 段，对应 2 行）的采样数
+    [[nodiscard]] double line_group_samples() const { return m_sync_samples + m_porch_samples + 4.0 * m_segment_samples; }
+    // 每个行组对应 2 行
+    [[nodiscard]] double line_samples() const override { return line_group_samples() / 2.0; }
+
+    // 逐样本跟踪（见 sstv_trace.h），传入 nullptr 关闭；未开启 SSTV_ENABLE_TRACE 时不记录
+    void set_trace(TraceBuffer* trace) override { m_trace = trace; }
+
+    [[nodiscard]] const Stats& stats() const override { return m_stats; }
+    void reset_stats() override {
+        m_stats.syncs_detected.reset();
+        m_stats.sync_timeouts.reset();
+    }
 
 private:
-    dsp::Biquad m_iir1200;
-    dsp::Biquad m_iir1500;
-    dsp::Biquad m_lpf1200;
-    dsp::Biquad m_lpf1500;
+    // 1200Hz / 1500Hz 带通 + 包络低通，4 个 biquad 在同一组 SIMD lane 中推进
+    dsp::DualToneEnvelope m_envelope;
+    static constexpr size_t ENVELOPE_BLOCK = 64;
+    std::array<float, ENVELOPE_BLOCK> m_env12_block{};
+    std::array<float, ENVELOPE_BLOCK> m_env15_block{};
 
     float m_adaptive_threshold = 0.01f;
 
-    enum class SegmentType {
-        IDLE,       // 等待同步信号
-        SYNC,       // 1200Hz 同步脉冲 (20ms)
-        PORCH,      // 1500Hz 黑色后沿 (2.08ms)
-        Y1,         // 第 N 行亮度 (121.6ms)
-        RY,         // 第 N & N+1 行红色差 Cr (121.6ms)
-        BY,         // 第 N & N+1 行蓝色差 Cb (121.6ms)
-        Y2          // 第 N+1 行亮度 (121.6ms)
-    };
+    // 容错常量
+    static constexpr double FREQ_TOLERANCE = 60.0;
+    static constexpr size_t MEDIAN_WINDOW = 9; // 奇数
+    static constexpr double AFC_ALPHA = 0.1;
+
+    // CORRELATION 模式参数
+    static constexpr double SYNC_SEARCH_MS = 5.0;        // 后续同步的搜索半宽
+    static constexpr double FIRST_SYNC_SEARCH_MS = 40.0; // 第一个同步在 VIS 结束后的搜索范围
+    static constexpr float TEMPLATE_SPAN_HZ = 200.0f;    // 模板匹配得分从 1 线性降到 0 的频差
+    // 最高得分比背景（数据段上的平均模板得分）高出此值才算找到同步，否则视为丢失。
+    // 低信噪比下鉴频输出离散，绝对得分整体下降，用相对背景的对比度判决
+    static constexpr float SYNC_CONTRAST_THRESHOLD = 0.35f;
+    static constexpr double PERIOD_ALPHA = 0.25;         // 行组周期跟踪系数
+    static constexpr double MAX_PERIOD_ERROR = 0.02;     // 实测周期与标称值的最大相对偏差
 
     PDTimings m_timings;
+    Stats m_stats;
+    TraceBuffer* m_trace = nullptr;
+    // configure 时由 m_timings 换算出的各段采样数，process 中不再逐样本重复计算
+    double m_sync_samples = 0.0;
+    double m_porch_samples = 0.0;
+    double m_segment_samples = 0.0;
     int m_width = 0;
     int m_height = 0;
 
     SegmentType m_current_segment;
+    SyncMode m_sync_mode = SyncMode::THRESHOLD;
+    SyncMode m_active_sync_mode = SyncMode::THRESHOLD;  // configure 时锁定
     double m_sample_rate;
     double m_samples_per_ms;
 
@@ -81,33 +170,64 @@ private:
     double m_segment_timer;         // 当前段已持续的采样数
     int    m_current_line_idx;      // 当前处理到的行数 (0 - 495)
     double m_afc_offset;           // 当前检测到的频偏 (Hz)
-    std::deque<double> m_median_buffer;
+    double m_samples_since_sync = 0.0;
+    int    m_sync_hits = 0;         // 当前同步脉冲 AFC 窗口内接近 1200Hz 的样本数
+    int    m_sync_checks = 0;       // 当前同步脉冲 AFC 窗口内的样本数
+    dsp::SlidingMedian<MEDIAN_WINDOW, FreqSample> m_median_filter;
 
     // 原始频率缓冲区：存储当前段内的所有频率样本
     // 待一段结束时，再通过重采样算法提取出像素点
-    std::vector<double> m_segment_buffer;
+    std::vector<FreqSample> m_segment_buffer;
 
     // 像素缓冲区：存储重采样后的像素分量
+    // 只在 configure 时按模式宽度调整大小（容量只增不减），解码过程中原地覆盖写入
     std::vector<uint8_t> m_y1_pixels;
     std::vector<uint8_t> m_y2_pixels;
     std::vector<uint8_t> m_cr_pixels;
     std::vector<uint8_t> m_cb_pixels;
 
+    // RGB 行缓冲区（未设置整帧缓冲区时使用），以及可选的整帧缓冲区
+    static_assert(sizeof(Pixel) == 3, "Pixel must be tightly packed RGB");
+    std::vector<Pixel> m_line_pixels;
+    std::span<Pixel> m_frame_buffer;
+
+    // CORRELATION 模式状态：样本按绝对序号定位，m_track_buffer[0] 对应 m_track_start
+    std::vector<FreqSample> m_track_buffer;  // AFC 修正后的频率
+    uint64_t m_track_start = 0;
+    uint64_t m_track_total = 0;              // 本帧已接收的样本数
+    double m_next_decision = 0.0;            // 收到该序号的样本后判定下一个同步
+    double m_last_sync = 0.0;                // 上一个已确定的同步起点
+    double m_line_period = 0.0;              // 跟踪的行组周期
+    int    m_syncs_committed = 0;
+    bool   m_last_sync_hit = false;
+    std::vector<float> m_sync_score;         // 模板相关的逐样本得分前缀和
+    std::vector<float> m_porch_score;
+
     // 内部核心逻辑
     void process_current_segment();
+    // 已得到包络后的逐样本状态机
+    void step(FreqSample freq, float env12, float env15);
+    void validate_sync();
+    void track_sample(FreqSample corrected_freq);
+    void commit_sync();
+    struct SyncCandidate {
+        double position = 0.0;  // 亚样本同步起点（绝对序号）
+        float score = -1.0f;    // 最高归一化得分（-1 ~ 1）
+        float worst = -1.0f;    // 窗口内最低归一化得分
+    };
+    [[nodiscard]] SyncCandidate search_sync(double lo, double hi);
+    [[nodiscard]] float template_baseline(double begin, double end) const;
+    // 绝对样本位置在 m_track_buffer 中的下标（四舍五入并限制在缓冲区内）
+    [[nodiscard]] size_t track_offset(double position) const;
+    void decode_tracked_group(double sync_start, double next_sync);
     void finalize_line_group();
     void init_filters();
     void reserve_samples(double reserved_samples);
-    double get_smoothed_freq(double raw_freq);
+    FreqSample get_smoothed_freq(FreqSample raw_freq);
 
     // 工具函数
-    std::vector<uint8_t> resample_segment(const std::vector<double>& buffer, int target_count);
-    Pixel ycbcr_to_rgb(uint8_t Y, uint8_t Cb, uint8_t Cr);
-
-    // 容错常量
-    static constexpr double FREQ_TOLERANCE = 60.0;
-    static constexpr size_t MEDIAN_WINDOW = 9; // 奇数
-    static constexpr double AFC_ALPHA = 0.1;
+    void resample_segment(std::span<const FreqSample> buffer, std::span<uint8_t> out);
+    std::span<Pixel> line_output(int line_idx);
 };
 
 } // namespace sstv
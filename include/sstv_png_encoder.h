@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sstv_types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace sstv {
+
+// CRC-32 as used by PNG chunks (ISO 3309, reflected 0xEDB88320); `crc` chains partial updates
+[[nodiscard]] uint32_t crc32(std::span<const uint8_t> data, uint32_t crc = 0);
+
+// Streaming zlib (RFC 1950 / 1951) compressor with no external dependency.
+//
+// Greedy LZ77 over the 32 KiB deflate window (hash chains, bounded search)
+// with a dynamic Huffman code per block of BLOCK_SYMBOLS symbols. Input may
+// arrive in pieces of any size; compressed bytes accumulate in output() and
+// can be drained at any time. Not meant for streams of 4 GiB or more.
+class Deflater {
+public:
+    static constexpr size_t WINDOW = 32768;
+    static constexpr size_t BLOCK_SYMBOLS = 32768;
+    static constexpr size_t MAX_CHAIN = 32;  // Candidates tried per position
+
+    Deflater();
+
+    // Start a new stream (the zlib header is emitted immediately)
+    void reset();
+    void write(std::span<const uint8_t> data);
+    // Compress what is left, close the last block and append the Adler-32 trailer
+    void finish();
+
+    // Compressed bytes not taken yet; the caller may clear() it after use
+    [[nodiscard]] std::vector<uint8_t>& output() { return m_out; }
+
+private:
+    struct Symbol {
+        uint16_t value;     // Literal byte, or match length (3..258)
+        uint16_t distance;  // 0 for a literal
+    };
+
+    void compress(bool flush);
+    void insert_hash(size_t index);
+    void slide();
+    void emit_block(bool final);
+    void put_bits(uint32_t value, unsigned count);
+    void align_to_byte();
+
+    std::vector<uint8_t> m_window;   // History + lookahead, 2 * WINDOW bytes
+    size_t m_base = 0;               // Stream position of m_window[0]
+    size_t m_pos = 0;                // Next byte to encode (index into m_window)
+    size_t m_end = 0;                // End of buffered input (index into m_window)
+    std::vector<uint32_t> m_head;    // Hash -> most recent stream position + 1 (0 = none)
+    std::vector<uint32_t> m_prev;    // Position & (WINDOW - 1) -> previous position + 1 with the same hash
+
+    std::vector<Symbol> m_symbols;   // Current block
+    uint32_t m_adler = 1;
+    uint64_t m_bit_buffer = 0;
+    unsigned m_bit_count = 0;
+    std::vector<uint8_t> m_out;
+};
+
+// Streaming 8-bit RGB PNG writer.
+//
+// Rows are filtered (the per-row filter type with the smallest sum of
+// absolute differences, as libpng chooses it) and deflated as they arrive;
+// an IDAT chunk is written out every IDAT_BYTES of compressed data, so memory
+// use does not depend on the image height.
+class PngEncoder {
+public:
+    static constexpr size_t IDAT_BYTES = 64 * 1024;
+
+    // Writes the signature and IHDR chunk to `out`, which must outlive the encoder
+    PngEncoder(std::ostream& out, int width, int height);
+
+    // Append the next row. Shorter rows are padded with black, longer ones cut to the width.
+    void write_row(std::span<const Pixel> row);
+    // Pad the image with black rows up to the height, flush the last IDAT and write IEND
+    void finish();
+
+    [[nodiscard]] int rows_written() const { return m_rows_written; }
+
+private:
+    void write_chunk(const char (&type)[5], std::span<const uint8_t> data);
+    void write_idat(bool all);
+
+    std::ostream& m_out;
+    int m_width;
+    int m_height;
+    int m_rows_written = 0;
+    bool m_finished = false;
+
+    size_t m_stride;                          // Bytes per row without the filter-type byte
+    std::vector<uint8_t> m_previous;          // Unfiltered previous row (zeros before row 0)
+    std::vector<uint8_t> m_current;           // Unfiltered current row
+    std::array<std::vector<uint8_t>, 5> m_filtered;  // Candidate rows, filter-type byte first
+    Deflater m_deflater;
+};
+
+} // namespace sstv
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace sstv {
+
+// Wait-free single-producer / single-consumer ring buffer.
+//
+// push() may only be called from one thread and pop() from one other thread.
+// Neither side ever blocks, spins or allocates: each call is a bounded copy plus
+// one acquire load of the other side's index and one release store of its own.
+// Each side also keeps a private copy of the other side's index and only
+// reloads the shared one when that copy says the ring is full (or empty), so
+// the two cache lines are not bounced between cores on every call.
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two; storage is allocated here once
+    explicit SpscRing(size_t min_capacity)
+        : m_buffer(std::bit_ceil(std::max<size_t>(min_capacity, 2))), m_mask(m_buffer.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    [[nodiscard]] size_t capacity() const noexcept { return m_buffer.size(); }
+
+    // Producer: copy up to `count` items in, returns how many fit
+    size_t push(const T* data, size_t count) noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (capacity() - (head - m_cached_tail) < count) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+        }
+        const size_t n = std::min(count, capacity() - (head - m_cached_tail));
+        if (n == 0) return 0;
+
+        const size_t start = head & m_mask;
+        const size_t first = std::min(n, capacity() - start);
+        std::copy_n(data, first, m_buffer.data() + start);
+        std::copy_n(data + first, n - first, m_buffer.data());
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer: copy up to `max_count` items out, returns how many were read
+    size_t pop(T* out, size_t max_count) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cached_head - tail < max_count) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+        }
+        const size_t n = std::min(max_count, m_cached_head - tail);
+        if (n == 0) return 0;
+
+        const size_t start = tail & m_mask;
+        const size_t first = std::min(n, capacity() - start);
+        std::copy_n(m_buffer.data() + start, first, out);
+        std::copy_n(m_buffer.data(), n - first, out + first);
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Items currently queued: a lower bound on the consumer thread, an upper
+    // bound on the producer thread, an estimate anywhere else
+    [[nodiscard]] size_t size() const noexcept {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return m_head.load(std::memory_order_acquire) - tail; // tail first, so head >= tail
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> m_buffer;
+    size_t m_mask;
+
+    // Producer-owned: write index and its view of the read index
+    alignas(CACHE_LINE) std::atomic<size_t> m_head{0};
+    size_t m_cached_tail = 0;
+
+    // Consumer-owned: read index and its view of the write index
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail{0};
+    size_t m_cached_head = 0;
+};
+
+} // namespace sstv
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace sstv {
+
+// Monitoring counters for the decoding hot path.
+//
+// Every counter has exactly one writer, the thread that is currently running
+// the owning component's process() call, and any number of readers (e.g. a
+// monitoring thread). Writes are a relaxed load + store rather than fetch_add,
+// so incrementing never issues a locked instruction, and readers never block
+// the DSP thread. Configure with -DSSTV_ENABLE_STATS=OFF to compile all
+// updates out; the counters then simply read as zero.
+#if defined(SSTV_DISABLE_STATS)
+inline constexpr bool STATS_ENABLED = false;
+#else
+inline constexpr bool STATS_ENABLED = true;
+#endif
+
+class StatCounter {
+public:
+    void add(uint64_t n = 1) noexcept {
+        if constexpr (STATS_ENABLED) {
+            m_value.store(m_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+    [[nodiscard]] uint64_t load() const noexcept { return m_value.load(std::memory_order_relaxed); }
+    // Writer side only: must not race with add()
+    void reset() noexcept { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+// Last-value gauge with the same single-writer rules as StatCounter
+class StatGauge {
+public:
+    void set(double value) noexcept {
+        if constexpr (STATS_ENABLED) m_value.store(value, std::memory_order_relaxed);
+    }
+    [[nodiscard]] double load() const noexcept { return m_value.load(std::memory_order_relaxed); }
+    void reset() noexcept { m_value.store(0.0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+// Adds the lifetime of the scope (in nanoseconds) to a counter. Meant for
+// whole-block stages: two clock reads per block, never per sample.
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(StatCounter& elapsed_ns) noexcept : m_elapsed_ns(elapsed_ns) {
+        if constexpr (STATS_ENABLED) m_start = Clock::now();
+    }
+    ~ScopedStageTimer() {
+        if constexpr (STATS_ENABLED) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start);
+            m_elapsed_ns.add(static_cast<uint64_t>(elapsed.count()));
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    StatCounter& m_elapsed_ns;
+    Clock::time_point m_start{};
+};
+
+} // namespace sstv
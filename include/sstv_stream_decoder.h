@@ -0,0 +1,90 @@
+#pragma once
+
+#include "sstv_decoder.h"
+#include "sstv_spsc_ring.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sstv {
+
+// Realtime ingest front end for live capture (ALSA / PortAudio / ... callbacks).
+//
+// The capture thread only calls push(), which copies the samples into a
+// wait-free SPSC ring and returns: it never blocks, allocates, throws or makes
+// a system call, so a slow line conversion or user callback cannot cause an
+// xrun. A dedicated decoder thread drains the ring in block_size chunks and runs
+// Decoder::process(); all Decoder callbacks fire on that thread. If the decoder
+// falls behind by more than the ring capacity, the samples that do not fit are
+// dropped and counted (overrun_count() / dropped_samples()).
+class StreamDecoder {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1024;
+    static constexpr double DEFAULT_BUFFER_SECONDS = 4.0;
+
+    // buffer_samples == 0 sizes the ring for DEFAULT_BUFFER_SECONDS of input
+    explicit StreamDecoder(double sample_rate, size_t block_size = DEFAULT_BLOCK_SIZE, size_t buffer_samples = 0,
+                           dsp::ResamplerMode resampler = dsp::ResamplerMode::LIBSAMPLERATE);
+    ~StreamDecoder();
+
+    StreamDecoder(const StreamDecoder&) = delete;
+    StreamDecoder& operator=(const StreamDecoder&) = delete;
+
+    // The wrapped decoder. Configure it and install callbacks before start();
+    // while running it belongs to the decoder thread (stats() stays safe to call).
+    [[nodiscard]] Decoder& decoder() { return m_decoder; }
+    [[nodiscard]] const Decoder& decoder() const { return m_decoder; }
+
+    // Start / stop the decoder thread. stop() decodes whatever is still queued
+    // before returning, and rethrows an exception raised by Decoder::process().
+    void start();
+    void stop();
+    [[nodiscard]] bool running() const { return m_thread.joinable(); }
+
+    // Capture thread only (single producer). Returns the number of samples
+    // accepted; a short count means an overrun and the rest was dropped.
+    size_t push(const float* samples, size_t count) noexcept;
+
+    // Block until every sample pushed so far has been decoded. Must not be
+    // called from the capture thread or from a Decoder callback.
+    void flush();
+
+    [[nodiscard]] uint64_t overrun_count() const { return m_overruns.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t dropped_samples() const { return m_dropped.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t queued_samples() const { return m_ring.size(); }
+    [[nodiscard]] size_t capacity() const { return m_ring.capacity(); }
+    [[nodiscard]] size_t block_size() const { return m_block_size; }
+
+private:
+    void run();
+
+    Decoder m_decoder;
+    SpscRing<float> m_ring;
+    double m_sample_rate;
+    size_t m_block_size;
+    std::vector<float> m_block;  // Decoder-thread scratch, one block
+
+    // Producer-written counters (plain load + store, single writer)
+    std::atomic<uint64_t> m_pushed{0};
+    std::atomic<uint64_t> m_overruns{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    // Decoder-thread bookkeeping; the mutex is never touched by push()
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake_cv;     // stop / flush requests -> decoder thread
+    std::condition_variable m_progress_cv; // decoder thread -> flush()
+    uint64_t m_processed = 0;  // Decoded and flushed out of the decoder
+    uint64_t m_unflushed = 0;  // Decoder thread only: decoded, but possibly still held back
+    size_t m_flush_requests = 0;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+};
+
+} // namespace sstv
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef SSTV_TRACE_CAPACITY
+#define SSTV_TRACE_CAPACITY 16384
+#endif
+
+namespace sstv {
+
+// Per-sample state tracing for the protocol state machines.
+//
+// Configure with -DSSTV_ENABLE_TRACE=ON to record, for every sample seen by
+// VISDecoder / PDDemodulator, the state it was in, the raw and AFC-corrected
+// frequency, the PD sync envelopes and the AFC offset into a fixed-size ring.
+// The ring keeps the most recent SSTV_TRACE_CAPACITY records (16384, ~1.5 s at
+// the internal 11025 Hz rate), so after a failed decode the samples leading up
+// to the failure can be dumped (see Decoder::dump_trace()). In the default
+// build every record() call sits behind `if constexpr (TRACE_ENABLED)` and
+// compiles away, and the buffer allocates no storage.
+#if defined(SSTV_ENABLE_TRACE)
+inline constexpr bool TRACE_ENABLED = true;
+#else
+inline constexpr bool TRACE_ENABLED = false;
+#endif
+
+enum class TraceSource : uint8_t { VIS, PD };
+
+struct TraceRecord {
+    uint64_t sample_index = 0;      // Internal-rate sample clock (TraceBuffer::tick())
+    TraceSource source = TraceSource::VIS;
+    uint8_t state = 0;              // VISDecoder::State or PDDemodulator::SegmentType on entry
+    float freq = 0.0f;              // Estimator output (Hz)
+    float corrected_freq = 0.0f;    // After AFC (VIS: median-smoothed first)
+    float env12 = 0.0f;             // PD 1200 Hz sync envelope (0 for VIS)
+    float env15 = 0.0f;             // PD 1500 Hz reference envelope (0 for VIS)
+    float afc_offset = 0.0f;        // Offset the component is applying (Hz)
+};
+
+// Single-writer ring. record() is a plain slot store plus a release store of
+// the head index, so the writer never locks or allocates; total_recorded() may
+// be read from any thread. snapshot() reads the slots themselves and must not
+// run concurrently with the writer (call it between process() calls).
+class TraceBuffer {
+public:
+    static constexpr size_t CAPACITY = SSTV_TRACE_CAPACITY;
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SSTV_TRACE_CAPACITY must be a power of two");
+
+    TraceBuffer() {
+        if constexpr (TRACE_ENABLED) m_records.resize(CAPACITY);
+    }
+
+    // Advance the sample clock stamped into subsequent records
+    void tick() noexcept {
+        if constexpr (TRACE_ENABLED) ++m_sample_index;
+    }
+
+    void record(TraceRecord record) noexcept {
+        if constexpr (TRACE_ENABLED) {
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            record.sample_index = m_sample_index;
+            m_records[head & (CAPACITY - 1)] = record;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+    }
+
+    // Records written since construction / clear(), including overwritten ones
+    [[nodiscard]] uint64_t total_recorded() const noexcept { return m_head.load(std::memory_order_acquire); }
+
+    // The retained records, oldest first
+    [[nodiscard]] std::vector<TraceRecord> snapshot() const {
+        const uint64_t head = total_recorded();
+        const uint64_t count = head < CAPACITY ? head : CAPACITY;
+        std::vector<TraceRecord> out;
+        out.reserve(static_cast<size_t>(count));
+        for (uint64_t i = head - count; i < head; ++i) out.push_back(m_records[i & (CAPACITY - 1)]);
+        return out;
+    }
+
+    // Drop all records; the sample clock keeps running
+    void clear() noexcept { m_head.store(0, std::memory_order_release); }
+
+private:
+    std::vector<TraceRecord> m_records;
+    std::atomic<uint64_t> m_head{0};
+    uint64_t m_sample_index = 0;
+};
+
+} // namespace sstv
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
-#include <map>
+#include <span>
 #include <numeric> // For std::iota
 
 namespace sstv {
@@ -15,6 +18,16 @@ constexpr double BLACK_FREQ = 1500.0;
 constexpr double WHITE_FREQ = 2300.0;
 constexpr double FREQ_RANGE = WHITE_FREQ - BLACK_FREQ; // 800 Hz
 
+// Sample type of the internal frequency chain (discriminator output, frequency
+// and segment buffers, pixel mapping). Double by default; configure with
+// -DSSTV_FLOAT32_PIPELINE=ON to keep the whole chain in float32. Error bounds of
+// the float build are documented in README.md ("Float32 pipeline").
+#if defined(SSTV_FLOAT32_PIPELINE)
+using FreqSample = float;
+#else
+using FreqSample = double;
+#endif
+
 constexpr double VIS_LOGIC_0_FREQ = 1300.0;
 constexpr double VIS_LOGIC_1_FREQ = 1100.0;
 constexpr double VIS_START_STOP_FREQ = 1200.0;
@@ -50,25 +63,14 @@ enum class SSTVFamily {
 };
 
 // 暴露给上层（Main/UI）的结构体
+// 平凡可复制：name 指向下方模式表中的字符串字面量（静态存储期），回调中按值传递无需分配
 struct SSTVMode {
-    std::string name;    // "PD120", "PD90", "Martin 1"
-    int vis_code;        // 95, 99, 172...
-    int width;           // 640
-    int height;          // 496
-    double duration_s;   // 预计总耗时
-    SSTVFamily family; // 新增：标识属于哪个家族
-};
-
-// --- 全局 VIS 注册表 (VISDecoder 使用) ---
-// 包含所有已知的 SSTV 模式，不分家族
-static const std::map<int, SSTVMode> GLOBAL_VIS_MAP = {
-    // PD 系列
-    {95, {"PD120", 95, 640, 496, 126.0, SSTVFamily::PD}},
-    {93, {"PD50",  93, 320, 256, 50.0,  SSTVFamily::PD}},
-    {99, {"PD90",  99, 320, 256, 90.0,  SSTVFamily::PD}},
-    {98, {"PD160", 98, 512, 400, 161.0, SSTVFamily::PD}},
-    {96, {"PD180", 96, 640, 496, 187.0, SSTVFamily::PD}},
-    {97, {"PD240", 97, 640, 496, 248.0, SSTVFamily::PD}},
+    std::string_view name; // "PD120", "PD90", "Martin 1"
+    int vis_code;          // 95, 99, 172...
+    int width;             // 640
+    int height;            // 496
+    double duration_s;     // 预计总耗时
+    SSTVFamily family;     // 新增：标识属于哪个家族
 };
 
 // PD 解调器内部使用的详细时序参数
@@ -78,25 +80,77 @@ struct PDTimings {
     double segment_ms;
 };
 
-// --- 全局 PD 模式表 ---
-// 数据参考自标准的 PD 模式时序表
-static const std::map<int, PDTimings> PD_TIMINGS_MAP = {
-    {95, {20.0, 2.08, 121.60}},
-    {93, {20.0, 2.08, 91.52}},
-    {99, {20.0, 2.08, 170.24}},
-    {98, {20.0, 2.08, 195.85}},
-    {96, {20.0, 2.08, 183.04}},
-    {97, {20.0, 2.08, 244.48}},
+// 模式描述符：VIS 注册信息 + 家族私有的时序参数
+struct ModeDescriptor {
+    SSTVMode mode;
+    PDTimings pd_timings; // 仅 SSTVFamily::PD 有效
 };
 
+// --- 全局模式表 (编译期常量) ---
+// 包含所有已知的 SSTV 模式，不分家族；PD 时序参考自标准的 PD 模式时序表
+inline constexpr std::array<ModeDescriptor, 6> MODE_TABLE = {{
+    // PD 系列
+    {{"PD120", 95, 640, 496, 126.0, SSTVFamily::PD}, {20.0, 2.08, 121.60}},
+    {{"PD50",  93, 320, 256, 50.0,  SSTVFamily::PD}, {20.0, 2.08, 91.52}},
+    {{"PD90",  99, 320, 256, 90.0,  SSTVFamily::PD}, {20.0, 2.08, 170.24}},
+    {{"PD160", 98, 512, 400, 161.0, SSTVFamily::PD}, {20.0, 2.08, 195.85}},
+    {{"PD180", 96, 640, 496, 187.0, SSTVFamily::PD}, {20.0, 2.08, 183.04}},
+    {{"PD240", 97, 640, 496, 248.0, SSTVFamily::PD}, {20.0, 2.08, 244.48}},
+}};
+
+// VIS 码为 7 位数据，VIS 码 -> MODE_TABLE 下标（-1 表示未注册）
+constexpr size_t VIS_CODE_COUNT = 128;
+inline constexpr std::array<int8_t, VIS_CODE_COUNT> VIS_MODE_INDEX = [] {
+    std::array<int8_t, VIS_CODE_COUNT> index{};
+    index.fill(-1);
+    for (size_t i = 0; i < MODE_TABLE.size(); ++i) {
+        index[static_cast<size_t>(MODE_TABLE[i].mode.vis_code)] = static_cast<int8_t>(i);
+    }
+    return index;
+}();
+
+// 按 VIS 码查表（数组下标，无分支搜索），未注册的 VIS 码返回 nullptr
+constexpr const ModeDescriptor* find_mode(int vis_code) {
+    if (vis_code < 0 || vis_code >= static_cast<int>(VIS_CODE_COUNT)) return nullptr;
+    const int8_t i = VIS_MODE_INDEX[static_cast<size_t>(vis_code)];
+    return i < 0 ? nullptr : &MODE_TABLE[static_cast<size_t>(i)];
+}
+
+// 所有已知模式中最大的像素数（整帧缓冲区容量）
+inline constexpr size_t MAX_MODE_PIXELS = [] {
+    size_t max_pixels = 0;
+    for (const auto& desc : MODE_TABLE) {
+        max_pixels = std::max(max_pixels, static_cast<size_t>(desc.mode.width) * desc.mode.height);
+    }
+    return max_pixels;
+}();
+
+// 所有已知模式中最宽的一行（行缓冲区容量）
+inline constexpr size_t MAX_MODE_WIDTH = [] {
+    size_t max_width = 0;
+    for (const auto& desc : MODE_TABLE) max_width = std::max(max_width, static_cast<size_t>(desc.mode.width));
+    return max_width;
+}();
+
+static_assert(find_mode(95)->mode.width == 640, "PD120 must be registered");
+static_assert(find_mode(0) == nullptr, "VIS code 0 is not a mode");
+
 // Callbacks
 using ModeDetectedCallback = std::function<void(const SSTVMode& mode)>;
-using LineDecodedCallback = std::function<void(int line_index, const std::vector<Pixel>& pixels)>;
+// `pixels` points into decoder-owned storage and is only valid during the call
+using LineDecodedCallback = std::function<void(int line_index, std::span<const Pixel> pixels)>;
 using ImageCompleteCallback = std::function<void(int width, int height)>;
+// Lightweight notification that a row of the decoder's frame buffer was written
+using LineReadyCallback = std::function<void(int line_index)>;
+
+// The same, tagged with the channel they originate from (DecoderPool, ChannelizedDecoder)
+using ChannelModeDetectedCallback = std::function<void(size_t channel, const SSTVMode& mode)>;
+using ChannelLineDecodedCallback = std::function<void(size_t channel, int line_index, std::span<const Pixel> pixels)>;
+using ChannelImageCompleteCallback = std::function<void(size_t channel, int width, int height)>;
 
 // --- Internal DSP types ---
 // For FIR filter coefficients and delay line
 using FilterCoefficients = std::vector<double>;
-using FilterDelayLine = std::vector<double>;
+using FilterDelayLine = std::vector<float>;
 
 } // namespace sstv
@@ -1,26 +1,20 @@
 #pragma once
 
 #include "sstv_types.h"
+#include "sstv_stats.h"
+#include "sstv_trace.h"
+#include "dsp_sliding_median.h"
+#include <array>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <cmath>
-#include <deque>
 #include <algorithm>
 
 namespace sstv {
 
     class VISDecoder {
     public:
-        VISDecoder(double sample_rate, ModeDetectedCallback on_mode_detected_cb);
-
-        // 处理频率序列，返回是否检测到完整 VIS
-        bool process_frequency(const double& freq);
-        void reset();
-
-        // 获取当前 AFC 偏移量
-        [[nodiscard]] double get_afc_offset() const { return m_afc_offset; }
-
-    private:
         enum class State {
             IDLE,                   // 等待信号
             PREAMBLE_WAIT_1,        // 等待下一个前导音下降沿，初步校准时序
@@ -34,8 +28,52 @@ namespace sstv {
             STOP_BIT,               // 30ms 1200Hz
             COMPLETE
         };
+        static constexpr size_t STATE_COUNT = static_cast<size_t>(State::COMPLETE) + 1;
+        static constexpr std::string_view state_name(State state) {
+            constexpr std::array<std::string_view, STATE_COUNT> names = {
+                "IDLE", "PREAMBLE_WAIT_1", "PREAMBLE", "LEADER_BURST_1", "BREAK_1200", "LEADER_BURST_2",
+                "START_BIT", "DATA_BITS", "PARITY_BIT", "STOP_BIT", "COMPLETE"};
+            return names[static_cast<size_t>(state)];
+        }
+
+        // 监控计数器（见 sstv_stats.h），可在其他线程读取
+        struct Stats {
+            // 未完成的 VIS 头被放弃时所处的状态（IDLE / COMPLETE 下的 reset 不计入）。
+            // 已分类的失败（校验错误、未注册的 VIS 码）只计入下面的计数器，不重复计入这里
+            std::array<StatCounter, STATE_COUNT> resets_by_state;
+            StatCounter parity_errors;
+            StatCounter headers_decoded;   // 完整解出的 VIS 头（含未注册的 VIS 码）
+            StatCounter unknown_modes;     // 其中未注册的 VIS 码
+        };
+
+        VISDecoder(double sample_rate, ModeDetectedCallback on_mode_detected_cb);
+
+        // 处理频率序列，返回是否检测到完整 VIS
+        bool process_frequency(FreqSample freq);
+        void reset();
+
+        [[nodiscard]] State state() const { return m_state; }
+
+        // 获取当前 AFC 偏移量
+        [[nodiscard]] double get_afc_offset() const { return m_afc_offset; }
+
+        [[nodiscard]] const Stats& stats() const { return m_stats; }
+        void reset_stats();
 
-        State m_state;
+        // 逐样本跟踪（见 sstv_trace.h），传入 nullptr 关闭；未开启 SSTV_ENABLE_TRACE 时不记录
+        void set_trace(TraceBuffer* trace) { m_trace = trace; }
+
+    private:
+        // 回到 IDLE 而不计入 resets_by_state
+        void restart();
+
+        // 常量：允许连续错误的时间（毫秒），超过此时间则重置
+        static constexpr double MAX_ERROR_TIME_MS = 15.0;
+        static constexpr size_t MEDIAN_WINDOW = 25; // 奇数
+
+        State m_state = State::IDLE;
+        Stats m_stats;
+        TraceBuffer* m_trace = nullptr;
         double m_sample_rate;
         double m_samples_per_ms;
         ModeDetectedCallback m_on_mode_detected;
@@ -44,7 +82,7 @@ namespace sstv {
         double m_state_timer_samples;   // 当前状态已持续的采样数
         size_t m_preamble_step;         // 当前处于第几个前导音
         int    m_error_count;           // 连续频率错误计数，用于鲁棒性
-        std::deque<double> m_median_buffer;
+        dsp::SlidingMedian<MEDIAN_WINDOW, FreqSample> m_median_filter;
 
         // AFC
         double m_afc_offset;           // 计算出的频偏 (实际频率 - 理论频率)
@@ -61,11 +99,7 @@ namespace sstv {
         void transition_to(State new_state, double reserved_time_ms);
         void reserve_time(double reserved_time_ms);
         bool is_freq_near(double freq, double target, double tolerance = 60.0);
-        double get_smoothed_freq(double raw_freq);
-
-        // 常量：允许连续错误的时间（毫秒），超过此时间则重置
-        const double MAX_ERROR_TIME_MS = 15.0;
-        const size_t MEDIAN_WINDOW = 25; // 奇数
+        FreqSample get_smoothed_freq(FreqSample raw_freq);
     };
 
 } // namespace sstv
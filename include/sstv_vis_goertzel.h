@@ -0,0 +1,145 @@
+#pragma once
+
+#include "sstv_types.h"
+#include "sstv_stats.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace sstv {
+
+    // VIS 头检测引擎
+    enum class VISEngine {
+        FM,       // VISDecoder：逐样本 FM 鉴频输出 + 中值滤波（默认）
+        GOERTZEL  // GoertzelVISDecoder：块 Goertzel 能量 + 30ms 匹配窗，不依赖频率估计器
+    };
+
+    // 块速率 VIS 解码器：直接处理带通滤波后的音频，不需要逐样本鉴频
+    //
+    // 两级结构：
+    // 1. 每 BLOCK_SIZE 样本一块，用 Goertzel 求块能量。空闲时用 1900 ± 500Hz 频点组捕获前导音并由
+    //    峰值频点插值估计频偏；锁定后只跟踪 (1900 + 频偏) 与 (1200 + 频偏) 两个频点，
+    //    等待前导音 -> 起始位 (1200Hz) 的跳变。10ms 的 1200Hz 间隔音不足 START_CONFIRM_BLOCKS 块，不会误判为起始位
+    // 2. 起始位之后再收满 10 个位周期，从历史样本中一次性解出 VIS 头：先在前导音末段细化频偏，
+    //    再在跳变块附近逐样本搜索位边界，使起始位、7 个数据位、校验位和停止位这 10 个 30ms 窗上
+    //    匹配频率 (1200 / 1100 / 1300) 的归一化 Goertzel 能量之和最大
+    //
+    // 每个位的判决基于整窗相干能量（分辨率约 33Hz），而不是鉴频输出的均值，低信噪比下更稳健。
+    // 与 VISDecoder 相同的约定：检出后调用 ModeDetectedCallback（未注册的 VIS 码报告为 "Unknown"），
+    // get_afc_offset() 返回前导音实测频率 - 1900Hz
+    class GoertzelVISDecoder {
+    public:
+        static constexpr size_t BLOCK_SIZE = 64;            // 5.8ms @ 11025Hz
+        static constexpr size_t ACQUIRE_BLOCKS = 10;        // 捕获前导音所需的连续块数 (~58ms)
+        static constexpr size_t START_CONFIRM_BLOCKS = 3;   // 判定起始位所需的连续 1200Hz 块数 (~17ms)
+        // 交接时附带的停止位之前的历史样本数，供调用方预热鉴频器（Hilbert 延迟线 + AGC）
+        static constexpr size_t HANDOVER_HISTORY = 512;
+
+        // 监控计数器（见 sstv_stats.h），可在其他线程读取
+        struct Stats {
+            StatCounter leaders_lost;      // 已锁定前导音但未解出 VIS 头（前导音中断或外部 reset）
+            StatCounter framing_errors;    // 起始位 / 停止位不是 1200Hz，或匹配得分过低
+            StatCounter parity_errors;
+            StatCounter headers_decoded;   // 完整解出的 VIS 头（含未注册的 VIS 码）
+            StatCounter unknown_modes;     // 其中未注册的 VIS 码
+        };
+
+        /**
+         * @param sample_rate 输入采样率
+         * @param on_mode_detected_cb 检出 VIS 头时调用
+         * @param purity_threshold 判定为单音的最小纯度（频点能量 / (N/2 * 块能量)）
+         * @param min_score 10 个位窗平均归一化能量的下限
+         */
+        GoertzelVISDecoder(double sample_rate, ModeDetectedCallback on_mode_detected_cb,
+                           float purity_threshold = 0.3f, float min_score = 0.3f);
+
+        // 处理一段带通滤波后的样本，consumed 返回实际消耗的样本数。
+        // 返回 true 表示检出完整 VIS 头：此时停在 consumed 处，剩余样本属于图像数据
+        bool process(std::span<const float> samples, size_t& consumed);
+        void reset();
+
+        // 是否仍在等待前导音（用于空闲信道门控）
+        [[nodiscard]] bool idle() const { return m_state == State::IDLE; }
+
+        // 获取当前 AFC 偏移量
+        [[nodiscard]] double get_afc_offset() const { return m_afc_offset; }
+
+        // 检出后有效：停止位结束前的 HANDOVER_HISTORY 个样本，加上停止位结束后已被本解码器消耗的样本
+        [[nodiscard]] std::span<const float> handover() const { return m_handover; }
+
+        [[nodiscard]] const Stats& stats() const { return m_stats; }
+        void reset_stats();
+
+    private:
+        enum class State {
+            IDLE,     // 频点组搜索前导音
+            LEADER,   // 已锁定前导音，等待起始位
+            HEADER,   // 收集起始位之后的 10 个位周期
+            COMPLETE
+        };
+
+        static constexpr size_t HISTORY_KEEP = 8192;       // 压缩后保留的最近样本数 (~740ms)
+        static constexpr size_t HISTORY_CAPACITY = 16384;  // 超过此长度时压缩
+        static constexpr size_t VIS_WINDOW_BITS = 10;      // 起始位 + 7 数据位 + 校验位 + 停止位
+        static constexpr size_t LEADER_WINDOW = 1024;      // 细化频偏所用的前导音末段长度
+        static constexpr double ACQUIRE_SPAN_HZ = 500.0;     // 与 FM 引擎的 AFC 捕获范围一致
+        static constexpr double ACQUIRE_TOLERANCE_HZ = 60.0; // 捕获期间各块频偏估计允许的偏差
+        static constexpr double FINE_SEARCH_HZ = 45.0;
+        static constexpr double FINE_STEP_HZ = 5.0;
+        static constexpr double MIN_LEADER_MS = 100.0;     // 起始位之前至少需要的前导音长度
+        static constexpr double LEADER_DROPOUT_MS = 50.0;  // 前导音中断超过此时间则放弃
+
+        struct WindowScore {
+            double score = 0.0;  // 10 个位窗匹配能量之和
+            int code = 0;        // 7 位 VIS 码 (LSB 先发)
+            bool parity_ok = false;
+            bool framed = false; // 起始位 / 停止位的 1200Hz 能量高于数据频率
+        };
+
+        void append(const float* samples, size_t count);
+        void process_block(const float* block);
+        void acquire_block(const float* block, float energy);
+        void track_block(const float* block, float energy);
+        bool decode_header();
+        [[nodiscard]] double refine_offset(uint64_t leader_end) const;
+        [[nodiscard]] WindowScore score_header(uint64_t start, double offset) const;
+        [[nodiscard]] const float* at(uint64_t sample_index) const;
+        [[nodiscard]] float coeff(double freq) const;
+
+        State m_state = State::IDLE;
+        Stats m_stats;
+        double m_sample_rate;
+        double m_bit_samples;
+        float m_purity_threshold;
+        float m_min_score;
+        ModeDetectedCallback m_on_mode_detected;
+
+        // 连续历史样本（按绝对样本序号定位），窗口计算直接使用指针
+        std::vector<float> m_history;
+        uint64_t m_history_start = 0;  // m_history[0] 的绝对序号
+        uint64_t m_total = 0;          // 已消耗的样本总数
+
+        // 捕获频点组
+        std::vector<float> m_acquire_coeffs;
+        std::vector<float> m_acquire_power;
+        double m_acquire_spacing;
+        size_t m_acquire_blocks = 0;
+        double m_acquire_offset_sum = 0.0;
+
+        // 前导音跟踪
+        double m_afc_offset = 0.0;
+        float m_leader_coeff = 0.0f;
+        float m_sync_coeff = 0.0f;
+        size_t m_leader_blocks = 0;    // 前导音持续块数（含间隔音）
+        size_t m_dropout_blocks = 0;   // 连续非前导音块数
+        size_t m_start_blocks = 0;     // 连续 1200Hz 块数
+        uint64_t m_start_candidate = 0;  // 第一个 1200Hz 块的起点
+        uint64_t m_header_ready_at = 0;  // 收满 VIS 头所需的样本序号
+
+        std::vector<float> m_handover;
+    };
+
+} // namespace sstv
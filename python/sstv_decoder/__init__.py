@@ -1,5 +1,11 @@
 # 从二进制模块导入所有内容
-from ._core import Decoder, Pixel, SSTVMode
+from ._core import (FLOAT32_PIPELINE, STATS_ENABLED, TRACE_ENABLED, ChannelizedDecoder, DecodedImage, Decoder,
+                    DecoderPool, DecoderStats, DiscriminatorMode, Frame, FrameInfo, FrameStatus, FreqTrackWriter,
+                    ImageFormat, ImageWriter, Pixel, ProcessingMode, ResamplerMode, SSTVMode, StreamDecoder, SyncMode,
+                    TrackEncoding, VISEngine, decode_buffer, decode_file)
 
 # 定义公开接口
-__all__ = ["Decoder", "Pixel", "SSTVMode"]
+__all__ = ["FLOAT32_PIPELINE", "STATS_ENABLED", "TRACE_ENABLED", "ChannelizedDecoder", "DecodedImage", "Decoder",
+           "DecoderPool", "DecoderStats", "DiscriminatorMode", "Frame", "FrameInfo", "FrameStatus", "FreqTrackWriter",
+           "ImageFormat", "ImageWriter", "Pixel", "ProcessingMode", "ResamplerMode", "SSTVMode", "StreamDecoder",
+           "SyncMode", "TrackEncoding", "VISEngine", "decode_buffer", "decode_file"]
@@ -6,21 +6,449 @@ import collections.abc
 import numpy
 import numpy.typing
 import typing
-__all__: list[str] = ['Decoder', 'Pixel', 'SSTVFamily', 'SSTVMode']
+__all__: list[str] = ['FLOAT32_PIPELINE', 'STATS_ENABLED', 'TRACE_ENABLED', 'ChannelizedDecoder', 'DecodedImage', 'Decoder', 'DecoderPool', 'DecoderStats', 'DiscriminatorMode', 'Frame', 'FrameInfo', 'FrameStatus', 'FreqTrackWriter', 'ImageFormat', 'ImageWriter', 'Pixel', 'ProcessingMode', 'ResamplerMode', 'SSTVFamily', 'SSTVMode', 'StreamDecoder', 'SyncMode', 'TrackEncoding', 'VISEngine', 'decode_buffer', 'decode_file']
+class ChannelizedDecoder:
+    def __init__(self, sample_rate: typing.SupportsFloat, offsets: collections.abc.Sequence[typing.SupportsFloat], max_channel_spacing: typing.SupportsFloat = 800.0, resampler: ResamplerMode = ResamplerMode.POLYPHASE) -> None:
+        ...
+    def channel_offset(self, channel: typing.SupportsInt) -> float:
+        ...
+    def channel_stats(self, channel: typing.SupportsInt) -> DecoderStats:
+        ...
+    def flush(self) -> None:
+        ...
+    def process(self, samples: typing.Annotated[numpy.typing.ArrayLike, numpy.float32]) -> None:
+        """
+        Process wideband audio samples (NumPy array)
+        """
+    def reset(self) -> None:
+        ...
+    def set_image_timeout_lines(self, lines: typing.SupportsInt) -> None:
+        ...
+    def set_image_writer(self, channel: typing.SupportsInt, writer: ImageWriter) -> None:
+        ...
+    def set_on_image_complete_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt, typing.SupportsInt], None]) -> None:
+        ...
+    def set_on_line_decoded_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt, collections.abc.Sequence[Pixel]], None]) -> None:
+        ...
+    def set_on_mode_detected_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, SSTVMode], None]) -> None:
+        ...
+    def set_sync_mode(self, mode: SyncMode) -> None:
+        ...
+    def set_tone_gate_enabled(self, enabled: bool = True) -> None:
+        ...
+    def set_vis_engine(self, engine: VISEngine) -> None:
+        ...
+    def signal_offset(self, channel: typing.SupportsInt) -> float:
+        ...
+    @property
+    def channel_count(self) -> int:
+        ...
+    @property
+    def channel_rate(self) -> float:
+        ...
+    @property
+    def channel_spacing(self) -> float:
+        ...
+class DecodedImage:
+    @property
+    def complete(self) -> bool:
+        ...
+    @property
+    def data_offset(self) -> int:
+        ...
+    @property
+    def height(self) -> int:
+        ...
+    @property
+    def lines_decoded(self) -> int:
+        ...
+    @property
+    def mode(self) -> SSTVMode:
+        ...
+    @property
+    def pixels(self) -> numpy.typing.NDArray[numpy.uint8]:
+        ...
+    @property
+    def sample_offset(self) -> int:
+        ...
+    @property
+    def width(self) -> int:
+        ...
 class Decoder:
-    def __init__(self, sample_rate: typing.SupportsFloat) -> None:
+    def __init__(self, sample_rate: typing.SupportsFloat, resampler: ResamplerMode = ResamplerMode.LIBSAMPLERATE) -> None:
+        ...
+    def acquire_frame(self, timeout: typing.SupportsFloat | None = None) -> Frame | None:
+        ...
+    def cancel_image(self) -> None:
+        ...
+    def clear_trace(self) -> None:
         ...
+    def dump_trace(self) -> str:
+        """
+        Retained per-sample state trace as CSV (empty unless TRACE_ENABLED)
+        """
+    def flush(self) -> None:
+        """
+        Decode samples held back by ProcessingMode.THROUGHPUT
+        """
     def process(self, samples: typing.Annotated[numpy.typing.ArrayLike, numpy.float32]) -> None:
         """
         Process audio samples (NumPy array)
         """
+    def replay_track(self, path: str) -> None:
+        """
+        Decode a frequency track file
+        """
     def reset(self) -> None:
         ...
-    def set_on_image_complete_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt], None]) -> None:
+    def reset_stats(self) -> None:
+        ...
+    def set_discriminator_mode(self, mode: DiscriminatorMode) -> None:
+        ...
+    def set_frame_buffer_enabled(self, enabled: bool = True) -> None:
+        ...
+    def set_frame_manager_enabled(self, enabled: bool = True, slots: typing.SupportsInt = 2) -> None:
+        ...
+    def set_freq_track_writer(self, writer: FreqTrackWriter | None) -> None:
+        ...
+    def set_image_timeout_lines(self, lines: typing.SupportsInt) -> None:
+        ...
+    def set_image_writer(self, writer: ImageWriter | None) -> None:
+        ...
+    def set_on_image_complete_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt], None] | None) -> None:
+        ...
+    def set_on_image_finished_callback(self, arg0: collections.abc.Callable[[FrameInfo], None] | None) -> None:
         ...
-    def set_on_line_decoded_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, collections.abc.Sequence[Pixel]], None]) -> None:
+    def set_on_line_decoded_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, collections.abc.Sequence[Pixel]], None] | None) -> None:
         ...
-    def set_on_mode_detected_callback(self, arg0: collections.abc.Callable[[SSTVMode], None]) -> None:
+    def set_on_line_ready_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt], None] | None) -> None:
+        ...
+    def set_on_mode_detected_callback(self, arg0: collections.abc.Callable[[SSTVMode], None] | None) -> None:
+        ...
+    def set_processing_mode(self, mode: ProcessingMode) -> None:
+        ...
+    def set_sync_mode(self, mode: SyncMode) -> None:
+        ...
+    def set_tone_gate_enabled(self, enabled: bool = True) -> None:
+        ...
+    def set_vis_engine(self, engine: VISEngine) -> None:
+        ...
+    def stats(self) -> DecoderStats:
+        """
+        Snapshot of the monitoring counters (safe from any thread)
+        """
+    @property
+    def dropped_frames(self) -> int:
+        ...
+    @property
+    def frame(self) -> numpy.typing.NDArray[numpy.uint8]:
+        ...
+    @property
+    def frame_buffer_enabled(self) -> bool:
+        ...
+    @property
+    def frame_manager_enabled(self) -> bool:
+        ...
+    @property
+    def image_timeout_lines(self) -> int:
+        ...
+    @property
+    def preferred_block_size(self) -> int:
+        ...
+    @property
+    def processing_mode(self) -> ProcessingMode:
+        ...
+    @property
+    def sync_mode(self) -> SyncMode:
+        ...
+    @property
+    def tone_gate_enabled(self) -> bool:
+        ...
+    @property
+    def vis_engine(self) -> VISEngine:
+        ...
+class DecoderPool:
+    def __init__(self, channel_count: typing.SupportsInt, sample_rate: typing.SupportsFloat, worker_count: typing.SupportsInt = 0) -> None:
+        ...
+    def channel_stats(self, channel: typing.SupportsInt) -> DecoderStats:
+        ...
+    def reset_channel(self, channel: typing.SupportsInt) -> None:
+        ...
+    def set_image_timeout_lines(self, lines: typing.SupportsInt) -> None:
+        ...
+    def set_on_image_complete_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt, typing.SupportsInt], None]) -> None:
+        ...
+    def set_on_line_decoded_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt, collections.abc.Sequence[Pixel]], None]) -> None:
+        ...
+    def set_on_mode_detected_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, SSTVMode], None]) -> None:
+        ...
+    def set_sync_mode(self, mode: SyncMode) -> None:
+        ...
+    def set_tone_gate_enabled(self, enabled: bool = True) -> None:
+        ...
+    def set_vis_engine(self, engine: VISEngine) -> None:
+        ...
+    def submit(self, channel: typing.SupportsInt, samples: typing.Annotated[numpy.typing.ArrayLike, numpy.float32]) -> None:
+        """
+        Queue audio samples (NumPy array) for a channel
+        """
+    def wait_idle(self) -> None:
+        ...
+    @property
+    def channel_count(self) -> int:
+        ...
+    @property
+    def worker_count(self) -> int:
+        ...
+class DecoderStats:
+    @property
+    def afc_offset(self) -> float:
+        ...
+    @property
+    def bandpass_ns(self) -> int:
+        ...
+    @property
+    def estimator_ns(self) -> int:
+        ...
+    @property
+    def fused_front_end_ns(self) -> int:
+        ...
+    @property
+    def gate_openings(self) -> int:
+        ...
+    @property
+    def gated_samples(self) -> int:
+        ...
+    @property
+    def images_cancelled(self) -> int:
+        ...
+    @property
+    def images_completed(self) -> int:
+        ...
+    @property
+    def images_timed_out(self) -> int:
+        ...
+    @property
+    def lines_emitted(self) -> int:
+        ...
+    @property
+    def pd_sync_timeouts(self) -> int:
+        ...
+    @property
+    def pd_syncs_detected(self) -> int:
+        ...
+    @property
+    def resampler_ns(self) -> int:
+        ...
+    @property
+    def samples_processed(self) -> int:
+        ...
+    @property
+    def state_machine_ns(self) -> int:
+        ...
+    @property
+    def vis_headers_decoded(self) -> int:
+        ...
+    @property
+    def vis_parity_errors(self) -> int:
+        ...
+    @property
+    def vis_unknown_modes(self) -> int:
+        ...
+    @property
+    def vis_resets(self) -> dict[str, int]:
+        ...
+class DiscriminatorMode:
+    """
+    Members:
+    
+      ATAN2
+    
+      FAST_ATAN2
+    """
+    ATAN2: typing.ClassVar[DiscriminatorMode]  # value = <DiscriminatorMode.ATAN2: 0>
+    FAST_ATAN2: typing.ClassVar[DiscriminatorMode]  # value = <DiscriminatorMode.FAST_ATAN2: 1>
+    __members__: typing.ClassVar[dict[str, DiscriminatorMode]]  # value = {'ATAN2': <DiscriminatorMode.ATAN2: 0>, 'FAST_ATAN2': <DiscriminatorMode.FAST_ATAN2: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class Frame:
+    def __bool__(self) -> bool:
+        ...
+    def release(self) -> None:
+        """
+        Return the buffer to the decoder
+        """
+    @property
+    def info(self) -> FrameInfo:
+        ...
+    @property
+    def pixels(self) -> numpy.typing.NDArray[numpy.uint8]:
+        ...
+class FrameInfo:
+    @property
+    def height(self) -> int:
+        ...
+    @property
+    def lines_decoded(self) -> int:
+        ...
+    @property
+    def mode(self) -> SSTVMode:
+        ...
+    @property
+    def sequence(self) -> int:
+        ...
+    @property
+    def status(self) -> FrameStatus:
+        ...
+    @property
+    def width(self) -> int:
+        ...
+class FrameStatus:
+    """
+    Members:
+    
+      COMPLETE
+    
+      CANCELLED
+    
+      TIMED_OUT
+    """
+    CANCELLED: typing.ClassVar[FrameStatus]  # value = <FrameStatus.CANCELLED: 1>
+    COMPLETE: typing.ClassVar[FrameStatus]  # value = <FrameStatus.COMPLETE: 0>
+    TIMED_OUT: typing.ClassVar[FrameStatus]  # value = <FrameStatus.TIMED_OUT: 2>
+    __members__: typing.ClassVar[dict[str, FrameStatus]]  # value = {'COMPLETE': <FrameStatus.COMPLETE: 0>, 'CANCELLED': <FrameStatus.CANCELLED: 1>, 'TIMED_OUT': <FrameStatus.TIMED_OUT: 2>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class FreqTrackWriter:
+    def __enter__(self) -> FreqTrackWriter:
+        ...
+    def __exit__(self, *args) -> None:
+        ...
+    def __init__(self, path: str, encoding: TrackEncoding = TrackEncoding.FLOAT32, chunk_samples: typing.SupportsInt = 65536) -> None:
+        ...
+    def close(self) -> None:
+        ...
+    @property
+    def encoding(self) -> TrackEncoding:
+        ...
+    @property
+    def samples_written(self) -> int:
+        ...
+class ImageFormat:
+    """
+    Members:
+    
+      RAW
+    
+      PNG
+    """
+    PNG: typing.ClassVar[ImageFormat]  # value = <ImageFormat.PNG: 1>
+    RAW: typing.ClassVar[ImageFormat]  # value = <ImageFormat.RAW: 0>
+    __members__: typing.ClassVar[dict[str, ImageFormat]]  # value = {'RAW': <ImageFormat.RAW: 0>, 'PNG': <ImageFormat.PNG: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class ImageWriter:
+    def __init__(self, path: str, format: ImageFormat | None = None, queue_lines: typing.SupportsInt = 1024) -> None:
+        ...
+    def flush(self) -> None:
+        """
+        Wait until every queued image is written; raises the first write error
+        """
+    def path_for(self, sequence: typing.SupportsInt) -> str:
+        ...
+    def set_on_image_written_callback(self, arg0: collections.abc.Callable[[str, FrameInfo], None] | None) -> None:
+        ...
+    def set_wait_when_full(self, wait: bool = True) -> None:
+        ...
+    @property
+    def format(self) -> ImageFormat:
+        ...
+    @property
+    def images_dropped(self) -> int:
+        ...
+    @property
+    def images_written(self) -> int:
+        ...
+    @property
+    def lines_dropped(self) -> int:
+        ...
+    @property
+    def queued_events(self) -> int:
+        ...
+    @property
+    def wait_when_full(self) -> bool:
         ...
 class Pixel:
     def __init__(self, arg0: typing.SupportsInt, arg1: typing.SupportsInt, arg2: typing.SupportsInt) -> None:
@@ -45,6 +473,83 @@ class Pixel:
     @r.setter
     def r(self, arg0: typing.SupportsInt) -> None:
         ...
+class ProcessingMode:
+    """
+    Members:
+    
+      BALANCED
+    
+      LOW_LATENCY
+    
+      THROUGHPUT
+    """
+    BALANCED: typing.ClassVar[ProcessingMode]  # value = <ProcessingMode.BALANCED: 0>
+    LOW_LATENCY: typing.ClassVar[ProcessingMode]  # value = <ProcessingMode.LOW_LATENCY: 1>
+    THROUGHPUT: typing.ClassVar[ProcessingMode]  # value = <ProcessingMode.THROUGHPUT: 2>
+    __members__: typing.ClassVar[dict[str, ProcessingMode]]  # value = {'BALANCED': <ProcessingMode.BALANCED: 0>, 'LOW_LATENCY': <ProcessingMode.LOW_LATENCY: 1>, 'THROUGHPUT': <ProcessingMode.THROUGHPUT: 2>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class ResamplerMode:
+    """
+    Members:
+    
+      LIBSAMPLERATE
+    
+      POLYPHASE
+    """
+    LIBSAMPLERATE: typing.ClassVar[ResamplerMode]  # value = <ResamplerMode.LIBSAMPLERATE: 0>
+    POLYPHASE: typing.ClassVar[ResamplerMode]  # value = <ResamplerMode.POLYPHASE: 1>
+    __members__: typing.ClassVar[dict[str, ResamplerMode]]  # value = {'LIBSAMPLERATE': <ResamplerMode.LIBSAMPLERATE: 0>, 'POLYPHASE': <ResamplerMode.POLYPHASE: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
 class SSTVFamily:
     """
     Members:
@@ -101,3 +606,166 @@ class SSTVMode:
     @property
     def width(self) -> int:
         ...
+class StreamDecoder:
+    def __init__(self, sample_rate: typing.SupportsFloat, block_size: typing.SupportsInt = 1024, buffer_samples: typing.SupportsInt = 0, resampler: ResamplerMode = ResamplerMode.LIBSAMPLERATE) -> None:
+        ...
+    def flush(self) -> None:
+        ...
+    def push(self, samples: typing.Annotated[numpy.typing.ArrayLike, numpy.float32]) -> int:
+        """
+        Queue captured audio (NumPy array); returns the number of samples accepted
+        """
+    def set_image_writer(self, writer: ImageWriter | None) -> None:
+        ...
+    def set_on_image_complete_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, typing.SupportsInt], None] | None) -> None:
+        ...
+    def set_on_line_decoded_callback(self, arg0: collections.abc.Callable[[typing.SupportsInt, collections.abc.Sequence[Pixel]], None] | None) -> None:
+        ...
+    def set_on_mode_detected_callback(self, arg0: collections.abc.Callable[[SSTVMode], None] | None) -> None:
+        ...
+    def start(self) -> None:
+        ...
+    def stats(self) -> DecoderStats:
+        ...
+    def stop(self) -> None:
+        ...
+    @property
+    def block_size(self) -> int:
+        ...
+    @property
+    def capacity(self) -> int:
+        ...
+    @property
+    def dropped_samples(self) -> int:
+        ...
+    @property
+    def overrun_count(self) -> int:
+        ...
+    @property
+    def queued_samples(self) -> int:
+        ...
+    @property
+    def running(self) -> bool:
+        ...
+class SyncMode:
+    """
+    Members:
+    
+      THRESHOLD
+    
+      CORRELATION
+    """
+    CORRELATION: typing.ClassVar[SyncMode]  # value = <SyncMode.CORRELATION: 1>
+    THRESHOLD: typing.ClassVar[SyncMode]  # value = <SyncMode.THRESHOLD: 0>
+    __members__: typing.ClassVar[dict[str, SyncMode]]  # value = {'THRESHOLD': <SyncMode.THRESHOLD: 0>, 'CORRELATION': <SyncMode.CORRELATION: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class TrackEncoding:
+    """
+    Members:
+    
+      FLOAT32
+    
+      INT16
+    """
+    FLOAT32: typing.ClassVar[TrackEncoding]  # value = <TrackEncoding.FLOAT32: 0>
+    INT16: typing.ClassVar[TrackEncoding]  # value = <TrackEncoding.INT16: 1>
+    __members__: typing.ClassVar[dict[str, TrackEncoding]]  # value = {'FLOAT32': <TrackEncoding.FLOAT32: 0>, 'INT16': <TrackEncoding.INT16: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class VISEngine:
+    """
+    Members:
+    
+      FM
+    
+      GOERTZEL
+    """
+    FM: typing.ClassVar[VISEngine]  # value = <VISEngine.FM: 0>
+    GOERTZEL: typing.ClassVar[VISEngine]  # value = <VISEngine.GOERTZEL: 1>
+    __members__: typing.ClassVar[dict[str, VISEngine]]  # value = {'FM': <VISEngine.FM: 0>, 'GOERTZEL': <VISEngine.GOERTZEL: 1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: typing.SupportsInt) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: typing.SupportsInt) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+FLOAT32_PIPELINE: bool
+STATS_ENABLED: bool
+TRACE_ENABLED: bool
+def decode_buffer(samples: typing.Annotated[numpy.typing.ArrayLike, numpy.float32], sample_rate: typing.SupportsFloat, max_threads: typing.SupportsInt = 0, resampler: ResamplerMode = ResamplerMode.LIBSAMPLERATE, tone_gate: bool = True) -> list[DecodedImage]:
+    """
+    Decode every SSTV image in a whole recording (NumPy array)
+    """
+def decode_file(path: str, sample_rate: typing.SupportsFloat, max_threads: typing.SupportsInt = 0, resampler: ResamplerMode = ResamplerMode.LIBSAMPLERATE, tone_gate: bool = True) -> list[DecodedImage]:
+    """
+    Decode every SSTV image in a raw float32/int16 or WAV recording
+    """
@@ -0,0 +1,194 @@
+// src/dsp_channelizer.cpp
+#include "dsp_channelizer.h"
+#include "dsp_filters.h" // make_fir_coeffs
+#include "dsp_simd.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace sstv::dsp {
+
+    // Hamming 窗的过渡带宽约为 3.3 * fs / N
+    static constexpr double HAMMING_TRANSITION_FACTOR = 3.3;
+
+    Channelizer::Channelizer(double input_rate, size_t channel_count, size_t decimation,
+                             double center_freq, double passband, double stopband)
+        : m_input_rate(input_rate),
+          m_channel_count(channel_count),
+          m_decimation(decimation),
+          m_center_freq(center_freq),
+          m_next_output(0),
+          m_rotation(0)
+    {
+        if (input_rate <= 0) {
+            throw std::runtime_error("Channelizer: sample rate must be positive");
+        }
+        if (channel_count == 0 || !std::has_single_bit(channel_count)) {
+            throw std::runtime_error("Channelizer: channel count must be a power of two");
+        }
+        if (decimation == 0) {
+            throw std::runtime_error("Channelizer: decimation must be positive");
+        }
+        if (passband <= 0 || stopband <= passband) {
+            throw std::runtime_error("Channelizer: stopband must lie beyond a non-empty passband");
+        }
+        // 复带通的阻带边缘必须落在输出奈奎斯特频率以内，否则抽取后混叠进通带
+        if (center_freq - passband < 0 || center_freq + stopband > output_rate() / 2.0) {
+            throw std::runtime_error("Channelizer: channel band does not fit the output sample rate");
+        }
+
+        // 原型长度由过渡带宽决定，向上取整到 K 的整数倍以便折叠
+        const double taps = HAMMING_TRANSITION_FACTOR * input_rate / (stopband - passband);
+        m_taps_per_branch = std::max<size_t>(1, static_cast<size_t>(std::ceil(taps / channel_count)));
+        const size_t L = m_taps_per_branch * channel_count;
+
+        // 低通原型截止于过渡带中点，再以滤波器中心为相位零点调制到 center_freq：
+        // 2 * Re(h') 即以 center_freq 为中心的线性相位实带通
+        const FilterCoefficients prototype = make_fir_coeffs(static_cast<int>(L), input_rate, 0.0,
+                                                             (passband + stopband) / 2.0);
+        const double omega = 2.0 * std::numbers::pi * center_freq / input_rate;
+        const double middle = static_cast<double>(L - 1) / 2.0;
+        m_taps_re.resize(L);
+        m_taps_im.resize(L);
+        for (size_t l = 0; l < L; ++l) {
+            const double phase = omega * (static_cast<double>(l) - middle);
+            m_taps_re[L - 1 - l] = static_cast<float>(prototype[l] * std::cos(phase));
+            m_taps_im[L - 1 - l] = static_cast<float>(prototype[l] * std::sin(phase));
+        }
+
+        m_history.assign(L - 1, 0.0f);
+        m_fold_re.resize(channel_count);
+        m_fold_im.resize(channel_count);
+        m_spectrum_re.resize(channel_count);
+        m_spectrum_im.resize(channel_count);
+
+        // 第 s 级蝶形（半长 h = 2^s）的旋转因子 e^{+jπi/h} 连续存放于 [h, 2h)，内层循环可直接向量化
+        m_twiddle_re.resize(channel_count);
+        m_twiddle_im.resize(channel_count);
+        for (size_t half = 1; half < channel_count; half <<= 1) {
+            for (size_t i = 0; i < half; ++i) {
+                const double angle = std::numbers::pi * static_cast<double>(i) / static_cast<double>(half);
+                m_twiddle_re[half + i] = static_cast<float>(std::cos(angle));
+                m_twiddle_im[half + i] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        const int bits = std::countr_zero(channel_count);
+        m_bit_reverse.resize(channel_count);
+        for (size_t i = 0; i < channel_count; ++i) {
+            uint32_t reversed = 0;
+            for (int b = 0; b < bits; ++b) {
+                if (i & (size_t{1} << b)) reversed |= uint32_t{1} << (bits - 1 - b);
+            }
+            m_bit_reverse[i] = reversed;
+        }
+    }
+
+    void Channelizer::reset() {
+        std::fill(m_history.begin(), m_history.end(), 0.0f);
+        m_next_output = 0;
+        m_rotation = 0;
+    }
+
+    double Channelizer::channel_offset(size_t channel) const {
+        const auto k = static_cast<double>(channel % m_channel_count);
+        const auto K = static_cast<double>(m_channel_count);
+        return (k < K / 2.0 ? k : k - K) * channel_spacing();
+    }
+
+    size_t Channelizer::channel_for_offset(double offset) const {
+        const auto K = static_cast<long long>(m_channel_count);
+        const long long k = std::llround(offset / channel_spacing());
+        return static_cast<size_t>(((k % K) + K) % K);
+    }
+
+    void Channelizer::fft() {
+        const size_t K = m_channel_count;
+        float* re = m_spectrum_re.data();
+        float* im = m_spectrum_im.data();
+        if (K < 4) {
+            if (K == 2) {
+                const float ur = re[0], ui = im[0];
+                re[0] = ur + re[1]; im[0] = ui + im[1];
+                re[1] = ur - re[1]; im[1] = ui - im[1];
+            }
+            return;
+        }
+
+        // 前两级合并为无乘法的基 4 蝶形（旋转因子只有 1 和 +j）
+        for (size_t i = 0; i < K; i += 4) {
+            const float b0r = re[i] + re[i + 1], b0i = im[i] + im[i + 1];
+            const float b1r = re[i] - re[i + 1], b1i = im[i] - im[i + 1];
+            const float b2r = re[i + 2] + re[i + 3], b2i = im[i + 2] + im[i + 3];
+            const float b3r = re[i + 2] - re[i + 3], b3i = im[i + 2] - im[i + 3];
+            re[i] = b0r + b2r;     im[i] = b0i + b2i;
+            re[i + 2] = b0r - b2r; im[i + 2] = b0i - b2i;
+            re[i + 1] = b1r - b3i; im[i + 1] = b1i + b3r;  // b1 + j*b3
+            re[i + 3] = b1r + b3i; im[i + 3] = b1i - b3r;  // b1 - j*b3
+        }
+        // 其余各级：实部 / 虚部分开存放，每组蝶形都是连续的 SIMD 块
+        for (size_t half = 4; half < K; half <<= 1) {
+            for (size_t i = 0; i < K; i += 2 * half) {
+                simd::radix2_butterflies(re + i, im + i, re + i + half, im + i + half,
+                                         &m_twiddle_re[half], &m_twiddle_im[half], half);
+            }
+        }
+    }
+
+    size_t Channelizer::process_into(std::span<const float> input, std::span<const size_t> channels,
+                                     std::span<float> output, size_t stride) {
+        if (input.empty()) return 0;
+        if (stride < max_output_size(input.size()) || output.size() < channels.size() * stride) {
+            throw std::runtime_error("Channelizer: output buffer too small");
+        }
+        for (size_t channel : channels) {
+            if (channel >= m_channel_count) {
+                throw std::runtime_error("Channelizer: channel index out of range");
+            }
+        }
+
+        // 1. 拼接线性工作区：[最近 L-1 个历史样本 | 输入块]
+        const size_t K = m_channel_count;
+        const size_t L = m_taps_re.size();
+        const size_t history = L - 1;
+        const size_t count = input.size();
+        if (m_block_buffer.size() < history + count) {
+            m_block_buffer.resize(history + count);
+        }
+        float* work = m_block_buffer.data();
+        std::copy(m_history.begin(), m_history.end(), work);
+        std::copy(input.begin(), input.end(), work + history);
+
+        size_t produced = 0;
+        for (; m_next_output < count; m_next_output += m_decimation) {
+            // 2. 窗口 work[i .. i + L - 1] 的最新样本即 input[i]；逐段乘以复原型并折叠到 K 点
+            simd::complex_fold(m_taps_re.data(), m_taps_im.data(), work + m_next_output, m_taps_per_branch, K,
+                               m_fold_re.data(), m_fold_im.data());
+
+            // 3. 折叠结果为时间反转顺序：u[n] = fold[K-1-n]。循环移位 (m*D) mod K 后按位反转顺序
+            //    放入 FFT 工作区：A[n] = u[(n + rotation) mod K]
+            for (size_t n = 0; n < K; ++n) {
+                const size_t src = K - 1 - ((n + m_rotation) & (K - 1));
+                m_spectrum_re[m_bit_reverse[n]] = m_fold_re[src];
+                m_spectrum_im[m_bit_reverse[n]] = m_fold_im[src];
+            }
+            fft();
+
+            // 4. 只取所选信道：2 * Re(Y_k)
+            for (size_t i = 0; i < channels.size(); ++i) {
+                output[i * stride + produced] = 2.0f * m_spectrum_re[channels[i]];
+            }
+            ++produced;
+            m_rotation = (m_rotation + m_decimation) & (K - 1);
+        }
+        m_next_output -= count;
+
+        // 5. 保存最近 L-1 个样本作为下一块的历史
+        std::copy_n(work + count, history, m_history.begin());
+        return produced;
+    }
+
+} // namespace sstv::dsp
@@ -2,6 +2,7 @@
 #include "dsp_filters.h"
 #include <numbers>   // C++20: For std::numbers::pi
 #include <algorithm> // For std::fill
+#include <stdexcept>
 
 namespace sstv::dsp {
 
@@ -71,14 +72,21 @@ FIRFilter::FIRFilter(int tap_count, double sample_rate, double cutoff_freq_low,
     : m_current_pos(0) // 初始化写入指针为0
 {
     // 调用 make_fir_coeffs 生成系数
-    m_coeffs = make_fir_coeffs(tap_count, sample_rate, cutoff_freq_low, cutoff_freq_high);
+    FilterCoefficients coeffs = make_fir_coeffs(tap_count, sample_rate, cutoff_freq_low, cutoff_freq_high);
 
     // 根据实际生成的系数数量更新 m_tap_count
     // 这样可以处理 make_fir_coeffs 在 tap_count <= 0 时返回空向量的情况
-    m_tap_count = m_coeffs.size();
+    m_tap_count = coeffs.size();
 
-    // 根据实际抽头数调整延迟线大小并清零
-    m_delay_line.resize(m_tap_count, 0.0f);
+    // 预先转换为 float 并做时间反转：m_taps[j] = h[N-1-j]
+    // 这样 y[n] = sum_k h[k] * x[n-k] 就变成与按时间正序排列的窗口做连续点积，内层循环无需类型转换
+    m_taps.resize(m_tap_count);
+    for (size_t j = 0; j < m_tap_count; ++j) {
+        m_taps[j] = static_cast<float>(coeffs[m_tap_count - 1 - j]);
+    }
+
+    // 镜像延迟线：每个样本同时写入 pos 和 pos + N
+    m_delay_line.resize(2 * m_tap_count, 0.0f);
 }
 
 void FIRFilter::clear() {
@@ -93,33 +101,51 @@ float FIRFilter::process_sample(float input_sample) {
         return 0.0f; // 或者根据需求返回 input_sample 实现直通
     }
 
-    // 将新输入的样本放入循环缓冲区中的当前写入位置
+    // 同时写入两个镜像位置，此后 m_delay_line[m_current_pos + 1 .. m_current_pos + N]
+    // 恰好是按时间正序排列的最近 N 个样本（最新样本位于 m_current_pos + N）
     m_delay_line[m_current_pos] = input_sample;
+    m_delay_line[m_current_pos + m_tap_count] = input_sample;
 
-    float output_sample = 0.0f;
-
-    // 执行卷积运算: y[n] = sum_{k=0 to N-1} (h[k] * x[n-k])
-    // m_coeffs[k] 对应 h[k]
-    // m_delay_line[(m_current_pos + m_tap_count - k) % m_tap_count] 对应 x[n-k]
-    for (size_t k = 0; k < m_tap_count; ++k) {
-        // 计算延迟线中对应 x[n-k] 的索引
-        // (m_current_pos - k + m_tap_count) % m_tap_count 确保在循环缓冲区中正确访问历史样本
-        // k=0 时访问最新样本 (m_delay_line[m_current_pos])，k=1 时访问倒数第二个样本，以此类推。
-        size_t delay_idx = (m_current_pos + m_tap_count - k) % m_tap_count;
-        output_sample += m_delay_line[delay_idx] * static_cast<float>(m_coeffs[k]);
-    }
+    // 执行卷积运算: y[n] = sum_{k=0 to N-1} (h[k] * x[n-k])，窗口连续，无需逐抽头取模
+    float output_sample = simd::dot_product(m_taps.data(), &m_delay_line[m_current_pos + 1], m_tap_count);
 
     // 移动写入指针到下一个位置（循环）
-    m_current_pos = (m_current_pos + 1) % m_tap_count;
+    if (++m_current_pos == m_tap_count) m_current_pos = 0;
 
     return output_sample;
 }
 
 void FIRFilter::process_block(const float* input_samples, float* output_samples, size_t count) {
-    // 循环处理样本块中的每个样本
-    for (size_t i = 0; i < count; ++i) {
-        output_samples[i] = process_sample(input_samples[i]);
+    if (count == 0) return;
+    if (m_tap_count == 0) {
+        std::fill(output_samples, output_samples + count, 0.0f);
+        return;
+    }
+
+    // 1. 拼接线性工作区：[最近 N-1 个历史样本 | 输入块]
+    const size_t history = m_tap_count - 1;
+    if (m_block_buffer.size() < history + count) {
+        m_block_buffer.resize(history + count);
+    }
+    float* work = m_block_buffer.data();
+    std::copy_n(&m_delay_line[m_current_pos + 1], history, work);
+    std::copy_n(input_samples, count, work + history);
+
+    // 2. 块卷积：output[i] 对应窗口 work[i .. i + N - 1]
+    simd::fir_block(m_taps.data(), m_tap_count, work, output_samples, count);
+
+    // 3. 把最近 N 个样本写回镜像延迟线，写入位置归零
+    const float* tail = work + count - 1;
+    std::copy_n(tail, m_tap_count, m_delay_line.data());
+    std::copy_n(tail, m_tap_count, m_delay_line.data() + m_tap_count);
+    m_current_pos = 0;
+}
+
+void FIRFilter::process_into(std::span<const float> input, std::span<float> output) {
+    if (output.size() < input.size()) {
+        throw std::runtime_error("FIRFilter: output buffer too small");
     }
+    process_block(input.data(), output.data(), input.size());
 }
 
 } // namespace sstv::dsp
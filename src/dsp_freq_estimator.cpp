@@ -1,17 +1,19 @@
 #include "dsp_freq_estimator.h"
+#include "dsp_pixel_kernels.h"
 #include <numbers>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 namespace sstv::dsp {
 
 // 增加抽头数可以提高希尔伯特变换的精度，但会增加延迟
-// 对于11025Hz采样率，63或127是比较平衡的选择
-constexpr int DEFAULT_HILBERT_TAPS = 63;
+// 对于11025Hz采样率，63或127是比较平衡的选择（见头文件 HILBERT_TAPS）
 
-FrequencyEstimator::FrequencyEstimator(double sample_rate)
+FrequencyEstimator::FrequencyEstimator(double sample_rate, DiscriminatorMode mode)
     : m_sample_rate(sample_rate),
       m_last_freq(0.0),
+      m_discriminator_mode(mode),
       m_write_pos(0),
       m_prev_i(0.0f),
       m_prev_q(0.0f),
@@ -19,11 +21,11 @@ FrequencyEstimator::FrequencyEstimator(double sample_rate)
 {
     m_agc = std::make_unique<AGC>();
 
-    m_buffer_size = DEFAULT_HILBERT_TAPS;
-    m_group_delay = m_buffer_size / 2;
+    m_buffer_size = HILBERT_TAPS;
+    m_group_delay = HILBERT_GROUP_DELAY;
 
     generate_hilbert_coeffs();
-    m_buffer.resize(m_buffer_size, 0.0f);
+    m_buffer.resize(2 * m_buffer_size, 0.0f);
 }
 
 void FrequencyEstimator::clear() {
@@ -33,74 +35,51 @@ void FrequencyEstimator::clear() {
     m_prev_i = 0.0f;
     m_prev_q = 0.0f;
     m_samples_processed = 0;
+    m_dc_blocker.clear();
 }
 
 void FrequencyEstimator::generate_hilbert_coeffs() {
-    m_coeffs.resize(m_buffer_size);
-    int M = m_buffer_size - 1;
-    for (int i = 0; i < m_buffer_size; ++i) {
-        int n = i - M / 2;
-        if (n == 0) {
-            m_coeffs[i] = 0.0f;
-        } else if (n % 2 == 0) {
-            m_coeffs[i] = 0.0f; // 理想希尔伯特偶数项为0
-        } else {
-            // 理想脉冲响应: 2 / (pi * n)
-            double val = 2.0 / (std::numbers::pi * n);
-            // 使用 Blackman 窗减少吉布斯效应
-            double window = 0.42 - 0.5 * std::cos(2.0 * std::numbers::pi * i / M) +
-                            0.08 * std::cos(4.0 * std::numbers::pi * i / M);
-            m_coeffs[i] = static_cast<float>(val * window);
-        }
+    // 只生成奇数偏移 n = 1, 3, ..., 31 的系数；偶数项 (含 n = 0) 理想情况下为 0，
+    // 负偏移由奇对称 h[-n] = -h[n] 得到
+    int M = static_cast<int>(m_buffer_size) - 1;
+    for (size_t t = 0; t < HILBERT_HALF_TAPS; ++t) {
+        int n = static_cast<int>(2 * t + 1);
+        int i = M / 2 + n; // 在完整 63 抽头中的位置
+        // 理想脉冲响应: 2 / (pi * n)
+        double val = 2.0 / (std::numbers::pi * n);
+        // 使用 Blackman 窗减少吉布斯效应
+        double window = 0.42 - 0.5 * std::cos(2.0 * std::numbers::pi * i / M) +
+                        0.08 * std::cos(4.0 * std::numbers::pi * i / M);
+        m_coeffs[t] = static_cast<float>(val * window);
     }
 }
 
-// IIR DC blocker
-float dc_blocker(float input) {
-    static float prev_input = 0.0f;
-    static float prev_output = 0.0f;
-    const float alpha = 0.995f; // 截止频率越小，alpha 越接近 1
-
-    float output = input - prev_input + alpha * prev_output;
-    prev_input = input;
-    prev_output = output;
-    return output;
+float fast_atan2(float y, float x) {
+    // 先把角度折叠到 [0, pi/4]，在该区间用奇次多项式逼近 atan(a)，再按象限展开
+    // 全部为无分支的比较/选择，便于编译器整块向量化
+    float ax = std::abs(x);
+    float ay = std::abs(y);
+    float mx = std::max(ax, ay);
+    float mn = std::min(ax, ay);
+    float a = mn / (mx + 1e-30f); // 避免 0/0
+    float s = a * a;
+    float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s - 0.3302995f) * s + 0.9998660f) * a;
+    r = (ay > ax) ? 1.57079637f - r : r;
+    r = (x < 0.0f) ? 3.14159274f - r : r;
+    return (y < 0.0f) ? -r : r;
 }
 
-double FrequencyEstimator::process_sample(float input_sample) {
-    // DC Blocker (必须在 AGC 之前，否则 DC 会被放大)
-    float sample_no_dc = dc_blocker(input_sample);
-
-    // AGC (确保信号进入希尔伯特变换时幅度适中)
-    float sample_normalized = m_agc->process(sample_no_dc);
-
-    // 1. 更新循环缓冲区
-    m_buffer[m_write_pos] = sample_normalized;
-
-    // 2. 卷积计算 Q 路 (正交分量)
-    float q = 0.0f;
-    for (size_t i = 0; i < m_buffer_size; ++i) {
-        // 访问缓冲区：从最新样本向后回溯
-        size_t tap_idx = (m_write_pos + m_buffer_size - i) % m_buffer_size;
-        q += m_buffer[tap_idx] * m_coeffs[i];
-    }
-
-    // 3. 获取 I 路 (通过组延迟对齐同相分量)
-    size_t read_idx = (m_write_pos + m_buffer_size - m_group_delay) % m_buffer_size;
-    float i_val = m_buffer[read_idx];
-
-    // 更新指针
-    m_write_pos = (m_write_pos + 1) % m_buffer_size;
+FreqSample FrequencyEstimator::discriminate(float i_val, float q) {
     m_samples_processed++;
 
-    // 4. 启动过渡期检查 (确保滤波器填满)
+    // 启动过渡期检查 (确保滤波器填满)
     if (m_samples_processed <= m_buffer_size) {
         m_prev_i = i_val;
         m_prev_q = q;
         return 0.0;
     }
 
-    // 5. 噪声门限检查 (防止在静音期间产生随机频率)
+    // 噪声门限检查 (防止在静音期间产生随机频率)
     float mag_sq = i_val * i_val + q * q;
     if (mag_sq < 1e-7f) {
         m_prev_i = i_val;
@@ -108,7 +87,7 @@ double FrequencyEstimator::process_sample(float input_sample) {
         return m_last_freq; // 或者返回 0.0
     }
 
-    // 6. 复数差分鉴频核心算法
+    // 复数差分鉴频核心算法
     // 设当前复数 Z(n) = I + jQ, 前一时刻复数 Z(n-1) = Ip + jQp
     // 相位差 delta_phi = angle( Z(n) * conj(Z(n-1)) )
     // Z(n) * conj(Z(n-1)) = (I + jQ) * (Ip - jQp)
@@ -116,39 +95,136 @@ double FrequencyEstimator::process_sample(float input_sample) {
     // 实部 Re (点积): I*Ip + Q*Qp
     // 虚部 Im (叉积): Q*Ip - I*Qp
 
-    double dot   = static_cast<double>(i_val) * m_prev_i + static_cast<double>(q) * m_prev_q;
-    double cross = static_cast<double>(q) * m_prev_i - static_cast<double>(i_val) * m_prev_q;
+    // 以 FreqSample 精度计算（默认 double；float32 链路下为 float + std::atan2(float, float)）
+    FreqSample dot   = static_cast<FreqSample>(i_val) * m_prev_i + static_cast<FreqSample>(q) * m_prev_q;
+    FreqSample cross = static_cast<FreqSample>(q) * m_prev_i - static_cast<FreqSample>(i_val) * m_prev_q;
 
     // 直接得到相邻样本间的相位变化量，无需进行传统的 Unwrap 操作
-    double delta_phase = std::atan2(cross, dot);
+    FreqSample delta_phase = (m_discriminator_mode == DiscriminatorMode::FAST_ATAN2)
+        ? static_cast<FreqSample>(fast_atan2(static_cast<float>(cross), static_cast<float>(dot)))
+        : std::atan2(cross, dot);
 
-    // 7. 更新状态
+    // 更新状态
     m_prev_i = i_val;
     m_prev_q = q;
 
-    // 8. 转换为频率 (Hz)
+    // 转换为频率 (Hz)
     // f = (delta_phase * Fs) / (2 * PI)
-    double raw_freq = (delta_phase * m_sample_rate) / (2.0 * std::numbers::pi);
+    FreqSample raw_freq = (delta_phase * static_cast<FreqSample>(m_sample_rate)) /
+                          static_cast<FreqSample>(2.0 * std::numbers::pi);
     m_last_freq = raw_freq;
 
     return m_last_freq;
 }
 
-std::vector<double> FrequencyEstimator::process_block(const float* input_samples, size_t count) {
-    std::vector<double> frequencies;
-    frequencies.reserve(count);
+FreqSample FrequencyEstimator::process_sample(float input_sample) {
+    // DC Blocker (必须在 AGC 之前，否则 DC 会被放大)
+    float sample_no_dc = m_dc_blocker.process(input_sample);
+
+    // AGC (确保信号进入希尔伯特变换时幅度适中)
+    float sample_normalized = m_agc->process(sample_no_dc);
+
+    // 1. 更新镜像延迟线，window[0 .. N-1] 为按时间正序排列的最近 N 个样本
+    m_buffer[m_write_pos] = sample_normalized;
+    m_buffer[m_write_pos + m_buffer_size] = sample_normalized;
+    const float* window = &m_buffer[m_write_pos + 1];
+
+    // 2. 卷积计算 Q 路 (正交分量)，只计算非零的奇数偏移抽头
+    float q;
+    simd::odd_antisymmetric_fir_block<HILBERT_HALF_TAPS>(m_coeffs.data(), window + m_group_delay, &q, 1);
+
+    // 3. 获取 I 路 (通过组延迟对齐同相分量)
+    float i_val = window[m_group_delay];
+
+    // 更新指针
+    if (++m_write_pos == m_buffer_size) m_write_pos = 0;
+
+    // 4. 鉴频
+    return discriminate(i_val, q);
+}
+
+void FrequencyEstimator::discriminate_block_fast(const float* i_vals, const float* q_vals, FreqSample* output, size_t count) {
+    if (m_phase_buffer.size() < count) m_phase_buffer.resize(count);
+    float* phase = m_phase_buffer.data();
+
+    // 1. 整块计算相邻样本的相位差（与逐样本路径的算式一致，无依赖链，可向量化）
+    float prev_i = m_prev_i;
+    float prev_q = m_prev_q;
+    for (size_t i = 0; i < count; ++i) {
+        FreqSample dot   = static_cast<FreqSample>(i_vals[i]) * prev_i + static_cast<FreqSample>(q_vals[i]) * prev_q;
+        FreqSample cross = static_cast<FreqSample>(q_vals[i]) * prev_i - static_cast<FreqSample>(i_vals[i]) * prev_q;
+        phase[i] = fast_atan2(static_cast<float>(cross), static_cast<float>(dot));
+        prev_i = i_vals[i];
+        prev_q = q_vals[i];
+    }
+
+    // 2. 启动过渡期与噪声门限（保持上一次的频率输出，存在顺序依赖）
     for (size_t i = 0; i < count; ++i) {
-        frequencies.push_back(process_sample(input_samples[i]));
+        m_samples_processed++;
+        if (m_samples_processed <= m_buffer_size) {
+            output[i] = 0.0;
+            continue;
+        }
+        float mag_sq = i_vals[i] * i_vals[i] + q_vals[i] * q_vals[i];
+        if (mag_sq >= 1e-7f) {
+            m_last_freq = (static_cast<FreqSample>(phase[i]) * static_cast<FreqSample>(m_sample_rate)) /
+                          static_cast<FreqSample>(2.0 * std::numbers::pi);
+        }
+        output[i] = m_last_freq;
+    }
+
+    m_prev_i = prev_i;
+    m_prev_q = prev_q;
+}
+
+void FrequencyEstimator::process_block(const float* input_samples, FreqSample* output_frequencies, size_t count) {
+    if (count == 0) return;
+
+    // 1. 拼接线性工作区：[最近 N-1 个历史样本 | 本块 DC Blocker + AGC 输出]
+    const size_t history = m_buffer_size - 1;
+    if (m_block_buffer.size() < history + count) {
+        m_block_buffer.resize(history + count);
+        m_q_buffer.resize(count);
+    } else if (m_q_buffer.size() < count) {
+        m_q_buffer.resize(count);
+    }
+    float* work = m_block_buffer.data();
+    std::copy_n(&m_buffer[m_write_pos + 1], history, work);
+    for (size_t i = 0; i < count; ++i) {
+        work[history + i] = m_agc->process(m_dc_blocker.process(input_samples[i]));
+    }
+
+    // 2. 整块计算 Q 路：第 i 个输出的中心 (I 路) 样本位于 work[i + 组延迟]
+    const float* centers = work + m_group_delay;
+    simd::odd_antisymmetric_fir_block<HILBERT_HALF_TAPS>(m_coeffs.data(), centers, m_q_buffer.data(), count);
+
+    // 3. I/Q 差分鉴频
+    if (m_discriminator_mode == DiscriminatorMode::FAST_ATAN2) {
+        discriminate_block_fast(centers, m_q_buffer.data(), output_frequencies, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            output_frequencies[i] = discriminate(centers[i], m_q_buffer[i]);
+        }
+    }
+
+    // 4. 把最近 N 个样本写回镜像延迟线，写入位置归零
+    const float* tail = work + count - 1;
+    std::copy_n(tail, m_buffer_size, m_buffer.data());
+    std::copy_n(tail, m_buffer_size, m_buffer.data() + m_buffer_size);
+    m_write_pos = 0;
+}
+
+void FrequencyEstimator::process_into(std::span<const float> input, std::span<FreqSample> output) {
+    if (output.size() < input.size()) {
+        throw std::runtime_error("FrequencyEstimator: output buffer too small");
     }
-    return frequencies;
+    process_block(input.data(), output.data(), input.size());
 }
 
 // 映射函数保持不变
 uint8_t freq_to_pixel_value(double frequency) {
-    if (frequency < BLACK_FREQ) return 0;
-    if (frequency > WHITE_FREQ) return 255;
-    double normalized = (frequency - BLACK_FREQ) / FREQ_RANGE;
-    return static_cast<uint8_t>(std::clamp(normalized * 255.0, 0.0, 255.0));
+    // 与整行像素核共用同一实现，保证逐位一致
+    return simd::freq_to_pixel_scalar(frequency);
 }
 
 } // namespace sstv::dsp
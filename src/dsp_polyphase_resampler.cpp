@@ -0,0 +1,106 @@
+// src/dsp_polyphase_resampler.cpp
+#include "dsp_polyphase_resampler.h"
+#include "dsp_filters.h" // make_fir_coeffs
+#include "dsp_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric> // std::gcd
+#include <stdexcept>
+
+namespace sstv::dsp {
+
+    // 整数采样率及约分后的 L/M
+    static bool reduce_ratio(double input_rate, double output_rate, size_t& up, size_t& down) {
+        if (input_rate <= 0 || output_rate <= 0) return false;
+        if (std::abs(input_rate - std::round(input_rate)) > 1e-9 ||
+            std::abs(output_rate - std::round(output_rate)) > 1e-9) {
+            return false;
+        }
+
+        const auto in = static_cast<size_t>(std::llround(input_rate));
+        const auto out = static_cast<size_t>(std::llround(output_rate));
+        const size_t g = std::gcd(in, out);
+        up = out / g;
+        down = in / g;
+        return up <= PolyphaseResampler::MAX_INTERPOLATION;
+    }
+
+    bool PolyphaseResampler::is_supported(double input_rate, double output_rate) {
+        size_t up = 0, down = 0;
+        return reduce_ratio(input_rate, output_rate, up, down);
+    }
+
+    PolyphaseResampler::PolyphaseResampler(double input_rate, double output_rate, int output_tap_count,
+                                           double cutoff_freq_low, double cutoff_freq_high)
+        : m_next_output(0)
+    {
+        if (!reduce_ratio(input_rate, output_rate, m_up, m_down)) {
+            throw std::runtime_error("Polyphase resampler: unsupported rate ratio");
+        }
+        if (output_tap_count <= 0) {
+            throw std::runtime_error("Polyphase resampler: tap count must be positive");
+        }
+
+        // 每相抽头数：output_tap_count 个输出样本对应的输入样本数
+        m_taps_per_phase = static_cast<size_t>(std::ceil(output_tap_count * input_rate / output_rate));
+        const size_t prototype_len = m_up * m_taps_per_phase;
+
+        // 原型带通在上采样率下设计；零值插入使通带增益降为 1/L，用增益 L 补偿
+        // 高截止频率同时承担抗混叠，必须低于输出奈奎斯特频率
+        const double cutoff_high = std::min(cutoff_freq_high, output_rate / 2.0);
+        FilterCoefficients prototype = make_fir_coeffs(static_cast<int>(prototype_len), input_rate * m_up,
+                                                       cutoff_freq_low, cutoff_high, 60.0,
+                                                       static_cast<double>(m_up));
+
+        // 拆分相位并做时间反转，使每相都能与按时间正序排列的输入窗口做连续点积
+        const size_t K = m_taps_per_phase;
+        m_phase_taps.resize(prototype_len);
+        for (size_t p = 0; p < m_up; ++p) {
+            for (size_t k = 0; k < K; ++k) {
+                m_phase_taps[p * K + (K - 1 - k)] = static_cast<float>(prototype[p + k * m_up]);
+            }
+        }
+
+        m_history.assign(K - 1, 0.0f);
+    }
+
+    void PolyphaseResampler::reset() {
+        std::fill(m_history.begin(), m_history.end(), 0.0f);
+        m_next_output = 0;
+    }
+
+    size_t PolyphaseResampler::process_into(std::span<const float> input, std::span<float> output) {
+        if (input.empty()) return 0;
+        if (output.size() < max_output_size(input.size())) {
+            throw std::runtime_error("Polyphase resampler: output buffer too small");
+        }
+
+        // 1. 拼接线性工作区：[最近 K-1 个历史样本 | 输入块]
+        const size_t K = m_taps_per_phase;
+        const size_t history = K - 1;
+        const size_t count = input.size();
+        if (m_block_buffer.size() < history + count) {
+            m_block_buffer.resize(history + count);
+        }
+        float* work = m_block_buffer.data();
+        std::copy(m_history.begin(), m_history.end(), work);
+        std::copy(input.begin(), input.end(), work + history);
+
+        // 2. 只计算真正输出的样本：上采样时刻 t = i*L + p 对应输入样本 i、相位 p，
+        //    其窗口 work[i .. i + K - 1] 的最新样本即 input[i]
+        size_t produced = 0;
+        const size_t block_end = count * m_up;
+        for (; m_next_output < block_end; m_next_output += m_down) {
+            const size_t i = m_next_output / m_up;
+            const size_t p = m_next_output % m_up;
+            output[produced++] = simd::dot_product(&m_phase_taps[p * K], work + i, K);
+        }
+        m_next_output -= block_end;
+
+        // 3. 保存最近 K-1 个样本作为下一块的历史
+        std::copy_n(work + count, history, m_history.begin());
+        return produced;
+    }
+
+} // namespace sstv::dsp
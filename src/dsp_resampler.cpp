@@ -28,30 +28,35 @@ namespace sstv::dsp {
     std::vector<float> Resampler::process_block(const float* input, size_t count) {
         if (count == 0) return {};
 
-        // 1. 预估输出大小（考虑到 ratio 和内部缓存，稍微多分配一点空间）
-        size_t expected_output_count = static_cast<size_t>(count * m_ratio) + 128;
-        std::vector<float> output(expected_output_count);
+        // 预估输出大小（考虑到 ratio 和内部缓存，稍微多分配一点空间）
+        std::vector<float> output(max_output_size(count));
+        output.resize(process_into({input, count}, output));
+        return output;
+    }
+
+    size_t Resampler::process_into(std::span<const float> input, std::span<float> output) {
+        if (input.empty()) return 0;
+        if (output.size() < max_output_size(input.size())) {
+            throw std::runtime_error("SRC Error: output buffer too small");
+        }
 
-        // 2. 填充数据结构
+        // 1. 填充数据结构
         SRC_DATA data;
-        data.data_in = input;
+        data.data_in = input.data();
         data.data_out = output.data();
-        data.input_frames = static_cast<long>(count);
-        data.output_frames = static_cast<long>(expected_output_count);
+        data.input_frames = static_cast<long>(input.size());
+        data.output_frames = static_cast<long>(output.size());
         data.src_ratio = m_ratio;
         data.end_of_input = 0; // 流处理模式，设为 0
 
-        // 3. 执行转换
+        // 2. 执行转换
         m_error = src_process(m_src_state, &data);
         if (m_error != 0) {
             throw std::runtime_error("SRC Process Error: " + std::string(src_strerror(m_error)));
         }
 
-        // 4. 根据实际产生的样本数调整 vector 大小
-        // data.output_frames_gen 是库实际写入 data_out 的样本数
-        output.resize(data.output_frames_gen);
-
-        return output;
+        // 3. data.output_frames_gen 是库实际写入 data_out 的样本数
+        return static_cast<size_t>(data.output_frames_gen);
     }
 
 } // namespace sstv::dsp
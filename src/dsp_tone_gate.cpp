@@ -0,0 +1,92 @@
+// src/dsp_tone_gate.cpp
+#include "dsp_tone_gate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace sstv::dsp {
+
+ToneGate::ToneGate(double sample_rate, double center_freq, double half_span,
+                   float purity_threshold, float energy_floor)
+    : m_purity_threshold(purity_threshold), m_energy_floor(energy_floor)
+{
+    if (sample_rate <= 0 || half_span < 0 || center_freq + half_span >= sample_rate / 2.0) {
+        throw std::runtime_error("Tone gate: invalid frequency range");
+    }
+
+    // 频点间隔取半个分辨率 fs / (2N)
+    const double spacing = sample_rate / (2.0 * BLOCK_SIZE);
+    const int half_bins = static_cast<int>(std::ceil(half_span / spacing));
+    for (int k = -half_bins; k <= half_bins; ++k) {
+        const double w = 2.0 * std::numbers::pi * (center_freq + k * spacing) / sample_rate;
+        m_coeffs.push_back(static_cast<float>(2.0 * std::cos(w)));
+    }
+    m_s1.assign(m_coeffs.size(), 0.0f);
+    m_s2.assign(m_coeffs.size(), 0.0f);
+}
+
+void ToneGate::reset() {
+    std::fill(m_s1.begin(), m_s1.end(), 0.0f);
+    std::fill(m_s2.begin(), m_s2.end(), 0.0f);
+    m_energy = 0.0f;
+    m_position = 0;
+    m_consecutive = 0;
+}
+
+bool ToneGate::process(std::span<const float> input) {
+    const size_t bins = m_coeffs.size();
+    const float* coeffs = m_coeffs.data();
+    float* s1 = m_s1.data();
+    float* s2 = m_s2.data();
+
+    bool detected = false;
+    size_t i = 0;
+    while (i < input.size()) {
+        // 非分析块直接跳过，不做任何逐样本运算
+        if (m_position >= BLOCK_SIZE) {
+            const size_t skip = std::min(DUTY_CYCLE * BLOCK_SIZE - m_position, input.size() - i);
+            i += skip;
+            m_position += skip;
+            if (m_position == DUTY_CYCLE * BLOCK_SIZE) m_position = 0;
+            continue;
+        }
+
+        // 分析块：各频点互相独立，内层按频点循环便于编译器向量化
+        const size_t n = std::min(BLOCK_SIZE - m_position, input.size() - i);
+        for (size_t j = 0; j < n; ++j) {
+            const float x = input[i + j];
+            m_energy += x * x;
+            for (size_t k = 0; k < bins; ++k) {
+                const float s0 = x + coeffs[k] * s1[k] - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+        i += n;
+        m_position += n;
+        if (m_position == BLOCK_SIZE) detected |= finish_block();
+    }
+    return detected;
+}
+
+bool ToneGate::finish_block() {
+    // |X_k|^2 = s1^2 + s2^2 - 2cos(w) s1 s2；纯度 = |X_k|^2 / (N/2 * 块能量)
+    float peak = 0.0f;
+    for (size_t k = 0; k < m_coeffs.size(); ++k) {
+        peak = std::max(peak, m_s1[k] * m_s1[k] + m_s2[k] * m_s2[k] - m_coeffs[k] * m_s1[k] * m_s2[k]);
+    }
+    const float energy = m_energy;
+
+    std::fill(m_s1.begin(), m_s1.end(), 0.0f);
+    std::fill(m_s2.begin(), m_s2.end(), 0.0f);
+    m_energy = 0.0f;
+
+    const bool tonal = energy >= m_energy_floor * BLOCK_SIZE &&
+                       peak >= m_purity_threshold * (BLOCK_SIZE / 2.0f) * energy;
+    m_consecutive = tonal ? m_consecutive + 1 : 0;
+    return m_consecutive >= CONFIRM_BLOCKS;
+}
+
+} // namespace sstv::dsp
@@ -1,103 +1,183 @@
 // src/main.cpp
+#include "sstv_audio_file.h"
 #include "sstv_decoder.h"
+#include "sstv_freq_track.h"
+#include "sstv_image_writer.h"
 #include "sstv_types.h"
 #include <iostream>
 #include <fstream>
-#include <vector>
+#include <memory>
+#include <string>
 #include <chrono>
 
 using namespace sstv;
 
-// --- 全局变量用于存储图像 ---
-const int PD120_WIDTH = 640;
-const int PD120_HEIGHT = 496;
-std::vector<Pixel> g_image_buffer; // 存储整个图像的像素
+// --- 全局变量 ---
+std::string g_output_path = "output.raw";
+std::string g_trace_path;
+std::string g_track_path;
+bool g_image_complete = false;
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <input.wav|input.raw|input.s16|input.sft> [-r sample_rate] [-f f32|s16] [-o output.raw] [-t trace.csv] [-w track.sft] [-q] [-L|-T]\n"
+              << "  -r  Sample rate of raw input (default 44100; WAV files use their header)\n"
+              << "  -f  Sample type of raw input (default: by extension, .s16/.pcm = int16, otherwise float32)\n"
+              << "  -o  Output file for decoded images (default output.raw): .png writes PNG, anything else raw RGB;\n"
+              << "      \"{}\" in the name is replaced by the image number, otherwise each image overwrites the last\n"
+              << "  -t  Dump the per-sample state trace as CSV if no image was completed\n"
+              << "      (needs a build with -DSSTV_ENABLE_TRACE=ON)\n"
+              << "  -w  Save the frequency track for fast re-decoding; pass the .sft file as input to replay it\n"
+              << "  -q  Quantize the saved frequency track to int16 (half the size)\n"
+              << "  -L  Low-latency processing (small tiles, immediate line callbacks)\n"
+              << "  -T  Throughput processing (L2-sized tiles, line callbacks per tile)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    double sample_rate = 44100;
+    SampleFormat raw_format = SampleFormat::AUTO;
+    TrackEncoding track_encoding = TrackEncoding::FLOAT32;
+    ProcessingMode processing_mode = ProcessingMode::BALANCED;
+    const char* filename = nullptr;
+
+    // --- 解析命令行参数 ---
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-r" || arg == "-f" || arg == "-o" || arg == "-t" || arg == "-w") && i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (arg == "-r") {
+            sample_rate = std::stod(argv[++i]);
+        } else if (arg == "-f") {
+            std::string fmt = argv[++i];
+            if (fmt == "f32") raw_format = SampleFormat::FLOAT32;
+            else if (fmt == "s16") raw_format = SampleFormat::INT16;
+            else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-o") {
+            g_output_path = argv[++i];
+        } else if (arg == "-t") {
+            g_trace_path = argv[++i];
+        } else if (arg == "-w") {
+            g_track_path = argv[++i];
+        } else if (arg == "-q") {
+            track_encoding = TrackEncoding::INT16;
+        } else if (arg == "-L") {
+            processing_mode = ProcessingMode::LOW_LATENCY;
+        } else if (arg == "-T") {
+            processing_mode = ProcessingMode::THROUGHPUT;
+        } else if (arg == "-h" || arg == "--help" || filename) {
+            print_usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        } else {
+            filename = argv[i];
+        }
+    }
+    if (!filename) {
+        print_usage(argv[0]);
+        return 1;
+    }
 
-int main() {
-    float DEMO_SAMPLE_RATE = 44100;
+    // --- 打开输入：频率轨迹文件直接回放，否则作为音频文件（内存映射，按块读取，内存占用与录音长度无关） ---
+    std::unique_ptr<AudioFileReader> reader;
+    std::unique_ptr<FreqTrackReader> track;
+    std::unique_ptr<FreqTrackWriter> track_writer;
+    try {
+        if (FreqTrackReader::is_track_file(filename)) {
+            track = std::make_unique<FreqTrackReader>(filename);
+            sample_rate = track->sample_rate();
+            std::cout << "Opened frequency track " << filename << " (" << track->sample_count() << " samples @ "
+                      << sample_rate << " Hz, " << (track->encoding() == TrackEncoding::INT16 ? "int16" : "float32")
+                      << ")." << std::endl;
+        } else {
+            reader = std::make_unique<AudioFileReader>(filename, raw_format);
+            if (reader->is_wav()) {
+                sample_rate = reader->sample_rate();
+            }
+            std::cout << "Opened " << filename << " (" << reader->frame_count() << " samples @ " << sample_rate << " Hz, "
+                      << (reader->is_wav() ? "WAV" : "raw") << " "
+                      << (reader->format() == SampleFormat::INT16 ? "int16" : "float32") << ")." << std::endl;
+        }
+        if (!g_track_path.empty()) {
+            track_writer = std::make_unique<FreqTrackWriter>(g_track_path, Decoder::INTERNAL_SAMPLE_RATE, track_encoding);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-    // 预先分配内存大小
-    g_image_buffer.resize(PD120_WIDTH * PD120_HEIGHT);
+    // 图像输出在后台线程完成（PNG 逐行压缩 / raw 写入内存映射文件），不占用解码线程
+    // 输入是文件而不是实时信号：队列满时让解码线程等待，而不是丢行
+    ImageWriter image_writer(g_output_path, ImageWriter::format_for_path(g_output_path));
+    image_writer.set_wait_when_full(true);
 
-    Decoder sstv_decoder(DEMO_SAMPLE_RATE);
+    Decoder sstv_decoder(sample_rate);
+    sstv_decoder.set_processing_mode(processing_mode);
+    sstv_decoder.set_freq_track_writer(track_writer.get());
+    sstv_decoder.set_image_writer(&image_writer);
 
     // 设置 Mode Detected 回调
     sstv_decoder.set_on_mode_detected_callback([](const SSTVMode& mode) {
         std::cout << "MAIN: Mode Detected! Name: " << mode.name << ", VIS: " << mode.vis_code << std::endl;
     });
 
-    // 设置 Line Decoded 回调：将每一行的像素数据复制到全局缓冲区
-    sstv_decoder.set_on_line_decoded_callback([](int line_idx, const std::vector<Pixel>& pixels) {
-        if (line_idx < PD120_HEIGHT && pixels.size() == PD120_WIDTH) {
-            // 计算在全局缓冲区中的偏移量
-            size_t offset = line_idx * PD120_WIDTH;
-
-            // 将当前行像素拷贝到全局缓冲区
-            // 使用 std::copy 或者 memcpy 都可以，因为是 POD 类型
-            std::copy(pixels.begin(), pixels.end(), g_image_buffer.begin() + offset);
-
-            // 可以在此处打印进度，例如每48行打印一次
-            if (line_idx % 48 == 0) {
-                std::cout << "Stored line " << line_idx << " to buffer." << std::endl;
-            }
-        } else {
-            std::cerr << "Warning: Line index or pixel count mismatch!" << std::endl;
+    // 设置 Line Decoded 回调：行像素已经交给 ImageWriter，这里只打印进度
+    sstv_decoder.set_on_line_decoded_callback([](int line_idx, std::span<const Pixel>) {
+        // 每48行打印一次
+        if (line_idx % 48 == 0) {
+            std::cout << "Decoded line " << line_idx << "." << std::endl;
         }
     });
 
-    // 设置 Image Complete 回调：保存为 .raw 文件
+    // 设置 Image Complete 回调：文件由 ImageWriter 在最后一行编码完成后写好
     sstv_decoder.set_on_image_complete_callback([](int width, int height) {
         std::cout << "MAIN: Image Complete! " << width << "x" << height << std::endl;
-        std::cout << "Saving image to 'output.raw'..." << std::endl;
-
-        std::ofstream outfile("output.raw", std::ios::binary | std::ios::out);
-        if (outfile.is_open()) {
-            // 直接写入内存中的二进制数据
-            // Pixel 结构体是 {uint8_t r, g, b}，占 3 字节
-            outfile.write(reinterpret_cast<const char*>(g_image_buffer.data()),
-                         g_image_buffer.size() * sizeof(Pixel));
-            outfile.close();
-            std::cout << "File saved successfully." << std::endl;
-        } else {
-            std::cerr << "Error: Could not open output.raw for writing." << std::endl;
-        }
+        g_image_complete = true;
     });
 
-    // --- 模拟传输 (读取音频文件) ---
-    std::vector<float> full_audio_signal;
-    const char* filename = R"(D:\C-Codes\Radio-HAM\sstv-toolkit\test_results\raw_files\snr_4dB.raw)";
-
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open: " << filename << std::endl;
-        return 1;
-    }
-
-    std::streamsize file_size = file.tellg();
-    std::size_t num_samples = file_size / sizeof(float);
+    // 实时处理模拟：数据块直接来自映射的文件页（或一个复用的转换缓冲区），块大小随处理模式而定
+    const size_t chunk_size = sstv_decoder.preferred_block_size();
+    std::cout << "\nStarting SSTV Demodulation...\n" << std::endl;
 
-    file.seekg(0, std::ios::beg);
-    full_audio_signal.resize(num_samples);
-    if (!file.read(reinterpret_cast<char*>(full_audio_signal.data()), file_size)) {
-        std::cerr << "Failed to read file data" << std::endl;
+    try {
+        if (track) {
+            // 跳过重采样、带通与鉴频，直接驱动 VIS / PD 状态机
+            sstv_decoder.replay(*track);
+        } else {
+            for (auto block = reader->next_block(chunk_size); !block.empty(); block = reader->next_block(chunk_size)) {
+                sstv_decoder.process(block.data(), block.size());
+            }
+            sstv_decoder.flush();
+        }
+        // 等待后台线程写完所有图像
+        image_writer.flush();
+        if (image_writer.images_written() > 0) {
+            std::cout << "Saved " << image_writer.images_written() << " image(s) to '" << g_output_path << "'." << std::endl;
+        }
+        if (track_writer) {
+            track_writer->close();
+            std::cout << "Frequency track saved to '" << g_track_path << "' (" << track_writer->samples_written()
+                      << " samples)." << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-    else {
-        std::cout << "Read data completed (" << num_samples << " samples)." << std::endl;
-    }
-    file.close();
-
-    // 实时处理模拟
-    const size_t chunk_size = 1024;
-    std::cout << "\nStarting SSTV Demodulation...\n" << std::endl;
 
-    for (size_t i = 0; i < full_audio_signal.size(); i += chunk_size) {
-        size_t current_chunk_size = std::min(chunk_size, full_audio_signal.size() - i);
-        if (current_chunk_size == 0) break;
+    std::cout << "\nSimulation Complete." << std::endl;
 
-        sstv_decoder.process(full_audio_signal.data() + i, current_chunk_size);
+    // 解码失败时导出最近的逐样本跟踪记录，便于定位卡在哪个状态
+    if (!g_trace_path.empty() && !g_image_complete) {
+        if (!TRACE_ENABLED) {
+            std::cerr << "Trace requested, but this build was configured without SSTV_ENABLE_TRACE." << std::endl;
+        } else if (std::ofstream trace_file(g_trace_path); trace_file) {
+            sstv_decoder.dump_trace(trace_file);
+            std::cout << "No complete image, trace written to '" << g_trace_path << "'." << std::endl;
+        } else {
+            std::cerr << "Error: Could not open " << g_trace_path << " for writing." << std::endl;
+        }
     }
-
-    std::cout << "\nSimulation Complete." << std::endl;
     return 0;
 }
@@ -0,0 +1,376 @@
+#include "sstv_audio_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace sstv {
+
+namespace {
+
+// WAV is little-endian regardless of the host
+uint16_t read_le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+SampleFormat format_from_extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return SampleFormat::FLOAT32;
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == "s16" || ext == "pcm") return SampleFormat::INT16;
+    return SampleFormat::FLOAT32;
+}
+
+size_t page_size() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// MappedFile
+// ---------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open: " + path);
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to stat: " + path);
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) return; // Empty files cannot be mapped
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (m_mapping) CloseHandle(m_mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map: " + path);
+    }
+    m_data = static_cast<const uint8_t*>(view);
+}
+
+MappedFile::MappedFile(const std::string& path, size_t size) : m_size(size), m_writable(true) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to create: " + path);
+    }
+    m_file = file;
+    if (m_size == 0) return;
+
+    // Mapping past the end of the file extends it (with zeros) to the mapping size
+    const uint64_t size64 = static_cast<uint64_t>(size);
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                   static_cast<DWORD>(size64 & 0xFFFFFFFFu), nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (m_mapping) CloseHandle(m_mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map: " + path);
+    }
+    m_data = static_cast<const uint8_t*>(view);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        throw std::runtime_error("Failed to open: " + path);
+    }
+
+    struct stat st {};
+    if (::fstat(m_fd, &st) != 0) {
+        ::close(m_fd);
+        throw std::runtime_error("Failed to stat: " + path);
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) return; // Empty files cannot be mapped
+
+    void* view = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(m_fd);
+        throw std::runtime_error("Failed to map: " + path);
+    }
+    ::madvise(view, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(view);
+}
+
+MappedFile::MappedFile(const std::string& path, size_t size) : m_size(size), m_writable(true) {
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        throw std::runtime_error("Failed to create: " + path);
+    }
+    // The file grows as a hole: pages read as zeros and get disk blocks only when written
+    if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        ::close(m_fd);
+        throw std::runtime_error("Failed to resize: " + path);
+    }
+    if (m_size == 0) return;
+
+    void* view = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(m_fd);
+        throw std::runtime_error("Failed to map: " + path);
+    }
+    m_data = static_cast<const uint8_t*>(view);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) ::munmap(const_cast<uint8_t*>(m_data), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+#endif
+
+void MappedFile::release(size_t offset, size_t length) {
+    if (!m_data || length == 0) return;
+
+    // Only whole pages inside the range can be dropped
+    const size_t page = page_size();
+    const size_t begin = (offset + page - 1) / page * page;
+    const size_t end = std::min(offset + length, m_size) / page * page;
+    if (end <= begin) return;
+
+#ifdef _WIN32
+    // Unlocking pages that were never locked removes them from the working set
+    VirtualUnlock(const_cast<uint8_t*>(m_data + begin), end - begin);
+#else
+    ::madvise(const_cast<uint8_t*>(m_data + begin), end - begin, MADV_DONTNEED);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// AudioFileReader
+// ---------------------------------------------------------------------------
+
+AudioFileReader::AudioFileReader(const std::string& path, SampleFormat format) {
+    size_t file_size = 0;
+    try {
+        m_mapped = std::make_unique<MappedFile>(path);
+        file_size = m_mapped->size();
+    } catch (const std::runtime_error&) {
+        // Mapping unavailable (or the file is missing): fall back to buffered reads
+        m_mapped.reset();
+        m_stream.open(path, std::ios::binary | std::ios::ate);
+        if (!m_stream.is_open()) {
+            throw std::runtime_error("Failed to open: " + path);
+        }
+        file_size = static_cast<size_t>(m_stream.tellg());
+    }
+
+    parse_wav_header(file_size);
+    if (!m_is_wav) {
+        m_format = (format == SampleFormat::AUTO) ? format_from_extension(path) : format;
+        m_channels = 1;
+        m_bytes_per_sample = (m_format == SampleFormat::INT16) ? sizeof(int16_t) : sizeof(float);
+        m_frame_stride = m_bytes_per_sample;
+        m_data_offset = 0;
+        m_frame_count = file_size / m_frame_stride;
+    }
+}
+
+AudioFileReader::~AudioFileReader() = default;
+
+void AudioFileReader::read_bytes(size_t offset, void* dst, size_t length) {
+    if (m_mapped) {
+        if (offset + length > m_mapped->size()) {
+            throw std::runtime_error("Read past end of file");
+        }
+        std::memcpy(dst, m_mapped->data() + offset, length);
+        return;
+    }
+
+    m_stream.clear();
+    m_stream.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    if (!m_stream.read(static_cast<char*>(dst), static_cast<std::streamsize>(length))) {
+        throw std::runtime_error("Failed to read file data");
+    }
+}
+
+void AudioFileReader::parse_wav_header(size_t file_size) {
+    if (file_size < 12) return;
+
+    uint8_t riff[12];
+    read_bytes(0, riff, sizeof(riff));
+    if (std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) return;
+
+    bool have_fmt = false;
+    uint16_t format_tag = 0;
+    uint16_t bits_per_sample = 0;
+    uint16_t block_align = 0;
+
+    size_t offset = 12;
+    while (offset + 8 <= file_size) {
+        uint8_t chunk[8];
+        read_bytes(offset, chunk, sizeof(chunk));
+        const size_t body = offset + 8;
+        size_t chunk_size = read_le32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size < 16) {
+                throw std::runtime_error("Malformed WAV fmt chunk");
+            }
+            uint8_t fmt[40] = {};
+            read_bytes(body, fmt, std::min<size_t>(chunk_size, sizeof(fmt)));
+            format_tag = read_le16(fmt);
+            m_channels = read_le16(fmt + 2);
+            m_sample_rate = read_le32(fmt + 4);
+            block_align = read_le16(fmt + 12);
+            bits_per_sample = read_le16(fmt + 14);
+            // WAVE_FORMAT_EXTENSIBLE: the real tag is the first two bytes of the sub-format GUID
+            if (format_tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 26) {
+                format_tag = read_le16(fmt + 24);
+            }
+            have_fmt = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                throw std::runtime_error("WAV data chunk before fmt chunk");
+            }
+            // Streaming writers leave the size at 0 / 0xFFFFFFFF; also tolerate truncated files
+            if (chunk_size == 0 || chunk_size == 0xFFFFFFFFu || body + chunk_size > file_size) {
+                chunk_size = file_size - body;
+            }
+
+            if (format_tag == WAVE_FORMAT_PCM && bits_per_sample == 16) {
+                m_format = SampleFormat::INT16;
+            } else if (format_tag == WAVE_FORMAT_IEEE_FLOAT && bits_per_sample == 32) {
+                m_format = SampleFormat::FLOAT32;
+            } else {
+                throw std::runtime_error("Unsupported WAV encoding (only 16-bit PCM and 32-bit float)");
+            }
+            m_bytes_per_sample = bits_per_sample / 8;
+            if (m_channels < 1 || block_align < m_channels * m_bytes_per_sample) {
+                throw std::runtime_error("Malformed WAV fmt chunk");
+            }
+
+            m_is_wav = true;
+            m_frame_stride = block_align;
+            m_data_offset = body;
+            m_frame_count = chunk_size / m_frame_stride;
+            return;
+        }
+
+        // Chunks are word-aligned
+        offset = body + chunk_size + (chunk_size & 1);
+    }
+
+    throw std::runtime_error("WAV file has no data chunk");
+}
+
+void AudioFileReader::convert(const uint8_t* src, float* dst, size_t frames) const {
+    // Only the first channel is decoded
+    if (m_format == SampleFormat::INT16) {
+        for (size_t i = 0; i < frames; ++i, src += m_frame_stride) {
+            dst[i] = static_cast<int16_t>(read_le16(src)) / 32768.0f;
+        }
+    } else {
+        for (size_t i = 0; i < frames; ++i, src += m_frame_stride) {
+            dst[i] = std::bit_cast<float>(read_le32(src));
+        }
+    }
+}
+
+std::span<const float> AudioFileReader::contiguous() const {
+    if (!m_mapped || m_format != SampleFormat::FLOAT32 || m_frame_stride != sizeof(float) ||
+        std::endian::native != std::endian::little) {
+        return {};
+    }
+    const uint8_t* data = m_mapped->data() + m_data_offset;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) return {};
+    return {reinterpret_cast<const float*>(data), m_frame_count};
+}
+
+std::span<const float> AudioFileReader::next_block(size_t max_frames) {
+    size_t frames = std::min(max_frames, m_frame_count - m_position);
+    if (frames == 0) return {};
+
+    const size_t offset = m_data_offset + m_position * m_frame_stride;
+    std::span<const float> block;
+
+    if (m_mapped) {
+        // Drop pages that lie wholly behind this block
+        const size_t consumed = offset - m_data_offset;
+        if (consumed - m_released_bytes >= RELEASE_GRANULARITY) {
+            m_mapped->release(m_data_offset + m_released_bytes, consumed - m_released_bytes);
+            m_released_bytes = consumed;
+        }
+
+        const std::span<const float> whole = contiguous();
+        if (!whole.empty()) {
+            block = whole.subspan(m_position, frames);
+        } else {
+            m_block_buffer.resize(frames);
+            convert(m_mapped->data() + offset, m_block_buffer.data(), frames);
+            block = m_block_buffer;
+        }
+    } else {
+        // Bounded read-ahead: never buffer more than READ_AHEAD_BYTES of file data
+        frames = std::min(frames, std::max<size_t>(1, READ_AHEAD_BYTES / m_frame_stride));
+        m_read_buffer.resize(frames * m_frame_stride);
+        read_bytes(offset, m_read_buffer.data(), m_read_buffer.size());
+        m_block_buffer.resize(frames);
+        convert(m_read_buffer.data(), m_block_buffer.data(), frames);
+        block = m_block_buffer;
+    }
+
+    m_position += frames;
+    return block;
+}
+
+void AudioFileReader::rewind() {
+    m_position = 0;
+    m_released_bytes = 0;
+}
+
+} // namespace sstv
@@ -0,0 +1,301 @@
+#include "sstv_batch_decoder.h"
+#include "sstv_audio_file.h"
+#include "sstv_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace sstv {
+
+namespace {
+
+// Preamble (8 x 100 ms) + leader / break / leader + start, 7 data, parity and stop bits
+constexpr double VIS_HEADER_DURATION_MS =
+    8 * 100.0 + 2 * VIS_LEADER_BURST_DURATION_MS + VIS_BREAK_DURATION_MS + 10 * VIS_BIT_DURATION_MS;
+
+// Extra audio kept around each segment so timing slop never clips the VIS or the last lines
+constexpr double SEGMENT_LEAD_IN_S = 1.0;
+constexpr double SEGMENT_TAIL_S = 2.0;
+constexpr double SEGMENT_DURATION_SLACK = 1.05;
+
+// Fraction of a detected image's duration the scan skips before hunting for the next VIS
+constexpr double SCAN_SKIP_FRACTION = 0.9;
+
+struct VisHit {
+    SSTVMode mode;
+    size_t data_offset;  // Input-rate sample index where the VIS header ended
+};
+
+// Tone gate in front of the scan (see dsp::ToneGate): the full chain only runs
+// from GATE_LOOKBACK_S before the first leader-tone energy until GATE_HOLD_S
+// after the last one with the VIS decoder idle
+constexpr double GATE_LOOKBACK_S = 0.5;
+constexpr double GATE_HOLD_S = 0.5;
+
+// VIS-only front end: everything the Decoder does before the image demodulator
+class VisScanner {
+public:
+    VisScanner(double sample_rate, const BatchDecodeOptions& options)
+        : m_sample_rate(sample_rate),
+          m_bandpass(Decoder::FIR_TAP_COUNT, Decoder::INTERNAL_SAMPLE_RATE, 300.0, 3000.0),
+          m_freq_estimator(Decoder::INTERNAL_SAMPLE_RATE, options.discriminator),
+          m_vis_decoder(Decoder::INTERNAL_SAMPLE_RATE, [this](const SSTVMode& mode) { m_detected = mode; })
+    {
+        // Same front-end selection as Decoder
+        if (std::abs(sample_rate - Decoder::INTERNAL_SAMPLE_RATE) > 1.0) {
+            if (options.resampler == dsp::ResamplerMode::POLYPHASE &&
+                dsp::PolyphaseResampler::is_supported(sample_rate, Decoder::INTERNAL_SAMPLE_RATE)) {
+                m_polyphase_resampler = std::make_unique<dsp::PolyphaseResampler>(
+                    sample_rate, Decoder::INTERNAL_SAMPLE_RATE, Decoder::FIR_TAP_COUNT, 300.0, 3000.0);
+            } else {
+                m_resampler = std::make_unique<dsp::Resampler>(sample_rate, Decoder::INTERNAL_SAMPLE_RATE);
+            }
+        }
+        // Runs on the raw input, so gated stretches skip resampling as well. Out-of-band
+        // noise lowers a tone's purity there, but the default threshold still passes
+        // every signal strong enough for the VIS decoder.
+        if (options.tone_gate) m_tone_gate = std::make_unique<dsp::ToneGate>(sample_rate, VIS_LEADER_BURST_FREQ);
+    }
+
+    std::vector<VisHit> scan(const float* samples, size_t count, size_t chunk_size) {
+        std::vector<VisHit> hits;
+        const size_t lookback = static_cast<size_t>(GATE_LOOKBACK_S * m_sample_rate);
+        const size_t hold = static_cast<size_t>(GATE_HOLD_S * m_sample_rate);
+
+        size_t pos = 0;                 // Next input sample for the full chain
+        size_t gate_pos = 0;            // Next input sample for the tone gate (never behind pos)
+        bool open = !m_tone_gate;
+        size_t idle = 0;                // Input samples since the last tone / VIS activity
+        while (pos < count) {
+            const size_t n = std::min(chunk_size, count - pos);
+
+            if (!open) {
+                // Closed: only the tone gate sees the input
+                const bool tone = m_tone_gate->process(std::span<const float>(samples + pos, n));
+                gate_pos = pos + n;
+                if (!tone) {
+                    pos = gate_pos;
+                    continue;
+                }
+                // Back up so the full chain sees the preamble the gate needed to confirm the tone
+                const size_t from = std::max(pos - std::min(pos, lookback), m_chain_pos);
+                if (from != m_chain_pos) seek(from);
+                pos = from;
+                open = true;
+                idle = 0;
+                continue;
+            }
+
+            // Chunks the gate has already seen lie within the look-back of a confirmed tone
+            bool tone = pos < gate_pos;
+            if (m_tone_gate && pos + n > gate_pos) {
+                tone = m_tone_gate->process(std::span<const float>(samples + gate_pos, pos + n - gate_pos)) || tone;
+                gate_pos = pos + n;
+            }
+
+            if (const std::optional<size_t> skip_to = scan_chunk(samples, count, pos, n, hits)) {
+                // No new transmission can start while this image is on air
+                seek(std::min(count, *skip_to));
+                pos = m_chain_pos;
+                gate_pos = pos;
+                if (m_tone_gate) m_tone_gate->reset();
+                open = !m_tone_gate;
+                continue;
+            }
+            pos += n;
+
+            if (m_tone_gate) {
+                idle = (tone || m_vis_decoder.state() != VISDecoder::State::IDLE) ? 0 : idle + n;
+                if (idle >= hold) open = false;
+            }
+        }
+        return hits;
+    }
+
+private:
+    // Full chain over input [pos, pos + n). Returns where to resume after a detected image.
+    std::optional<size_t> scan_chunk(const float* samples, size_t count, size_t pos, size_t n,
+                                     std::vector<VisHit>& hits) {
+        const double input_per_internal = m_sample_rate / Decoder::INTERNAL_SAMPLE_RATE;
+        std::span<const float> input(samples + pos, n);
+        if (m_polyphase_resampler) {
+            // Resampled output is already bandpass filtered
+            m_filtered.resize(m_polyphase_resampler->max_output_size(n));
+            m_filtered.resize(m_polyphase_resampler->process_into(input, m_filtered));
+            input = m_filtered;
+        } else {
+            if (m_resampler) {
+                m_resampled.resize(m_resampler->max_output_size(n));
+                input = std::span<const float>(m_resampled.data(), m_resampler->process_into(input, m_resampled));
+            }
+            m_filtered.resize(input.size());
+            m_bandpass.process_into(input, m_filtered);
+        }
+        m_frequencies.resize(m_filtered.size());
+        m_freq_estimator.process_into(m_filtered, m_frequencies);
+
+        for (size_t i = 0; i < input.size(); ++i) {
+            m_vis_decoder.process_frequency(m_frequencies[i]);
+            if (!m_detected) continue;
+
+            // Map the internal-rate position back onto the input timeline
+            size_t internal_idx = m_internal_samples + i + 1;
+            size_t data_offset = std::min(count, static_cast<size_t>(std::llround(internal_idx * input_per_internal)));
+            const SSTVMode mode = *m_detected;
+            m_detected.reset();
+            m_vis_decoder.reset();
+            if (mode.family != SSTVFamily::UNKNOWN && mode.duration_s > 0.0) {
+                hits.push_back({mode, data_offset});
+                return data_offset + static_cast<size_t>(mode.duration_s * SCAN_SKIP_FRACTION * m_sample_rate);
+            }
+        }
+
+        m_chain_pos = pos + n;
+        m_internal_samples += input.size();
+        return std::nullopt;
+    }
+
+    // Restart the front end cold at input sample `pos`
+    void seek(size_t pos) {
+        if (m_resampler) m_resampler->reset();
+        if (m_polyphase_resampler) m_polyphase_resampler->reset();
+        m_bandpass.clear();
+        m_freq_estimator.clear();
+        m_vis_decoder.reset();
+        m_chain_pos = pos;
+        m_internal_samples = static_cast<size_t>(std::llround(pos * Decoder::INTERNAL_SAMPLE_RATE / m_sample_rate));
+    }
+
+    double m_sample_rate;
+    std::unique_ptr<dsp::Resampler> m_resampler;
+    std::unique_ptr<dsp::PolyphaseResampler> m_polyphase_resampler;
+    dsp::FIRFilter m_bandpass;
+    dsp::FrequencyEstimator m_freq_estimator;
+    VISDecoder m_vis_decoder;
+    std::unique_ptr<dsp::ToneGate> m_tone_gate;
+    std::optional<SSTVMode> m_detected;
+    size_t m_chain_pos = 0;         // Input sample the chain state continues from
+    size_t m_internal_samples = 0;  // Internal-rate samples the chain has produced up to m_chain_pos
+
+    std::vector<float> m_resampled;
+    std::vector<float> m_filtered;
+    std::vector<FreqSample> m_frequencies;
+};
+
+// Decode one transmission from its own slice of the recording
+DecodedImage decode_segment(const float* samples, size_t count, double sample_rate,
+                            const VisHit& hit, const BatchDecodeOptions& options) {
+    const double header_samples = VIS_HEADER_DURATION_MS / 1000.0 * sample_rate;
+    const size_t start = static_cast<size_t>(std::max(0.0,
+        static_cast<double>(hit.data_offset) - header_samples - SEGMENT_LEAD_IN_S * sample_rate));
+    const size_t end = std::min(count, hit.data_offset +
+        static_cast<size_t>((hit.mode.duration_s * SEGMENT_DURATION_SLACK + SEGMENT_TAIL_S) * sample_rate));
+
+    DecodedImage image;
+    image.mode = hit.mode;
+    image.data_offset = hit.data_offset;
+    image.sample_offset = static_cast<size_t>(std::max(0.0, static_cast<double>(hit.data_offset) - header_samples));
+    image.width = hit.mode.width;
+    image.height = hit.mode.height;
+    image.pixels.assign(static_cast<size_t>(image.width) * image.height, Pixel{0, 0, 0});
+
+    Decoder decoder(sample_rate, options.resampler);
+    decoder.set_discriminator_mode(options.discriminator);
+
+    // Only the first transmission in the slice belongs to this hit
+    bool active = false;
+    bool finished = false;
+    decoder.set_on_mode_detected_callback([&](const SSTVMode& mode) {
+        if (!active && !finished && mode.vis_code == hit.mode.vis_code) active = true;
+    });
+    decoder.set_on_line_decoded_callback([&](int line_idx, std::span<const Pixel> pixels) {
+        if (!active || line_idx < 0 || line_idx >= image.height) return;
+        const size_t n = std::min(pixels.size(), static_cast<size_t>(image.width));
+        std::copy_n(pixels.begin(), n, image.pixels.begin() + static_cast<size_t>(line_idx) * image.width);
+        image.lines_decoded = std::max(image.lines_decoded, line_idx + 1);
+    });
+    decoder.set_on_image_complete_callback([&](int, int) {
+        if (!active) return;
+        image.complete = true;
+        active = false;
+        finished = true;
+    });
+
+    const size_t chunk_size = std::max<size_t>(1, options.chunk_size);
+    for (size_t pos = start; pos < end && !finished; pos += chunk_size) {
+        decoder.process(samples + pos, std::min(chunk_size, end - pos));
+    }
+    return image;
+}
+
+} // namespace
+
+std::vector<DecodedImage> decode_buffer(const float* samples, size_t count, double sample_rate,
+                                        const BatchDecodeOptions& options) {
+    if (count == 0) return {};
+
+    // 1. Tone-gated VIS scan over the whole buffer
+    VisScanner scanner(sample_rate, options);
+    const std::vector<VisHit> hits = scanner.scan(samples, count, std::max<size_t>(1, options.chunk_size));
+
+    // 2. Decode every detected segment in parallel
+    std::vector<DecodedImage> images(hits.size());
+    size_t thread_count = options.max_threads;
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, hits.size());
+
+    // A throw on any thread (bad_alloc, resampler setup, ...) stops the hand-out
+    // of further segments and is rethrown here once every thread has joined
+    std::atomic<size_t> next{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto worker = [&] {
+        try {
+            for (size_t idx = next.fetch_add(1); idx < hits.size(); idx = next.fetch_add(1)) {
+                images[idx] = decode_segment(samples, count, sample_rate, hits[idx], options);
+            }
+        } catch (...) {
+            next.store(hits.size());
+            std::lock_guard lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count > 0 ? thread_count - 1 : 0);
+    for (size_t t = 1; t < thread_count; ++t) threads.emplace_back(worker);
+    worker(); // The calling thread takes part as well
+    for (auto& th : threads) th.join();
+    if (error) std::rethrow_exception(error);
+
+    return images;
+}
+
+std::vector<DecodedImage> decode_file(const std::string& path, double sample_rate,
+                                      const BatchDecodeOptions& options) {
+    AudioFileReader reader(path);
+    if (reader.is_wav()) sample_rate = reader.sample_rate();
+
+    // Raw float32 mono recordings are decoded straight from the mapped pages
+    const std::span<const float> mapped = reader.contiguous();
+    if (!mapped.empty()) {
+        return decode_buffer(mapped.data(), mapped.size(), sample_rate, options);
+    }
+
+    // Everything else needs conversion; segments are decoded out of order, so keep the whole signal
+    std::vector<float> samples;
+    samples.reserve(reader.frame_count());
+    for (auto block = reader.next_block(); !block.empty(); block = reader.next_block()) {
+        samples.insert(samples.end(), block.begin(), block.end());
+    }
+    return decode_buffer(samples.data(), samples.size(), sample_rate, options);
+}
+
+} // namespace sstv
@@ -0,0 +1,133 @@
+#include "sstv_channelized_decoder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace sstv {
+
+namespace {
+
+// Smallest power of two that keeps the sub-channel spacing at or below max_spacing
+size_t choose_subchannel_count(double sample_rate, double max_spacing) {
+    if (sample_rate <= 0 || max_spacing <= 0) {
+        throw std::runtime_error("ChannelizedDecoder: sample rate and channel spacing must be positive");
+    }
+    return std::bit_ceil(static_cast<size_t>(std::ceil(sample_rate / max_spacing)));
+}
+
+// Largest decimation that still leaves room for the channel band below the
+// sub-channel Nyquist frequency; the channel decoders resample from there.
+// For an integer input rate only exact divisors are taken, so the channel
+// rate stays an integer the polyphase resampler can handle (48000 -> 8000).
+size_t choose_decimation(double sample_rate) {
+    constexpr double min_rate =
+        2.0 * (ChannelizedDecoder::CHANNEL_CENTER_HZ + ChannelizedDecoder::CHANNEL_STOPBAND_HZ);
+    const auto limit = static_cast<size_t>(std::max(1.0, std::floor(sample_rate / min_rate)));
+    if (std::abs(sample_rate - std::round(sample_rate)) > 1e-9) return limit;
+
+    const auto rate = static_cast<size_t>(std::llround(sample_rate));
+    for (size_t decimation = limit; decimation > 1; --decimation) {
+        if (rate % decimation == 0) return decimation;
+    }
+    return 1;
+}
+
+} // namespace
+
+ChannelizedDecoder::ChannelizedDecoder(double sample_rate, std::vector<double> offsets,
+                                       double max_channel_spacing, dsp::ResamplerMode resampler)
+    : m_channelizer(sample_rate, choose_subchannel_count(sample_rate, max_channel_spacing),
+                    choose_decimation(sample_rate), CHANNEL_CENTER_HZ, CHANNEL_PASSBAND_HZ, CHANNEL_STOPBAND_HZ),
+      m_stride(m_channelizer.max_output_size(MAX_BLOCK_SAMPLES))
+{
+    if (offsets.empty()) {
+        throw std::runtime_error("ChannelizedDecoder: no channel offsets given");
+    }
+
+    m_subchannels.reserve(offsets.size());
+    m_decoders.reserve(offsets.size());
+    for (size_t ch = 0; ch < offsets.size(); ++ch) {
+        m_subchannels.push_back(m_channelizer.channel_for_offset(offsets[ch]));
+
+        auto decoder = std::make_unique<Decoder>(m_channelizer.output_rate(), resampler);
+        // Forward per-decoder callbacks with the channel index attached
+        decoder->set_on_mode_detected_callback([this, ch](const SSTVMode& mode) {
+            if (m_on_mode_detected_cb) m_on_mode_detected_cb(ch, mode);
+        });
+        decoder->set_on_line_decoded_callback([this, ch](int line_idx, std::span<const Pixel> pixels) {
+            if (m_on_line_decoded_cb) m_on_line_decoded_cb(ch, line_idx, pixels);
+        });
+        decoder->set_on_image_complete_callback([this, ch](int width, int height) {
+            if (m_on_image_complete_cb) m_on_image_complete_cb(ch, width, height);
+        });
+        m_decoders.push_back(std::move(decoder));
+    }
+
+    m_channel_buffer.resize(m_decoders.size() * m_stride);
+}
+
+void ChannelizedDecoder::process(const float* samples, size_t count) {
+    while (count > 0) {
+        const size_t block = std::min(count, MAX_BLOCK_SAMPLES);
+        const size_t produced = m_channelizer.process_into({samples, block}, m_subchannels, m_channel_buffer, m_stride);
+        for (size_t ch = 0; ch < m_decoders.size(); ++ch) {
+            m_decoders[ch]->process(m_channel_buffer.data() + ch * m_stride, produced);
+        }
+        samples += block;
+        count -= block;
+    }
+}
+
+void ChannelizedDecoder::flush() {
+    for (auto& decoder : m_decoders) decoder->flush();
+}
+
+void ChannelizedDecoder::reset() {
+    m_channelizer.reset();
+    for (auto& decoder : m_decoders) decoder->reset();
+}
+
+double ChannelizedDecoder::channel_offset(size_t channel) const {
+    if (channel >= m_subchannels.size()) {
+        throw std::out_of_range("ChannelizedDecoder: channel index out of range");
+    }
+    return m_channelizer.channel_offset(m_subchannels[channel]);
+}
+
+double ChannelizedDecoder::signal_offset(size_t channel) const {
+    return channel_offset(channel) + decoder(channel).afc_offset();
+}
+
+Decoder& ChannelizedDecoder::decoder(size_t channel) {
+    if (channel >= m_decoders.size()) {
+        throw std::out_of_range("ChannelizedDecoder: channel index out of range");
+    }
+    return *m_decoders[channel];
+}
+
+const Decoder& ChannelizedDecoder::decoder(size_t channel) const {
+    if (channel >= m_decoders.size()) {
+        throw std::out_of_range("ChannelizedDecoder: channel index out of range");
+    }
+    return *m_decoders[channel];
+}
+
+void ChannelizedDecoder::set_tone_gate_enabled(bool enabled) {
+    for (auto& decoder : m_decoders) decoder->set_tone_gate_enabled(enabled);
+}
+
+void ChannelizedDecoder::set_vis_engine(VISEngine engine) {
+    for (auto& decoder : m_decoders) decoder->set_vis_engine(engine);
+}
+
+void ChannelizedDecoder::set_sync_mode(SyncMode mode) {
+    for (auto& decoder : m_decoders) decoder->set_sync_mode(mode);
+}
+
+void ChannelizedDecoder::set_image_timeout_lines(int lines) {
+    for (auto& decoder : m_decoders) decoder->set_image_timeout_lines(lines);
+}
+
+} // namespace sstv
@@ -1,11 +1,9 @@
 #include "sstv_decoder.h"
+#include "sstv_pd_demodulator.h"
 
 namespace sstv {
 
-constexpr int FIR_TAP_COUNT = 31; // Example tap count, adjust for desired filter quality
-constexpr double INTERNAL_SAMPLE_RATE = 11025.0; // Target sample rate for internal processing
-
-Decoder::Decoder(double sample_rate)
+Decoder::Decoder(double sample_rate, dsp::ResamplerMode resampler)
     : m_state(State::SEARCHING_VIS),
       m_sample_timer(0.0),
       m_sample_rate(sample_rate)
@@ -13,20 +11,28 @@ Decoder::Decoder(double sample_rate)
     // Initialize DSP components
     // Resampler
     if (std::abs(sample_rate - INTERNAL_SAMPLE_RATE) > 1.0) {
-        m_resampler = std::make_unique<dsp::Resampler>(sample_rate, INTERNAL_SAMPLE_RATE);
+        if (resampler == dsp::ResamplerMode::POLYPHASE &&
+            dsp::PolyphaseResampler::is_supported(sample_rate, INTERNAL_SAMPLE_RATE)) {
+            // Resample and bandpass in one stage
+            m_polyphase_resampler = std::make_unique<dsp::PolyphaseResampler>(
+                sample_rate, INTERNAL_SAMPLE_RATE, FIR_TAP_COUNT, 300.0, 3000.0);
+        } else {
+            m_resampler = std::make_unique<dsp::Resampler>(sample_rate, INTERNAL_SAMPLE_RATE);
+        }
         // std::cout << "Resampler initialized: " << sample_rate << "Hz -> " << INTERNAL_SAMPLE_RATE << "Hz" << std::endl;
     }
     // Bandpass for SSTV audio spectrum
     m_bandpass_filter = std::make_unique<dsp::FIRFilter>(FIR_TAP_COUNT, INTERNAL_SAMPLE_RATE, 300.0, 3000.0);
     m_freq_estimator = std::make_unique<dsp::FrequencyEstimator>(INTERNAL_SAMPLE_RATE);
+    m_fused_front_end = std::make_unique<FusedFrontEnd>(*m_bandpass_filter, *m_freq_estimator);
 
     // Initialize protocol components with internal callbacks
     m_vis_decoder = std::make_unique<VISDecoder>(INTERNAL_SAMPLE_RATE, 
         [this](const SSTVMode& mode){ handle_mode_detected(mode); });
-    
-    m_pd_demodulator = std::make_unique<PDDemodulator>(INTERNAL_SAMPLE_RATE,
-        [this](int line_idx, const std::vector<Pixel>& pixels){ handle_line_decoded(line_idx, pixels); },
-        [this](int width, int height){ handle_image_complete(width, height); });
+
+    if constexpr (TRACE_ENABLED) {
+        m_vis_decoder->set_trace(&m_trace);
+    }
 
     // Ensure initial state is reset
     reset();
@@ -37,51 +43,583 @@ Decoder::~Decoder() {
 }
 
 void Decoder::reset() {
-    m_state = State::SEARCHING_VIS;
-    m_current_mode = {}; // Clear current mode data
-
     m_bandpass_filter->clear();
     m_freq_estimator->clear();
     if (m_resampler) m_resampler->reset();
+    if (m_polyphase_resampler) m_polyphase_resampler->reset();
+
+    // A partial image is dropped silently; cancel_image() reports it
+    if (m_frame_manager) m_frame_manager->discard_frame();
+    if (m_image_writer) m_image_writer->discard_image();
+    m_staging.clear();
+    m_deferred_lines.clear();
+    m_deferred_pixels.clear();
+    restart_search();
+}
+
+void Decoder::restart_search() {
+    m_state = State::SEARCHING_VIS;
+    m_current_mode = {}; // Clear current mode data
+    m_cancel_requested = false;
 
     m_vis_decoder->reset();
-    m_pd_demodulator->reset();
-    
-    // std::cout << "SSTV Decoder reset. Searching for VIS..." << std::endl;
+    if (m_goertzel_vis) m_goertzel_vis->reset();
+    if (m_demodulator) m_demodulator->reset();
+    m_demodulator = nullptr;
+    reset_gate();
+}
+
+void Decoder::set_frame_manager_enabled(bool enabled, size_t slots) {
+    if (enabled && !m_frame_manager) {
+        m_frame_manager = std::make_unique<FrameManager>(slots);
+    }
+    m_frame_manager_enabled = enabled;
+}
+
+void Decoder::set_image_writer(ImageWriter* writer) {
+    if (m_image_writer && m_image_writer != writer) m_image_writer->discard_image();
+    m_image_writer = writer;
+}
+
+void Decoder::cancel_image() {
+    if (m_state != State::DECODING_IMAGE_DATA) return;
+    if (m_in_process) {
+        // Never tear the demodulator down underneath its own callback
+        m_cancel_requested = true;
+        return;
+    }
+    abandon_image(FrameStatus::CANCELLED);
+}
+
+void Decoder::begin_image() {
+    const int width = m_current_mode.width;
+    const int height = m_current_mode.height;
+    m_frame_info = FrameInfo{m_current_mode, width, height, 0, FrameStatus::COMPLETE, m_images_started++};
+
+    // Rows go straight into a managed slot when one is available
+    std::span<Pixel> frame = m_frame_buffer_enabled ? std::span<Pixel>(m_frame_buffer) : std::span<Pixel>();
+    if (m_frame_manager_enabled) {
+        const std::span<Pixel> slot = m_frame_manager->begin_frame(m_frame_info);
+        if (!slot.empty()) frame = slot;
+    }
+    m_demodulator->set_frame_buffer(frame);
+    if (m_image_writer) m_image_writer->begin_image(m_frame_info);
+
+    m_image_timeout_samples = m_image_timeout_lines * m_demodulator->line_samples();
+}
+
+void Decoder::abandon_image(FrameStatus status) {
+    (status == FrameStatus::TIMED_OUT ? m_stats.images_timed_out : m_stats.images_cancelled).add();
+    finish_image(status);
+    restart_search();
+}
+
+void Decoder::finish_image(FrameStatus status) {
+    flush_deferred_lines();
+    m_frame_info.lines_decoded = std::min(m_demodulator->lines_decoded(), m_frame_info.height);
+    m_frame_info.status = status;
+    if (m_frame_manager) m_frame_manager->publish_frame(m_frame_info.lines_decoded, status);
+    if (m_image_writer) m_image_writer->end_image(m_frame_info);
+    if (m_on_image_finished_cb) m_on_image_finished_cb(m_frame_info);
+}
+
+void Decoder::set_frame_buffer_enabled(bool enabled) {
+    if (enabled && m_frame_buffer.empty()) {
+        // One allocation for the lifetime of the decoder: room for the largest known mode
+        m_frame_buffer.assign(MAX_MODE_PIXELS, Pixel{0, 0, 0});
+    }
+    m_frame_buffer_enabled = enabled;
+
+    // The demodulator converts rows straight into the frame, no extra copy
+    if (m_demodulator) m_demodulator->set_frame_buffer(enabled ? std::span<Pixel>(m_frame_buffer) : std::span<Pixel>());
 }
 
 void Decoder::process(const float* samples, size_t count) {
-    const float* current_input = samples;
-    size_t current_count = count;
-    std::vector<float> resampled_storage;
+    m_stats.samples_processed.add(count);
+    m_in_process = true;
+    try {
+        process_tiles(std::span<const float>(samples, count));
+    } catch (...) {
+        m_in_process = false;
+        m_defer_lines = false;
+        throw;
+    }
+    m_in_process = false;
+
+    // Publish the offset the active stage is tracking (PD follows it per line sync)
+    m_stats.afc_offset.set(afc_offset());
+}
+
+void Decoder::replay(std::span<const float> filtered, std::span<const FreqSample> frequencies) {
+    if (filtered.size() != frequencies.size()) {
+        throw std::runtime_error("Replay: sample and frequency counts differ");
+    }
+    m_stats.samples_processed.add(filtered.size());
+    m_in_process = true;
+    try {
+        ScopedStageTimer timer(m_stats.state_machine_ns);
+        run_state_machine(filtered.data(), frequencies.data(), filtered.size());
+    } catch (...) {
+        m_in_process = false;
+        throw;
+    }
+    m_in_process = false;
+
+    m_stats.afc_offset.set(afc_offset());
+}
+
+void Decoder::replay(FreqTrackReader& track) {
+    if (track.sample_rate() != INTERNAL_SAMPLE_RATE) {
+        throw std::runtime_error("Replay: frequency track was not recorded at the internal sample rate");
+    }
+    for (auto chunk = track.next_chunk(); !chunk.empty(); chunk = track.next_chunk()) {
+        replay(chunk.samples, chunk.frequencies);
+    }
+}
+
+void Decoder::set_processing_mode(ProcessingMode mode) {
+    if (!m_in_process) flush();
+    m_processing_mode = mode;
+    m_tile_samples = 0;
+    if (mode == ProcessingMode::LOW_LATENCY) {
+        m_tile_samples = static_cast<size_t>(std::max(1.0, std::round(LOW_LATENCY_TILE_MS * m_sample_rate / 1000.0)));
+    } else if (mode == ProcessingMode::THROUGHPUT) {
+        m_tile_samples = static_cast<size_t>(std::ceil(THROUGHPUT_TILE_SAMPLES * m_sample_rate / INTERNAL_SAMPLE_RATE));
+        m_staging.reserve(m_tile_samples);
+        // A tile holds a handful of lines even in the fastest mode
+        m_deferred_lines.reserve(8);
+        m_deferred_pixels.reserve(8 * MAX_MODE_WIDTH);
+    }
+}
+
+size_t Decoder::preferred_block_size() const {
+    return m_tile_samples > 0 ? m_tile_samples : DEFAULT_BLOCK_SIZE;
+}
+
+void Decoder::flush() {
+    if (m_staging.empty() || m_in_process) return;
+    m_in_process = true;
+    try {
+        process_staged();
+    } catch (...) {
+        m_in_process = false;
+        m_defer_lines = false;
+        throw;
+    }
+    m_in_process = false;
+}
+
+void Decoder::process_staged() {
+    // Moved out so a reset() from a callback cannot clear the tile being decoded
+    std::vector<float> staged = std::move(m_staging);
+    process_tile(staged);
+    staged.clear();
+    m_staging = std::move(staged);  // Keeps the reserved capacity
+}
+
+void Decoder::process_tiles(std::span<const float> input) {
+    // Left over if the mode was switched from inside a callback
+    if (m_processing_mode != ProcessingMode::THROUGHPUT && !m_staging.empty()) process_staged();
+    switch (m_processing_mode) {
+        case ProcessingMode::BALANCED:
+            process_block(input);
+            break;
+        case ProcessingMode::LOW_LATENCY:
+            for (size_t offset = 0; offset < input.size(); offset += m_tile_samples) {
+                process_block(input.subspan(offset, std::min(m_tile_samples, input.size() - offset)));
+            }
+            break;
+        case ProcessingMode::THROUGHPUT: {
+            // Top up the staged partial tile first
+            if (!m_staging.empty()) {
+                const size_t n = std::min(m_tile_samples - m_staging.size(), input.size());
+                m_staging.insert(m_staging.end(), input.begin(), input.begin() + static_cast<std::ptrdiff_t>(n));
+                input = input.subspan(n);
+                if (m_staging.size() < m_tile_samples) return;
+                process_staged();
+            }
+            // Whole tiles straight from the caller's buffer, the remainder waits for the next call
+            for (; input.size() >= m_tile_samples; input = input.subspan(m_tile_samples)) {
+                process_tile(input.first(m_tile_samples));
+            }
+            m_staging.assign(input.begin(), input.end());
+            break;
+        }
+    }
+}
+
+void Decoder::process_tile(std::span<const float> tile) {
+    m_defer_lines = true;
+    process_block(tile);
+    m_defer_lines = false;
+    flush_deferred_lines();
+}
+
+void Decoder::flush_deferred_lines() {
+    // A callback may reset() the decoder, which drops the rest of the queue
+    for (size_t i = 0; i < m_deferred_lines.size(); ++i) {
+        const DeferredLine line = m_deferred_lines[i];
+        if (line.ready && m_on_line_ready_cb) m_on_line_ready_cb(line.line_index);
+        if (line.count > 0 && m_on_line_decoded_cb) {
+            m_on_line_decoded_cb(line.line_index, std::span<const Pixel>(m_deferred_pixels.data() + line.offset, line.count));
+        }
+    }
+    m_deferred_lines.clear();
+    m_deferred_pixels.clear();
+}
+
+void Decoder::process_block(std::span<const float> input) {
+    const size_t count = input.size();
+    bool prefiltered = false;
+
+    if (m_polyphase_resampler) {
+        // The polyphase decimator output is already bandpass filtered
+        ScopedStageTimer timer(m_stats.resampler_ns);
+        grow_scratch(m_filtered_buffer, m_polyphase_resampler->max_output_size(count));
+        const size_t generated = m_polyphase_resampler->process_into(input, m_filtered_buffer);
+        input = std::span<const float>(m_filtered_buffer.data(), generated);
+        prefiltered = true;
+    } else if (m_resampler) {
+        // --- 第一步：重采样 (如果需要) ---
+        ScopedStageTimer timer(m_stats.resampler_ns);
+        grow_scratch(m_resampled_buffer, m_resampler->max_output_size(count));
+        const size_t generated = m_resampler->process_into(input, m_resampled_buffer);
+        input = std::span<const float>(m_resampled_buffer.data(), generated);
+    }
+
+    if (input.empty()) return;
+    if (m_tone_gate_enabled && !gate_admits(input)) return;
+    run_front_end(input, prefiltered);
+}
+
+void Decoder::run_front_end(std::span<const float> input, bool prefiltered) {
+    if (m_vis_engine == VISEngine::GOERTZEL && m_state == State::SEARCHING_VIS) {
+        // The Goertzel search needs no discriminator, only the bandpass
+        if (!prefiltered) {
+            grow_scratch(m_filtered_buffer, input.size());
+            ScopedStageTimer timer(m_stats.bandpass_ns);
+            m_bandpass_filter->process_into(input, std::span<float>(m_filtered_buffer.data(), input.size()));
+            input = std::span<const float>(m_filtered_buffer.data(), input.size());
+        }
+        if (m_track_writer) {
+            // The search itself does not need the discriminator, but the track must be complete
+            grow_scratch(m_frequency_buffer, input.size());
+            std::span<FreqSample> estimated_frequencies(m_frequency_buffer.data(), input.size());
+            {
+                ScopedStageTimer timer(m_stats.estimator_ns);
+                m_freq_estimator->process_into(input, estimated_frequencies);
+            }
+            m_track_writer->append(input, estimated_frequencies);
+        }
+        search_goertzel_vis(input);
+        return;
+    }
+    const size_t count = input.size();
+
+    if (prefiltered) {
+        grow_scratch(m_frequency_buffer, count);
+        std::span<FreqSample> estimated_frequencies(m_frequency_buffer.data(), count);
+        {
+            ScopedStageTimer timer(m_stats.estimator_ns);
+            m_freq_estimator->process_into(input, estimated_frequencies);
+        }
+        if (m_track_writer) m_track_writer->append(input, estimated_frequencies);
 
-    // --- 第一步：重采样 (如果需要) ---
-    if (m_resampler) {
-        resampled_storage = m_resampler->process_block(samples, count);
-        current_input = resampled_storage.data();
-        current_count = resampled_storage.size();
+        ScopedStageTimer timer(m_stats.state_machine_ns);
+        run_state_machine(input.data(), estimated_frequencies.data(), count);
+        return;
     }
 
-    if (current_count == 0) return;
+    if (m_use_fused_pipeline || m_processing_mode == ProcessingMode::THROUGHPUT) {
+        // Bandpass, Hilbert/FM and the state machine run tile by tile while the
+        // intermediate data is still in L1; the result is identical to the path below
+        ScopedStageTimer timer(m_stats.fused_front_end_ns);
+        m_fused_front_end->process(input, [this](const float* filtered, const FreqSample* freqs, size_t n) {
+            if (m_track_writer) m_track_writer->append({filtered, n}, {freqs, n});
+            run_state_machine(filtered, freqs, n);
+        });
+        return;
+    }
 
-    std::vector<float> filtered_samples(current_count);
-    m_bandpass_filter->process_block(current_input, filtered_samples.data(), current_count);
+    // Scratch buffers are owned by the decoder and only ever grow, so the
+    // steady state performs no heap allocations
+    grow_scratch(m_filtered_buffer, count);
+    grow_scratch(m_frequency_buffer, count);
+    std::span<float> filtered_samples(m_filtered_buffer.data(), count);
+    std::span<FreqSample> estimated_frequencies(m_frequency_buffer.data(), count);
 
-    std::vector<double> estimated_frequencies = m_freq_estimator->process_block(filtered_samples.data(), current_count);
+    {
+        ScopedStageTimer timer(m_stats.bandpass_ns);
+        m_bandpass_filter->process_into(input, filtered_samples);
+    }
+    {
+        ScopedStageTimer timer(m_stats.estimator_ns);
+        m_freq_estimator->process_into(filtered_samples, estimated_frequencies);
+    }
+    if (m_track_writer) m_track_writer->append(filtered_samples, estimated_frequencies);
 
-    // // Debug freq output
-    // for (double freq : estimated_frequencies) {
-    //     std::cout << freq << ", ";
-    // }
-    // std::cout << std::endl;
-    // return;
+    ScopedStageTimer timer(m_stats.state_machine_ns);
+    run_state_machine(filtered_samples.data(), estimated_frequencies.data(), count);
+}
 
-    size_t n = std::min(estimated_frequencies.size(), filtered_samples.size());
-    for (size_t i = 0; i < n; ++i) {
-        double freq = estimated_frequencies[i];
-        float sample = filtered_samples[i];
+void Decoder::set_vis_engine(VISEngine engine) {
+    if (engine == VISEngine::GOERTZEL && !m_goertzel_vis) {
+        m_goertzel_vis = std::make_unique<GoertzelVISDecoder>(INTERNAL_SAMPLE_RATE,
+            [this](const SSTVMode& mode){ handle_mode_detected(mode); });
+        m_goertzel_vis_stats.store(m_goertzel_vis.get(), std::memory_order_release);
+    }
+    m_vis_engine = engine;
+    if (m_state == State::SEARCHING_VIS) {
+        // The FM engine relies on continuous filter histories, so start both from scratch
+        m_bandpass_filter->clear();
+        m_freq_estimator->clear();
+        m_vis_decoder->reset();
+        if (m_goertzel_vis) m_goertzel_vis->reset();
+    }
+}
+
+double Decoder::afc_offset() const {
+    return m_state == State::DECODING_IMAGE_DATA ? m_demodulator->get_afc_offset() : vis_afc_offset();
+}
+
+double Decoder::vis_afc_offset() const {
+    return m_vis_engine == VISEngine::GOERTZEL ? m_goertzel_vis->get_afc_offset() : m_vis_decoder->get_afc_offset();
+}
+
+bool Decoder::vis_idle() const {
+    return m_vis_engine == VISEngine::GOERTZEL ? m_goertzel_vis->idle()
+                                               : m_vis_decoder->state() == VISDecoder::State::IDLE;
+}
+
+void Decoder::search_goertzel_vis(std::span<const float> filtered) {
+    size_t consumed = 0;
+    bool detected;
+    {
+        ScopedStageTimer timer(m_stats.state_machine_ns);
+        detected = m_goertzel_vis->process(filtered, consumed);
+    }
+    // An unknown mode resets the decoder from inside the callback
+    if (!detected || m_state != State::DECODING_IMAGE_DATA) return;
+
+    // The discriminator has been idle: restart it on the history before the
+    // stop bit ended, then pass everything after the stop bit to the demodulator
+    const std::span<const float> handover = m_goertzel_vis->handover();
+    const std::span<const float> rest = filtered.subspan(consumed);
+    constexpr size_t warm_up = GoertzelVISDecoder::HANDOVER_HISTORY;
+    grow_scratch(m_frequency_buffer, std::max(handover.size(), rest.size()));
+    m_freq_estimator->clear();
+    const uint64_t image = m_images_started;
+    for (const std::span<const float> part : {handover, rest}) {
+        const size_t skip = part.data() == handover.data() ? warm_up : 0;
+        {
+            ScopedStageTimer timer(m_stats.estimator_ns);
+            m_freq_estimator->process_into(part, std::span<FreqSample>(m_frequency_buffer.data(), part.size()));
+        }
+        ScopedStageTimer timer(m_stats.state_machine_ns);
+        run_state_machine(part.data() + skip, m_frequency_buffer.data() + skip, part.size() - skip);
+        // A finished image restarts the search, which then owns the remaining samples
+        if (m_state != State::DECODING_IMAGE_DATA || m_images_started != image) break;
+    }
+}
+
+void Decoder::set_tone_gate_enabled(bool enabled) {
+    if (enabled && !m_tone_gate) {
+        m_tone_gate = std::make_unique<dsp::ToneGate>(INTERNAL_SAMPLE_RATE, VIS_LEADER_BURST_FREQ);
+        m_gate_lookback.assign(GATE_LOOKBACK_SAMPLES, 0.0f);
+        m_gate_replay.reserve(GATE_LOOKBACK_SAMPLES);
+    }
+    m_tone_gate_enabled = enabled;
+    reset_gate();
+}
+
+void Decoder::reset_gate() {
+    // Start open: whatever the full path has seen so far is continuous
+    m_gate_open = true;
+    m_gate_idle_samples = 0;
+    m_gate_skipped = 0;
+    m_gate_lookback_pos = 0;
+    if (m_tone_gate) m_tone_gate->reset();
+}
+
+bool Decoder::gate_admits(std::span<const float>& input) {
+    // Only the VIS search is gated; image data always runs at full rate
+    if (m_state != State::SEARCHING_VIS) return true;
+
+    const bool tone = m_tone_gate->process(input);
+    const size_t count = input.size();
+
+    if (m_gate_open) {
+        // Any tone, or a VIS header in progress, keeps the gate open
+        if (tone || !vis_idle()) {
+            m_gate_idle_samples = 0;
+        } else {
+            m_gate_idle_samples += count;
+        }
+        if (m_gate_idle_samples < static_cast<size_t>(GATE_HOLD_MS * INTERNAL_SAMPLE_RATE / 1000.0)) return true;
+
+        // This block still goes through the full path; skipping starts with the next one
+        m_gate_open = false;
+        m_gate_skipped = 0;
+        m_gate_lookback_pos = 0;
+        return true;
+    }
+
+    if (!tone) {
+        // Remember the most recent samples for the replay
+        const float* data = input.data();
+        size_t remaining = count;
+        if (remaining > GATE_LOOKBACK_SAMPLES) {
+            data += remaining - GATE_LOOKBACK_SAMPLES;
+            remaining = GATE_LOOKBACK_SAMPLES;
+        }
+        while (remaining > 0) {
+            const size_t n = std::min(remaining, GATE_LOOKBACK_SAMPLES - m_gate_lookback_pos);
+            std::copy_n(data, n, m_gate_lookback.begin() + static_cast<std::ptrdiff_t>(m_gate_lookback_pos));
+            m_gate_lookback_pos = (m_gate_lookback_pos + n) % GATE_LOOKBACK_SAMPLES;
+            data += n;
+            remaining -= n;
+        }
+        m_gate_skipped += count;
+        m_stats.gated_samples.add(count);
+        return false;
+    }
+
+    // Tone found: replay the look-back (oldest first), then the current block
+    const size_t replay = std::min(m_gate_skipped, GATE_LOOKBACK_SAMPLES);
+    if (m_gate_skipped > GATE_LOOKBACK_SAMPLES) {
+        // Samples were dropped, the filter histories no longer line up
+        m_bandpass_filter->clear();
+        m_freq_estimator->clear();
+        m_vis_decoder->reset();
+        if (m_goertzel_vis) m_goertzel_vis->reset();
+    }
+    m_gate_replay.clear();
+    const size_t first = (m_gate_lookback_pos + GATE_LOOKBACK_SAMPLES - replay) % GATE_LOOKBACK_SAMPLES;
+    const size_t head = std::min(replay, GATE_LOOKBACK_SAMPLES - first);
+    m_gate_replay.insert(m_gate_replay.end(), m_gate_lookback.begin() + static_cast<std::ptrdiff_t>(first),
+                         m_gate_lookback.begin() + static_cast<std::ptrdiff_t>(first + head));
+    m_gate_replay.insert(m_gate_replay.end(), m_gate_lookback.begin(),
+                         m_gate_lookback.begin() + static_cast<std::ptrdiff_t>(replay - head));
+    m_gate_replay.insert(m_gate_replay.end(), input.begin(), input.end());
+    m_stats.gate_openings.add();
+
+    m_gate_open = true;
+    m_gate_idle_samples = 0;
+    input = m_gate_replay;
+    return true;
+}
+
+DecoderStats Decoder::stats() const {
+    DecoderStats out;
+    out.samples_processed = m_stats.samples_processed.load();
+    out.gated_samples = m_stats.gated_samples.load();
+    out.gate_openings = m_stats.gate_openings.load();
+    out.resampler_ns = m_stats.resampler_ns.load();
+    out.bandpass_ns = m_stats.bandpass_ns.load();
+    out.estimator_ns = m_stats.estimator_ns.load();
+    out.state_machine_ns = m_stats.state_machine_ns.load();
+    out.fused_front_end_ns = m_stats.fused_front_end_ns.load();
+
+    const VISDecoder::Stats& vis = m_vis_decoder->stats();
+    for (size_t i = 0; i < VISDecoder::STATE_COUNT; ++i) out.vis_resets[i] = vis.resets_by_state[i].load();
+    out.vis_parity_errors = vis.parity_errors.load();
+    out.vis_headers_decoded = vis.headers_decoded.load();
+    out.vis_unknown_modes = vis.unknown_modes.load();
+    if (const GoertzelVISDecoder* goertzel = m_goertzel_vis_stats.load(std::memory_order_acquire)) {
+        const GoertzelVISDecoder::Stats& gv = goertzel->stats();
+        out.vis_resets[static_cast<size_t>(VISDecoder::State::LEADER_BURST_1)] += gv.leaders_lost.load();
+        out.vis_resets[static_cast<size_t>(VISDecoder::State::START_BIT)] += gv.framing_errors.load();
+        out.vis_parity_errors += gv.parity_errors.load();
+        out.vis_headers_decoded += gv.headers_decoded.load();
+        out.vis_unknown_modes += gv.unknown_modes.load();
+    }
+
+    for (const auto& published : m_demodulator_stats) {
+        const ImageDemodulator* demodulator = published.load(std::memory_order_acquire);
+        if (!demodulator) continue;
+        out.pd_syncs_detected += demodulator->stats().syncs_detected.load();
+        out.pd_sync_timeouts += demodulator->stats().sync_timeouts.load();
+    }
+    out.lines_emitted = m_stats.lines_emitted.load();
+    out.images_completed = m_stats.images_completed.load();
+    out.images_cancelled = m_stats.images_cancelled.load();
+    out.images_timed_out = m_stats.images_timed_out.load();
+
+    out.afc_offset = m_stats.afc_offset.load();
+    return out;
+}
+
+void Decoder::reset_stats() {
+    m_stats.samples_processed.reset();
+    m_stats.gated_samples.reset();
+    m_stats.gate_openings.reset();
+    m_stats.resampler_ns.reset();
+    m_stats.bandpass_ns.reset();
+    m_stats.estimator_ns.reset();
+    m_stats.state_machine_ns.reset();
+    m_stats.fused_front_end_ns.reset();
+    m_stats.lines_emitted.reset();
+    m_stats.images_completed.reset();
+    m_stats.images_cancelled.reset();
+    m_stats.images_timed_out.reset();
+    m_stats.afc_offset.reset();
+    m_vis_decoder->reset_stats();
+    if (m_goertzel_vis) m_goertzel_vis->reset_stats();
+    for (const auto& demodulator : m_demodulators) {
+        if (demodulator) demodulator->reset_stats();
+    }
+}
+
+void Decoder::dump_trace(std::ostream& out) const {
+    out << "sample,time_s,source,state,freq,corrected_freq,env12,env15,afc_offset\n";
+    for (const TraceRecord& r : m_trace.snapshot()) {
+        const bool vis = r.source == TraceSource::VIS;
+        const std::string_view state =
+            vis ? VISDecoder::state_name(static_cast<VISDecoder::State>(r.state))
+                : PDDemodulator::segment_name(static_cast<PDDemodulator::SegmentType>(r.state));
+        out << r.sample_index << ',' << static_cast<double>(r.sample_index) / INTERNAL_SAMPLE_RATE << ','
+            << (vis ? "VIS" : "PD") << ',' << state << ',' << r.freq << ',' << r.corrected_freq << ','
+            << r.env12 << ',' << r.env15 << ',' << r.afc_offset << '\n';
+    }
+}
+
+void Decoder::run_state_machine(const float* samples, const FreqSample* frequencies, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (m_cancel_requested) {
+            m_cancel_requested = false;
+            if (m_state == State::DECODING_IMAGE_DATA) abandon_image(FrameStatus::CANCELLED);
+        }
+        // Warm restart: filters and discriminator keep running into the next image
+        if (m_state == State::IMAGE_COMPLETE) restart_search();
+        if (m_state == State::SEARCHING_VIS && m_vis_engine == VISEngine::GOERTZEL) {
+            // The Goertzel engine takes the rest of the block in one go
+            search_goertzel_vis(std::span<const float>(samples + i, count - i));
+            return;
+        }
+
+        if (m_state == State::DECODING_IMAGE_DATA) {
+            // One call per block on the active family's demodulator. It returns
+            // after every line and at the timeout, so cancellation and lifecycle
+            // changes still take effect at the next sample. Trace builds go one
+            // sample at a time to keep the trace clock exact.
+            const size_t n = TRACE_ENABLED ? 1 : count - i;
+            m_trace.tick();
+            const size_t used = m_demodulator->process_block(std::span<const float>(samples + i, n),
+                                                             std::span<const FreqSample>(frequencies + i, n),
+                                                             m_image_timeout_samples);
+            m_sample_timer += static_cast<double>(used);
+            i += used - 1;
+            if (m_state == State::DECODING_IMAGE_DATA && m_image_timeout_samples > 0 &&
+                m_demodulator->samples_since_sync() >= m_image_timeout_samples) {
+                abandon_image(FrameStatus::TIMED_OUT);
+            }
+            continue;
+        }
+
+        FreqSample freq = frequencies[i];
 
         m_sample_timer += 1.0;
+        m_trace.tick();
         switch (m_state) {
             case State::SEARCHING_VIS: {
                 bool vis_decoded = m_vis_decoder->process_frequency(freq);
@@ -91,25 +629,11 @@ void Decoder::process(const float* samples, size_t count) {
                 break;
             }
             case State::DECODING_IMAGE_DATA: {
-                switch (m_current_mode.family) {
-                    case SSTVFamily::PD: {
-                        m_pd_demodulator->process(sample, freq);
-                        break;
-                    }
-                    case SSTVFamily::UNKNOWN:
-                    default: {
-                        std::cerr << "Unsupported family!" << std::endl;
-                        reset();
-                        break;
-                    }
-                    // Other families
-                }
-                // Add logic for other modes here if implemented
+                // Handled as a block above
                 break;
             }
             case State::IMAGE_COMPLETE: {
-                // Wait for a reset or a new transmission to start
-                reset();
+                // Restarted at the top of the loop
                 break;
             }
             case State::DECODING_IMAGE_HEADER: {
@@ -123,35 +647,83 @@ void Decoder::process(const float* samples, size_t count) {
 
 // Internal callback handlers
 void Decoder::handle_mode_detected(const SSTVMode& mode) {
+    // Lines queued in THROUGHPUT mode belong to the previous image
+    flush_deferred_lines();
     m_current_mode = mode;
 
+    if (m_frame_buffer_enabled) {
+        m_frame_width = mode.width;
+        m_frame_height = mode.height;
+        std::fill_n(m_frame_buffer.begin(), static_cast<size_t>(m_frame_width) * m_frame_height, Pixel{0, 0, 0});
+    }
+
     if (m_on_mode_detected_cb) {
         m_on_mode_detected_cb(mode);
     }
     
-    switch (m_current_mode.family) {
-        case SSTVFamily::PD: {
-            // 只在 PD 分支里去查私有的 PD_TIMINGS_MAP
-            auto it = PD_TIMINGS_MAP.find(m_current_mode.vis_code);
-            if (it != PD_TIMINGS_MAP.end()) {
-                m_pd_demodulator->configure(m_current_mode, it->second);
-                // 从 VIS 解码器获取 AFC 偏移并传递给 PD 解调器
-                double vis_afc_offset = m_vis_decoder->get_afc_offset();
-                // std::cout << "Pass AFC offset to PD demodulator: " << vis_afc_offset << "Hz" << std::endl;
-                m_pd_demodulator->set_afc_offset(vis_afc_offset);
-                m_state = State::DECODING_IMAGE_DATA;
-            }
-            break;
-        }
-        case SSTVFamily::UNKNOWN:
-        default:
-            std::cerr << "Unsupported family!" << std::endl;
-            reset();
-            break;
+    // Each family's private timings live in its mode descriptor
+    const ModeDescriptor* desc = find_mode(m_current_mode.vis_code);
+    ImageDemodulator* demodulator = desc ? demodulator_for(desc->mode.family) : nullptr;
+    if (!demodulator) {
+        std::cerr << "Unsupported family!" << std::endl;
+        reset();
+        return;
+    }
+    m_demodulator = demodulator;
+    m_demodulator->configure(*desc);
+    begin_image();
+    // Hand the VIS decoder's AFC offset to the demodulator
+    m_demodulator->set_afc_offset(vis_afc_offset());
+    m_state = State::DECODING_IMAGE_DATA;
+}
+
+ImageDemodulator* Decoder::demodulator_for(SSTVFamily family) {
+    const size_t index = static_cast<size_t>(family);
+    if (index >= m_demodulators.size()) return nullptr;
+    if (!m_demodulators[index]) {
+        const DemodulatorFactory factory = find_demodulator_factory(family);
+        if (!factory) return nullptr;
+        m_demodulators[index] = factory(INTERNAL_SAMPLE_RATE,
+            [this](int line_idx, std::span<const Pixel> pixels){ handle_line_decoded(line_idx, pixels); },
+            [this](int width, int height){ handle_image_complete(width, height); });
+        m_demodulators[index]->set_sync_mode(m_sync_mode);
+        if constexpr (TRACE_ENABLED) m_demodulators[index]->set_trace(&m_trace);
+        m_demodulator_stats[index].store(m_demodulators[index].get(), std::memory_order_release);
+    }
+    return m_demodulators[index].get();
+}
+
+void Decoder::set_sync_mode(SyncMode mode) {
+    m_sync_mode = mode;
+    for (const auto& demodulator : m_demodulators) {
+        if (demodulator) demodulator->set_sync_mode(mode);
     }
 }
 
-void Decoder::handle_line_decoded(int line_idx, const std::vector<Pixel>& pixels) {
+void Decoder::handle_line_decoded(int line_idx, std::span<const Pixel> pixels) {
+    m_stats.lines_emitted.add();
+    bool ready = false;
+    if (m_frame_buffer_enabled && line_idx >= 0 && line_idx < m_frame_height) {
+        // Normally the demodulator already wrote the row in place
+        Pixel* row = m_frame_buffer.data() + static_cast<size_t>(line_idx) * m_frame_width;
+        if (pixels.data() != row) {
+            std::copy_n(pixels.begin(), std::min(pixels.size(), static_cast<size_t>(m_frame_width)), row);
+        }
+        ready = true;
+    }
+    // Queued for the writer thread right away, even when the callbacks are deferred
+    if (m_image_writer) m_image_writer->write_line(line_idx, pixels);
+
+    if (m_defer_lines) {
+        // The demodulator reuses its line buffer, so keep a copy until the end of the tile
+        const size_t offset = m_deferred_pixels.size();
+        const size_t count = m_on_line_decoded_cb ? pixels.size() : 0;
+        m_deferred_pixels.insert(m_deferred_pixels.end(), pixels.begin(), pixels.begin() + static_cast<std::ptrdiff_t>(count));
+        m_deferred_lines.push_back({line_idx, ready, offset, count});
+        return;
+    }
+
+    if (ready && m_on_line_ready_cb) m_on_line_ready_cb(line_idx);
     if (m_on_line_decoded_cb) {
         // Debug info
         // std::cout << "Current sample idx: " << static_cast<uint32_t>(m_sample_timer) << ", Time: " << m_sample_timer / m_sample_rate << std::endl;
@@ -162,11 +734,14 @@ void Decoder::handle_line_decoded(int line_idx, const std::vector<Pixel>& pixels
 void Decoder::handle_image_complete(int width, int height) {
     // // Debug info
     // std::cout << "Image transmission complete (" << width << "x" << height << ")." << std::endl;
+    m_stats.images_completed.add();
+    flush_deferred_lines();
     if (m_on_image_complete_cb) {
         m_on_image_complete_cb(width, height);
     }
+    finish_image(FrameStatus::COMPLETE);
     m_state = State::IMAGE_COMPLETE;
-    // The PDDemodulator will reset itself. VISDecoder is already complete.
+    // The next sample restarts the VIS search without touching the front end
 }
 
 } // namespace sstv
@@ -0,0 +1,285 @@
+#include "sstv_decoder_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace sstv {
+
+DecoderPool::DecoderPool(size_t channel_count, double sample_rate, size_t worker_count) {
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_channels.reserve(channel_count);
+    for (size_t ch = 0; ch < channel_count; ++ch) {
+        auto channel = std::make_unique<Channel>();
+        channel->decoder = std::make_unique<Decoder>(sample_rate);
+
+        // Forward per-decoder callbacks with the channel index attached
+        channel->decoder->set_on_mode_detected_callback([this, ch](const SSTVMode& mode) {
+            if (m_on_mode_detected_cb) m_on_mode_detected_cb(ch, mode);
+        });
+        channel->decoder->set_on_line_decoded_callback([this, ch](int line_idx, std::span<const Pixel> pixels) {
+            if (m_on_line_decoded_cb) m_on_line_decoded_cb(ch, line_idx, pixels);
+        });
+        channel->decoder->set_on_image_complete_callback([this, ch](int width, int height) {
+            if (m_on_image_complete_cb) m_on_image_complete_cb(ch, width, height);
+        });
+
+        m_channels.push_back(std::move(channel));
+    }
+
+    m_workers.reserve(worker_count);
+    for (size_t w = 0; w < worker_count; ++w) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t w = 0; w < worker_count; ++w) {
+        m_workers[w]->thread = std::thread([this, w] { worker_loop(w); });
+    }
+}
+
+DecoderPool::~DecoderPool() {
+    // Decode everything already submitted before the workers go away
+    try {
+        wait_idle();
+    } catch (...) {
+        // A callback error can only be reported by an explicit wait_idle()
+    }
+    {
+        std::lock_guard lock(m_wake_mutex);
+        m_stopping = true;
+    }
+    m_wake_cv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void DecoderPool::submit(size_t channel_idx, const float* samples, size_t count) {
+    if (channel_idx >= m_channels.size()) {
+        throw std::out_of_range("DecoderPool: channel index out of range");
+    }
+    if (count == 0) return;
+
+    Channel& channel = *m_channels[channel_idx];
+    bool needs_schedule = false;
+    {
+        std::lock_guard lock(channel.mutex);
+        std::vector<float> block;
+        if (!channel.spare.empty()) {
+            block = std::move(channel.spare.back());
+            channel.spare.pop_back();
+        }
+        block.assign(samples, samples + count);
+        channel.pending.push_back({std::move(block), nullptr});
+        m_pending_items.fetch_add(1, std::memory_order_relaxed);
+
+        if (!channel.scheduled) {
+            channel.scheduled = true;
+            needs_schedule = true;
+        }
+    }
+
+    // Home worker is fixed per channel to keep its state cache-warm; others may steal it
+    if (needs_schedule) push_task(channel_idx % m_workers.size(), channel_idx);
+}
+
+uint64_t DecoderPool::submit_command(size_t channel_idx, std::function<void(Decoder&)> command) {
+    Channel& channel = *m_channels[channel_idx];
+    bool needs_schedule = false;
+    uint64_t ticket;
+    {
+        std::lock_guard lock(channel.mutex);
+        channel.pending.push_back({{}, std::move(command)});
+        ticket = ++channel.commands_queued;
+        m_pending_items.fetch_add(1, std::memory_order_relaxed);
+
+        if (!channel.scheduled) {
+            channel.scheduled = true;
+            needs_schedule = true;
+        }
+    }
+
+    if (needs_schedule) push_task(channel_idx % m_workers.size(), channel_idx);
+    return ticket;
+}
+
+void DecoderPool::wait_idle() {
+    std::exception_ptr error;
+    {
+        std::unique_lock lock(m_idle_mutex);
+        m_idle_cv.wait(lock, [this] { return m_pending_items.load(std::memory_order_acquire) == 0; });
+        std::swap(error, m_error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+DecoderStats DecoderPool::channel_stats(size_t channel_idx) const {
+    if (channel_idx >= m_channels.size()) {
+        throw std::out_of_range("DecoderPool: channel index out of range");
+    }
+    return m_channels[channel_idx]->decoder->stats();
+}
+
+void DecoderPool::reset_channel(size_t channel_idx) {
+    if (channel_idx >= m_channels.size()) {
+        throw std::out_of_range("DecoderPool: channel index out of range");
+    }
+    Channel& channel = *m_channels[channel_idx];
+
+    // Workers decode without holding the channel lock, so the reset runs on
+    // the channel's worker, in order with the blocks submitted before it
+    const uint64_t ticket = submit_command(channel_idx, [](Decoder& decoder) { decoder.reset(); });
+    std::unique_lock lock(m_idle_mutex);
+    m_idle_cv.wait(lock, [&channel, ticket] {
+        std::lock_guard channel_lock(channel.mutex);
+        return channel.commands_done >= ticket;
+    });
+}
+
+void DecoderPool::set_tone_gate_enabled(bool enabled) {
+    // Queued like reset_channel(): the channel lock does not exclude a running process()
+    for (size_t ch = 0; ch < m_channels.size(); ++ch) {
+        submit_command(ch, [enabled](Decoder& decoder) { decoder.set_tone_gate_enabled(enabled); });
+    }
+}
+
+void DecoderPool::set_vis_engine(VISEngine engine) {
+    for (size_t ch = 0; ch < m_channels.size(); ++ch) {
+        submit_command(ch, [engine](Decoder& decoder) { decoder.set_vis_engine(engine); });
+    }
+}
+
+void DecoderPool::set_sync_mode(SyncMode mode) {
+    // Queued like reset_channel(): the channel lock does not exclude a running process()
+    for (size_t ch = 0; ch < m_channels.size(); ++ch) {
+        submit_command(ch, [mode](Decoder& decoder) { decoder.set_sync_mode(mode); });
+    }
+}
+
+void DecoderPool::set_image_timeout_lines(int lines) {
+    for (size_t ch = 0; ch < m_channels.size(); ++ch) {
+        submit_command(ch, [lines](Decoder& decoder) { decoder.set_image_timeout_lines(lines); });
+    }
+}
+
+void DecoderPool::set_on_mode_detected_callback(ChannelModeDetectedCallback cb) {
+    m_on_mode_detected_cb = std::move(cb);
+}
+
+void DecoderPool::set_on_line_decoded_callback(ChannelLineDecodedCallback cb) {
+    m_on_line_decoded_cb = std::move(cb);
+}
+
+void DecoderPool::set_on_image_complete_callback(ChannelImageCompleteCallback cb) {
+    m_on_image_complete_cb = std::move(cb);
+}
+
+void DecoderPool::push_task(size_t worker_idx, size_t channel_idx) {
+    {
+        std::lock_guard lock(m_workers[worker_idx]->mutex);
+        m_workers[worker_idx]->tasks.push_back(channel_idx);
+    }
+    {
+        std::lock_guard lock(m_wake_mutex);
+        ++m_queued_tasks;
+    }
+    m_wake_cv.notify_one();
+}
+
+bool DecoderPool::pop_task(size_t worker_idx, size_t& channel_idx) {
+    // Own queue first (FIFO)
+    {
+        Worker& self = *m_workers[worker_idx];
+        std::lock_guard lock(self.mutex);
+        if (!self.tasks.empty()) {
+            channel_idx = self.tasks.front();
+            self.tasks.pop_front();
+            return true;
+        }
+    }
+    // Then steal from the back of the other workers' queues
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        Worker& victim = *m_workers[(worker_idx + i) % m_workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            channel_idx = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecoderPool::worker_loop(size_t worker_idx) {
+    while (true) {
+        {
+            // Claim a task in the same critical section that saw it, so other
+            // woken workers go back to sleep instead of racing for it
+            std::unique_lock lock(m_wake_mutex);
+            m_wake_cv.wait(lock, [this] { return m_stopping || m_queued_tasks > 0; });
+            if (m_stopping) return;
+            --m_queued_tasks;
+        }
+
+        // Every claim is backed by a queued task, but the scan over the queues
+        // is not atomic and can miss one pushed behind it; just look again
+        size_t channel_idx;
+        while (!pop_task(worker_idx, channel_idx)) std::this_thread::yield();
+
+        run_channel(worker_idx, channel_idx);
+    }
+}
+
+void DecoderPool::run_channel(size_t worker_idx, size_t channel_idx) {
+    Channel& channel = *m_channels[channel_idx];
+
+    for (size_t done = 0; ; ++done) {
+        Item item;
+        {
+            std::lock_guard lock(channel.mutex);
+            if (channel.pending.empty()) {
+                channel.scheduled = false;
+                break;
+            }
+            if (done >= BLOCKS_PER_TASK) {
+                // Yield so other channels on this worker are not starved; stays scheduled
+                push_task(worker_idx, channel_idx);
+                return;
+            }
+            item = std::move(channel.pending.front());
+            channel.pending.pop_front();
+        }
+
+        // Only one worker holds a scheduled channel, so no lock is needed while decoding.
+        // A throwing callback must not escape the worker: the item still counts as
+        // done and the first exception is rethrown by wait_idle()
+        const bool command = static_cast<bool>(item.command);
+        try {
+            if (command) {
+                item.command(*channel.decoder);
+            } else {
+                channel.decoder->process(item.samples.data(), item.samples.size());
+            }
+        } catch (...) {
+            std::lock_guard lock(m_idle_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(channel.mutex);
+            if (command) {
+                ++channel.commands_done;
+            } else {
+                channel.spare.push_back(std::move(item.samples));
+            }
+        }
+        // wait_idle() waits for the last item, reset_channel() for its command
+        if (m_pending_items.fetch_sub(1, std::memory_order_acq_rel) == 1 || command) {
+            std::lock_guard lock(m_idle_mutex);
+            m_idle_cv.notify_all();
+        }
+    }
+}
+
+} // namespace sstv
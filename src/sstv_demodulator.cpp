@@ -0,0 +1,28 @@
+#include "sstv_demodulator.h"
+#include "sstv_pd_demodulator.h"
+
+#include <utility>
+
+namespace sstv {
+
+namespace {
+
+template <typename Demodulator>
+std::unique_ptr<ImageDemodulator> make_demodulator(double sample_rate, LineDecodedCallback on_line_decoded,
+                                                   ImageCompleteCallback on_image_complete) {
+    return std::make_unique<Demodulator>(sample_rate, std::move(on_line_decoded), std::move(on_image_complete));
+}
+
+// Indexed by SSTVFamily
+constexpr std::array<DemodulatorFactory, FAMILY_COUNT> FACTORIES = {
+    &make_demodulator<PDDemodulator>,  // SSTVFamily::PD
+};
+
+} // namespace
+
+DemodulatorFactory find_demodulator_factory(SSTVFamily family) {
+    const size_t index = static_cast<size_t>(family);
+    return index < FACTORIES.size() ? FACTORIES[index] : nullptr;
+}
+
+} // namespace sstv
@@ -0,0 +1,126 @@
+#include "sstv_frame_manager.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sstv {
+
+FrameManager::Frame& FrameManager::Frame::operator=(Frame&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_manager = std::exchange(other.m_manager, nullptr);
+        m_slot = other.m_slot;
+        m_pixels = std::exchange(other.m_pixels, {});
+        m_info = other.m_info;
+    }
+    return *this;
+}
+
+void FrameManager::Frame::release() {
+    if (m_manager) {
+        m_manager->release_slot(m_slot);
+        m_manager = nullptr;
+        m_pixels = {};
+    }
+}
+
+FrameManager::FrameManager(size_t slot_count, size_t slot_pixels) {
+    if (slot_count < MIN_SLOTS) {
+        throw std::runtime_error("FrameManager: at least two slots are required");
+    }
+    m_slots.resize(slot_count);
+    for (Slot& slot : m_slots) slot.pixels.assign(slot_pixels, Pixel{0, 0, 0});
+
+    // Both lists hold every slot at most once, so they never reallocate
+    m_free.reserve(slot_count);
+    m_ready.reserve(slot_count);
+    for (size_t i = slot_count; i > 0; --i) m_free.push_back(i - 1);
+}
+
+std::span<Pixel> FrameManager::begin_frame(const FrameInfo& info) {
+    discard_frame();
+
+    const size_t pixels = static_cast<size_t>(info.width) * static_cast<size_t>(info.height);
+    {
+        std::lock_guard lock(m_mutex);
+        if (pixels > m_slots.front().pixels.size()) {
+            ++m_dropped;
+            return {};
+        }
+        if (m_free.empty() && !m_ready.empty()) {
+            // The consumer is behind: recycle the oldest frame it has not taken yet
+            m_free.push_back(m_ready.front());
+            m_ready.erase(m_ready.begin());
+            ++m_dropped;
+        }
+        if (m_free.empty()) {
+            ++m_dropped;
+            return {};
+        }
+        m_active = m_free.back();
+        m_free.pop_back();
+    }
+
+    // The slot is ours until published, clear it outside the lock
+    Slot& slot = m_slots[m_active];
+    slot.info = info;
+    std::fill_n(slot.pixels.begin(), pixels, Pixel{0, 0, 0});
+    return {slot.pixels.data(), pixels};
+}
+
+void FrameManager::publish_frame(int lines_decoded, FrameStatus status) {
+    if (m_active == NO_SLOT) return;
+    Slot& slot = m_slots[m_active];
+    slot.info.lines_decoded = std::clamp(lines_decoded, 0, slot.info.height);
+    slot.info.status = status;
+    {
+        std::lock_guard lock(m_mutex);
+        m_ready.push_back(m_active);
+    }
+    m_active = NO_SLOT;
+    m_ready_cv.notify_one();
+}
+
+void FrameManager::discard_frame() {
+    if (m_active == NO_SLOT) return;
+    release_slot(m_active);
+    m_active = NO_SLOT;
+}
+
+FrameManager::Frame FrameManager::take_ready() {
+    const size_t index = m_ready.front();
+    m_ready.erase(m_ready.begin());
+    const Slot& slot = m_slots[index];
+    const size_t pixels = static_cast<size_t>(slot.info.width) * static_cast<size_t>(slot.info.height);
+    return Frame(this, index, std::span<const Pixel>(slot.pixels.data(), pixels), slot.info);
+}
+
+FrameManager::Frame FrameManager::try_acquire() {
+    std::lock_guard lock(m_mutex);
+    if (m_ready.empty()) return {};
+    return take_ready();
+}
+
+FrameManager::Frame FrameManager::wait_acquire(std::chrono::milliseconds timeout) {
+    std::unique_lock lock(m_mutex);
+    if (!m_ready_cv.wait_for(lock, timeout, [this] { return !m_ready.empty(); })) return {};
+    return take_ready();
+}
+
+void FrameManager::release_slot(size_t slot) {
+    std::lock_guard lock(m_mutex);
+    m_free.push_back(slot);
+}
+
+size_t FrameManager::ready_count() const {
+    std::lock_guard lock(m_mutex);
+    return m_ready.size();
+}
+
+uint64_t FrameManager::dropped_frames() const {
+    std::lock_guard lock(m_mutex);
+    return m_dropped;
+}
+
+} // namespace sstv
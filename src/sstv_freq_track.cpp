@@ -0,0 +1,239 @@
+#include "sstv_freq_track.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace sstv {
+
+namespace {
+
+using namespace track_format;
+
+// The format is little-endian regardless of the host
+template <typename T>
+T to_le(T value) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return value;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        return std::bit_cast<T>(std::byteswap(std::bit_cast<Bits>(value)));
+    } else {
+        return std::byteswap(value);
+    }
+}
+
+template <typename T>
+void put(uint8_t*& dst, T value) {
+    value = to_le(value);
+    std::memcpy(dst, &value, sizeof(T));
+    dst += sizeof(T);
+}
+
+template <typename T>
+T get(const uint8_t* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return to_le(value);
+}
+
+constexpr size_t bytes_per_sample(TrackEncoding encoding) {
+    return encoding == TrackEncoding::INT16 ? 2 * sizeof(int16_t) : 2 * sizeof(float);
+}
+// Keeps every chunk header 4-byte aligned whatever the chunk's sample count
+static_assert(bytes_per_sample(TrackEncoding::INT16) % 4 == 0 && bytes_per_sample(TrackEncoding::FLOAT32) % 4 == 0);
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// FreqTrackWriter
+// ---------------------------------------------------------------------------
+
+FreqTrackWriter::FreqTrackWriter(const std::string& path, double sample_rate, TrackEncoding encoding,
+                                 size_t chunk_samples)
+    : m_stream(path, std::ios::binary | std::ios::out | std::ios::trunc),
+      m_encoding(encoding),
+      m_chunk_samples(chunk_samples)
+{
+    if (!m_stream) {
+        throw std::runtime_error("Failed to create: " + path);
+    }
+    if (chunk_samples == 0 || chunk_samples > UINT32_MAX) {
+        throw std::runtime_error("Frequency track: invalid chunk size");
+    }
+    m_samples.reserve(chunk_samples);
+    m_frequencies.reserve(chunk_samples);
+    m_encoded.resize(CHUNK_HEADER_BYTES + chunk_samples * bytes_per_sample(encoding));
+
+    uint8_t header[HEADER_BYTES];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    uint8_t* p = header + sizeof(MAGIC);
+    put<uint32_t>(p, VERSION);
+    put<uint32_t>(p, static_cast<uint32_t>(encoding));
+    put<double>(p, sample_rate);
+    put<uint32_t>(p, static_cast<uint32_t>(chunk_samples));
+    put<uint32_t>(p, 0);
+    m_stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (!m_stream) {
+        throw std::runtime_error("Failed to write: " + path);
+    }
+}
+
+FreqTrackWriter::~FreqTrackWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void FreqTrackWriter::append(std::span<const float> filtered, std::span<const FreqSample> frequencies) {
+    if (!m_stream.is_open()) {
+        throw std::runtime_error("Frequency track: writer is closed");
+    }
+    if (filtered.size() != frequencies.size()) {
+        throw std::runtime_error("Frequency track: sample and frequency counts differ");
+    }
+    while (!filtered.empty()) {
+        const size_t n = std::min(filtered.size(), m_chunk_samples - m_samples.size());
+        m_samples.insert(m_samples.end(), filtered.begin(), filtered.begin() + static_cast<std::ptrdiff_t>(n));
+        for (size_t i = 0; i < n; ++i) m_frequencies.push_back(static_cast<float>(frequencies[i]));
+        filtered = filtered.subspan(n);
+        frequencies = frequencies.subspan(n);
+        if (m_samples.size() == m_chunk_samples) write_chunk();
+    }
+}
+
+void FreqTrackWriter::close() {
+    if (!m_stream.is_open()) return;
+    if (!m_samples.empty()) write_chunk();
+    m_stream.close();
+    if (m_stream.fail()) {
+        throw std::runtime_error("Frequency track: write failed");
+    }
+}
+
+void FreqTrackWriter::write_chunk() {
+    const size_t count = m_samples.size();
+    float sample_scale = 1.0f;
+    if (m_encoding == TrackEncoding::INT16) {
+        float peak = 0.0f;
+        for (float s : m_samples) peak = std::max(peak, std::abs(s));
+        sample_scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+    }
+
+    uint8_t* p = m_encoded.data();
+    put<uint32_t>(p, CHUNK_MAGIC);
+    put<uint32_t>(p, static_cast<uint32_t>(count));
+    put<float>(p, sample_scale);
+    put<uint32_t>(p, 0);
+
+    if (m_encoding == TrackEncoding::INT16) {
+        const float inv_scale = 1.0f / sample_scale;
+        constexpr float freq_limit = 32767.0f * FREQ_STEP_HZ;
+        for (float f : m_frequencies) {
+            put<int16_t>(p, static_cast<int16_t>(std::lround(std::clamp(f, -freq_limit, freq_limit) / FREQ_STEP_HZ)));
+        }
+        for (float s : m_samples) {
+            put<int16_t>(p, static_cast<int16_t>(std::lround(std::clamp(s * inv_scale, -32767.0f, 32767.0f))));
+        }
+    } else {
+        for (float f : m_frequencies) put<float>(p, f);
+        for (float s : m_samples) put<float>(p, s);
+    }
+
+    m_stream.write(reinterpret_cast<const char*>(m_encoded.data()), p - m_encoded.data());
+    if (!m_stream) {
+        throw std::runtime_error("Frequency track: write failed");
+    }
+    m_samples_written += count;
+    m_samples.clear();
+    m_frequencies.clear();
+}
+
+// ---------------------------------------------------------------------------
+// FreqTrackReader
+// ---------------------------------------------------------------------------
+
+FreqTrackReader::FreqTrackReader(const std::string& path) : m_file(path) {
+    const uint8_t* data = m_file.data();
+    const size_t size = m_file.size();
+    if (size < HEADER_BYTES || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a frequency track file: " + path);
+    }
+    if (get<uint32_t>(data + 8) != VERSION) {
+        throw std::runtime_error("Unsupported frequency track version: " + path);
+    }
+    const uint32_t encoding = get<uint32_t>(data + 12);
+    if (encoding > static_cast<uint32_t>(TrackEncoding::INT16)) {
+        throw std::runtime_error("Unknown frequency track encoding: " + path);
+    }
+    m_encoding = static_cast<TrackEncoding>(encoding);
+    m_sample_rate = get<double>(data + 16);
+    const size_t chunk_samples = get<uint32_t>(data + 24);
+
+    // Index every chunk up front, so a truncated file fails here and not halfway through a replay
+    size_t offset = HEADER_BYTES;
+    while (offset < size) {
+        if (size - offset < CHUNK_HEADER_BYTES || get<uint32_t>(data + offset) != CHUNK_MAGIC) {
+            throw std::runtime_error("Corrupt frequency track chunk: " + path);
+        }
+        const size_t count = get<uint32_t>(data + offset + 4);
+        const size_t payload = count * bytes_per_sample(m_encoding);
+        if (count == 0 || count > chunk_samples || size - offset - CHUNK_HEADER_BYTES < payload) {
+            throw std::runtime_error("Truncated frequency track: " + path);
+        }
+        m_chunks.push_back({offset + CHUNK_HEADER_BYTES, count, get<float>(data + offset + 8)});
+        m_sample_count += count;
+        offset += CHUNK_HEADER_BYTES + payload;
+    }
+}
+
+bool FreqTrackReader::is_track_file(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    return stream.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+FreqTrackReader::Chunk FreqTrackReader::next_chunk() {
+    if (m_next_chunk >= m_chunks.size()) return {};
+    const ChunkRef& chunk = m_chunks[m_next_chunk++];
+    const uint8_t* freq_bytes = m_file.data() + chunk.offset;
+
+    if (m_encoding == TrackEncoding::FLOAT32) {
+        const uint8_t* sample_bytes = freq_bytes + chunk.count * sizeof(float);
+        // Float data is used in place where the host layout matches
+        if constexpr (std::endian::native == std::endian::little) {
+            std::span<const float> samples(reinterpret_cast<const float*>(sample_bytes), chunk.count);
+            if constexpr (std::is_same_v<FreqSample, float>) {
+                return {samples, std::span<const FreqSample>(reinterpret_cast<const FreqSample*>(freq_bytes), chunk.count)};
+            } else {
+                m_frequencies.resize(chunk.count);
+                const float* freqs = reinterpret_cast<const float*>(freq_bytes);
+                std::copy_n(freqs, chunk.count, m_frequencies.begin());
+                return {samples, m_frequencies};
+            }
+        } else {
+            m_samples.resize(chunk.count);
+            m_frequencies.resize(chunk.count);
+            for (size_t i = 0; i < chunk.count; ++i) {
+                m_frequencies[i] = get<float>(freq_bytes + i * sizeof(float));
+                m_samples[i] = get<float>(sample_bytes + i * sizeof(float));
+            }
+            return {m_samples, m_frequencies};
+        }
+    }
+
+    const uint8_t* sample_bytes = freq_bytes + chunk.count * sizeof(int16_t);
+    m_samples.resize(chunk.count);
+    m_frequencies.resize(chunk.count);
+    for (size_t i = 0; i < chunk.count; ++i) {
+        m_frequencies[i] = static_cast<FreqSample>(get<int16_t>(freq_bytes + i * sizeof(int16_t))) * FREQ_STEP_HZ;
+        m_samples[i] = static_cast<float>(get<int16_t>(sample_bytes + i * sizeof(int16_t))) * chunk.sample_scale;
+    }
+    return {m_samples, m_frequencies};
+}
+
+} // namespace sstv
@@ -0,0 +1,291 @@
+#include "sstv_image_writer.h"
+#include "sstv_audio_file.h"
+#include "sstv_png_encoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sstv {
+
+// ---------------------------------------------------------------------------
+// ImageWriter::Output
+// ---------------------------------------------------------------------------
+
+// One image file in progress, written under a temporary name
+class ImageWriter::Output {
+public:
+    Output(std::string path, ImageFormat format, int width, int height)
+        : m_path(std::move(path)), m_temp_path(m_path + ".part"), m_width(width), m_height(height)
+    {
+        if (format == ImageFormat::RAW) {
+            // Rows land straight in the page cache; missing rows stay zero (black)
+            m_map = std::make_unique<MappedFile>(m_temp_path, static_cast<size_t>(width) * height * sizeof(Pixel));
+        } else {
+            m_stream.open(m_temp_path, std::ios::binary | std::ios::out | std::ios::trunc);
+            if (!m_stream) {
+                throw std::runtime_error("Failed to create: " + m_temp_path);
+            }
+            m_png = std::make_unique<PngEncoder>(m_stream, width, height);
+        }
+    }
+
+    ~Output() {
+        if (m_committed) return;
+        m_png.reset();
+        m_map.reset();
+        m_stream.close();
+        std::error_code ignored;
+        std::filesystem::remove(m_temp_path, ignored);
+    }
+
+    void write_line(int line_index, std::span<const Pixel> pixels) {
+        if (line_index < 0 || line_index >= m_height) return;
+        pixels = pixels.first(std::min(pixels.size(), static_cast<size_t>(m_width)));
+        if (m_map) {
+            uint8_t* row = m_map->writable_data() + static_cast<size_t>(line_index) * m_width * sizeof(Pixel);
+            std::memcpy(row, pixels.data(), pixels.size_bytes());
+            return;
+        }
+        // PNG is written strictly top to bottom: skipped rows become black, a row that comes back late is dropped
+        if (line_index < m_png->rows_written()) return;
+        while (m_png->rows_written() < line_index) m_png->write_row({});
+        m_png->write_row(pixels);
+    }
+
+    // Close the file and move it to its final name
+    void commit() {
+        if (m_png) {
+            m_png->finish();
+            m_png.reset();
+            m_stream.close();
+            if (m_stream.fail()) {
+                throw std::runtime_error("Failed to write: " + m_temp_path);
+            }
+        }
+        m_map.reset();
+
+        std::error_code error;
+        std::filesystem::rename(m_temp_path, m_path, error);
+        if (error) {
+            throw std::runtime_error("Failed to rename " + m_temp_path + ": " + error.message());
+        }
+        m_committed = true;
+    }
+
+    [[nodiscard]] const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+    std::string m_temp_path;
+    int m_width;
+    int m_height;
+    bool m_committed = false;
+
+    std::unique_ptr<MappedFile> m_map;   // RAW
+    std::ofstream m_stream;              // PNG
+    std::unique_ptr<PngEncoder> m_png;
+};
+
+// ---------------------------------------------------------------------------
+// ImageWriter
+// ---------------------------------------------------------------------------
+
+ImageWriter::ImageWriter(std::string path, ImageFormat format, size_t queue_lines)
+    : m_path(std::move(path)),
+      m_format(format),
+      m_events(queue_lines + 2),  // + the begin event and the reserved end event
+      m_queue(queue_lines + 2),
+      m_free(queue_lines + 2)
+{
+    if (queue_lines == 0) {
+        throw std::runtime_error("ImageWriter: queue must hold at least one line");
+    }
+    for (Event& event : m_events) event.pixels.resize(MAX_MODE_WIDTH);
+
+    m_reserve = 0;
+    m_has_reserve = true;
+    for (uint32_t slot = 1; slot < m_events.size(); ++slot) m_free.push(&slot, 1);
+
+    m_thread = std::thread([this] { run(); });
+}
+
+ImageWriter::~ImageWriter() {
+    m_stopping.store(true, std::memory_order_release);
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+ImageFormat ImageWriter::format_for_path(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return ImageFormat::RAW;
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == "png" ? ImageFormat::PNG : ImageFormat::RAW;
+}
+
+std::string ImageWriter::path_for(uint64_t sequence) const {
+    const size_t at = m_path.find("{}");
+    if (at == std::string::npos) return m_path;
+    return m_path.substr(0, at) + std::to_string(sequence) + m_path.substr(at + 2);
+}
+
+void ImageWriter::begin_image(const FrameInfo& info) noexcept {
+    if (m_image_open) discard_image();
+
+    // An image is only started when its end event is guaranteed a slot
+    if (!m_has_reserve) m_has_reserve = acquire_slot(m_reserve);
+    uint32_t slot = 0;
+    if (!m_has_reserve || info.width <= 0 || info.height <= 0 || !acquire_slot(slot)) {
+        m_images_dropped.store(m_images_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    Event& event = m_events[slot];
+    event.kind = EventKind::BEGIN;
+    event.info = info;
+    post(slot);
+    m_image_open = true;
+}
+
+void ImageWriter::write_line(int line_index, std::span<const Pixel> pixels) noexcept {
+    if (!m_image_open) return;
+    uint32_t slot = 0;
+    if (!acquire_slot(slot)) {
+        m_lines_dropped.store(m_lines_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    Event& event = m_events[slot];
+    event.kind = EventKind::LINE;
+    event.line_index = line_index;
+    event.pixel_count = std::min(pixels.size(), event.pixels.size());
+    std::copy_n(pixels.begin(), event.pixel_count, event.pixels.begin());
+    post(slot);
+}
+
+void ImageWriter::end_image(const FrameInfo& info) noexcept {
+    if (!m_image_open) return;
+    Event& event = m_events[m_reserve];
+    event.kind = EventKind::END;
+    event.info = info;
+    m_image_open = false;
+    m_has_reserve = false;
+    post(m_reserve);
+}
+
+void ImageWriter::discard_image() noexcept {
+    if (!m_image_open) return;
+    m_events[m_reserve].kind = EventKind::DISCARD;
+    m_image_open = false;
+    m_has_reserve = false;
+    post(m_reserve);
+}
+
+bool ImageWriter::acquire_slot(uint32_t& slot) noexcept {
+    while (m_free.pop(&slot, 1) == 0) {
+        if (!m_wait_when_full) return false;
+        // Every handled event frees its slot first, so a change of m_handled means there may be one now
+        const uint64_t handled = m_handled.load(std::memory_order_acquire);
+        if (m_free.pop(&slot, 1) == 1) break;
+        m_handled.wait(handled, std::memory_order_acquire);
+    }
+    return true;
+}
+
+void ImageWriter::post(uint32_t slot) noexcept {
+    m_queue.push(&slot, 1);  // Never full: the ring has room for every slot
+    m_posted.store(m_posted.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+}
+
+void ImageWriter::flush() {
+    const uint64_t target = m_posted.load(std::memory_order_acquire);
+    for (uint64_t handled = m_handled.load(std::memory_order_acquire); handled < target;
+         handled = m_handled.load(std::memory_order_acquire)) {
+        m_handled.wait(handled, std::memory_order_acquire);
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(m_error_mutex);
+        std::swap(error, m_error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ImageWriter::run() {
+    while (true) {
+        // Both loads come before the pop, so an event posted before the stop
+        // request or the wake-up is never missed
+        const bool stopping = m_stopping.load(std::memory_order_acquire);
+        const uint64_t wake = m_wake.load(std::memory_order_acquire);
+        uint32_t slot = 0;
+        if (m_queue.pop(&slot, 1) == 1) {
+            handle(m_events[slot]);
+            m_free.push(&slot, 1);
+            m_handled.fetch_add(1, std::memory_order_release);
+            m_handled.notify_all();
+            continue;
+        }
+        if (stopping) break;
+        m_wake.wait(wake, std::memory_order_acquire);
+    }
+
+    // The producer went away mid-image: keep what was decoded
+    if (m_output) {
+        try {
+            finish_output();
+        } catch (...) {
+            abandon_output();
+        }
+    }
+}
+
+void ImageWriter::handle(Event& event) {
+    try {
+        switch (event.kind) {
+            case EventKind::BEGIN:
+                abandon_output();
+                m_output_info = event.info;
+                m_output = std::make_unique<Output>(path_for(event.info.sequence), m_format, event.info.width,
+                                                    event.info.height);
+                break;
+            case EventKind::LINE:
+                if (m_output) m_output->write_line(event.line_index, {event.pixels.data(), event.pixel_count});
+                break;
+            case EventKind::END:
+                if (m_output) {
+                    m_output_info = event.info;
+                    finish_output();
+                }
+                break;
+            case EventKind::DISCARD:
+                abandon_output();
+                break;
+        }
+    } catch (...) {
+        // Give up on this image only; the next one starts from scratch
+        abandon_output();
+        std::lock_guard lock(m_error_mutex);
+        if (!m_error) m_error = std::current_exception();
+    }
+}
+
+void ImageWriter::finish_output() {
+    const std::unique_ptr<Output> output = std::move(m_output);
+    output->commit();
+    m_images_written.fetch_add(1, std::memory_order_relaxed);
+    if (m_on_image_written_cb) m_on_image_written_cb(output->path(), m_output_info);
+}
+
+void ImageWriter::abandon_output() noexcept {
+    m_output.reset();  // Removes the partial file
+}
+
+} // namespace sstv
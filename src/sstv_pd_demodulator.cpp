@@ -1,7 +1,7 @@
 #include "sstv_pd_demodulator.h"
 #include "dsp_freq_estimator.h"
+#include "dsp_pixel_kernels.h"
 #include <algorithm>
-#include <iostream>
 
 namespace sstv {
 
@@ -18,19 +18,32 @@ PDDemodulator::PDDemodulator(double sample_rate,
 }
 
 void PDDemodulator::init_filters() {
-    m_iir1200.setup_bandpass(1200.0 + m_afc_offset, 100.0, m_sample_rate);
-    m_iir1500.setup_bandpass(1500.0 + m_afc_offset, 100.0, m_sample_rate);
-    m_lpf1200.setup_lowpass(50.0, m_sample_rate);
-    m_lpf1500.setup_lowpass(50.0, m_sample_rate);
+    m_envelope.setup(1200.0 + m_afc_offset, 1500.0 + m_afc_offset, 100.0, 50.0, m_sample_rate);
 }
 
 void PDDemodulator::configure(const SSTVMode& mode, const PDTimings& timings) {
     m_timings = timings;
     m_width = mode.width;
     m_height = mode.height;
+    m_sync_samples = m_timings.sync_ms * m_samples_per_ms;
+    m_porch_samples = m_timings.porch_ms * m_samples_per_ms;
+    m_segment_samples = m_timings.segment_ms * m_samples_per_ms;
 
-    m_segment_buffer.reserve(static_cast<size_t>(m_timings.segment_ms * m_samples_per_ms * 1.2));
+    m_segment_buffer.reserve(static_cast<size_t>(m_segment_samples * 1.2));
     m_y1_pixels.resize(m_width); m_y2_pixels.resize(m_width); m_cr_pixels.resize(m_width); m_cb_pixels.resize(m_width);
+    m_line_pixels.resize(m_width);
+
+    m_active_sync_mode = m_sync_mode;
+    if (m_active_sync_mode == SyncMode::CORRELATION) {
+        // 缓存一个行组加上搜索窗口与模板长度，稳态下不再分配
+        const double window = std::max(FIRST_SYNC_SEARCH_MS, 2.0 * SYNC_SEARCH_MS) * m_samples_per_ms +
+                              m_sync_samples + m_porch_samples;
+        m_track_buffer.reserve(static_cast<size_t>(line_group_samples() * (1.0 + MAX_PERIOD_ERROR) + window) + 2);
+        m_sync_score.reserve(static_cast<size_t>(window) + 2);
+        m_porch_score.reserve(static_cast<size_t>(window) + 2);
+        m_line_period = line_group_samples();
+        m_next_decision = FIRST_SYNC_SEARCH_MS * m_samples_per_ms + m_sync_samples + m_porch_samples + 1.0;
+    }
 }
 
 
@@ -38,8 +51,17 @@ void PDDemodulator::reset() {
     m_current_segment = SegmentType::IDLE;
     m_segment_timer = 0;
     m_current_line_idx = 0;
+    m_samples_since_sync = 0.0;
+    m_sync_hits = 0;
+    m_sync_checks = 0;
+    m_track_buffer.clear();
+    m_track_start = 0;
+    m_track_total = 0;
+    m_last_sync = 0.0;
+    m_syncs_committed = 0;
+    m_last_sync_hit = false;
     // 中值滤波重置
-    m_median_buffer.clear();
+    m_median_filter.clear();
     // AFC 重置
     m_afc_offset = 0.0;
     m_segment_buffer.clear();
@@ -53,16 +75,10 @@ void PDDemodulator::set_afc_offset(double afc_offset) {
     // 从 VIS 解码器继承 AFC 偏移，用于数据段解调
     m_afc_offset = afc_offset;
     init_filters();
-    // std::cout << "PD Demodulator: Initial freq offset set to " << freq_offset << " Hz" << std::endl;
 }
 
-double PDDemodulator::get_smoothed_freq(double raw_freq) {
-    m_median_buffer.push_back(raw_freq);
-    if (m_median_buffer.size() > MEDIAN_WINDOW) m_median_buffer.pop_front();
-
-    std::vector<double> sorted = {m_median_buffer.begin(), m_median_buffer.end()};
-    std::sort(sorted.begin(), sorted.end());
-    return sorted[sorted.size() / 2];
+FreqSample PDDemodulator::get_smoothed_freq(FreqSample raw_freq) {
+    return m_median_filter.process(raw_freq);
 }
 
 void PDDemodulator::reserve_samples(double reserved_samples)
@@ -70,56 +86,91 @@ void PDDemodulator::reserve_samples(double reserved_samples)
     m_segment_timer = reserved_samples - m_segment_timer;
 }
 
-bool PDDemodulator::process(float sample, double freq) {
-    // 1. 提取 1200Hz 通道包络
-    float s12 = m_iir1200.process(sample);
-    float env12 = m_lpf1200.process(std::abs(s12));
+bool PDDemodulator::process(float sample, FreqSample freq) {
+    // 1. 提取 1200Hz 通道包络与 1500Hz 参考通道包络
+    float env12, env15;
+    m_envelope.process(sample, env12, env15);
 
-    // 2. 提取 1500Hz 参考通道包络
-    float s15 = m_iir1500.process(sample);
-    float env15 = m_lpf1500.process(std::abs(s15));
+    step(freq, env12, env15);
+    return m_current_line_idx >= m_height;
+}
 
-    // 3. 动态更新背景噪声水平 (Slow Attack, Fast Release)
+size_t PDDemodulator::process_block(std::span<const float> samples, std::span<const FreqSample> freqs,
+                                    double sync_gap_limit) {
+    const size_t count = std::min(samples.size(), freqs.size());
+    size_t done = 0;
+    while (done < count) {
+        const size_t n = std::min(ENVELOPE_BLOCK, count - done);
+        // 提前返回时滤波器只能推进到已消耗的样本，先保存状态以便回退
+        const dsp::DualToneEnvelope saved = m_envelope;
+        m_envelope.process_block(samples.data() + done, m_env12_block.data(), m_env15_block.data(), n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const int line = m_current_line_idx;
+            step(freqs[done + i], m_env12_block[i], m_env15_block[i]);
+            if (m_current_line_idx != line || (sync_gap_limit > 0.0 && m_samples_since_sync >= sync_gap_limit)) {
+                if (i + 1 < n) {
+                    m_envelope = saved;
+                    m_envelope.process_block(samples.data() + done, m_env12_block.data(), m_env15_block.data(), i + 1);
+                }
+                return done + i + 1;
+            }
+        }
+        done += n;
+    }
+    return count;
+}
+
+void PDDemodulator::step(FreqSample freq, float env12, float env15) {
+    // 2. 动态更新背景噪声水平 (Slow Attack, Fast Release)
     // 用于处理长时间的静默或增益变化
     m_adaptive_threshold = 0.999f * m_adaptive_threshold + 0.001f * (env12 + 0.005f);
 
-    double corrected_freq = freq - m_afc_offset;
+    FreqSample corrected_freq = freq - static_cast<FreqSample>(m_afc_offset);
 
     m_segment_timer += 1.0;
+    m_samples_since_sync += 1.0;
+
+    if constexpr (TRACE_ENABLED) {
+        if (m_trace) {
+            m_trace->record({.source = TraceSource::PD,
+                             .state = static_cast<uint8_t>(m_current_segment),
+                             .freq = static_cast<float>(freq),
+                             .corrected_freq = static_cast<float>(corrected_freq),
+                             .env12 = env12,
+                             .env15 = env15,
+                             .afc_offset = static_cast<float>(m_afc_offset)});
+        }
+    }
 
-    // 预计算阈值，避免重复计算
-    const double sync_duration_samples = m_timings.sync_ms * m_samples_per_ms;
-    const double porch_duration_samples = m_timings.porch_ms * m_samples_per_ms;
-    const double segment_duration_samples = m_timings.segment_ms * m_samples_per_ms;
+    if (m_active_sync_mode == SyncMode::CORRELATION) {
+        track_sample(corrected_freq);
+        return;
+    }
 
     switch (m_current_segment) {
         case SegmentType::IDLE: {
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 20) {
-            //     std::cout << "Debug [" << debug_counter << "]: corrected_freq = " << corrected_freq << std::endl;
-            //     debug_counter++;
-            // } else if (debug_counter == 20) {
-            //     std::cout << "Reached 20 debug outputs. Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // IDLE -> SYNC 是硬同步点，这里必须归零，这是为了对齐发送端的时钟
             if (env12 > m_adaptive_threshold && env12 > env15 * 2.0) {
                 m_current_segment = SegmentType::SYNC;
                 m_segment_timer = 0;
+                m_stats.syncs_detected.add();
+                m_sync_hits = 0;
+                m_sync_checks = 0;
                 // 重置中值滤波
-                m_median_buffer.clear();
+                m_median_filter.clear();
             }
             break;
         }
 
         case SegmentType::SYNC: {
             double smoothed_freq = get_smoothed_freq(freq);  // 使用原始 freq 计算 AFC 偏置
-            // std::cout << "Debug SYNC [" << m_segment_timer << "]: corrected_freq = " << corrected_freq << " env12 = " << env12 << " env15 = " << env15 << std::endl;
-            if (m_segment_timer > (sync_duration_samples * 0.25) &&
-                m_segment_timer < (sync_duration_samples * 0.5)) {
+            if (m_segment_timer > (m_sync_samples * 0.25) &&
+                m_segment_timer < (m_sync_samples * 0.5)) {
 
                 double measured_offset = smoothed_freq - SYNC_FREQ;
+                ++m_sync_checks;
+                if (std::abs(measured_offset - m_afc_offset) < FREQ_TOLERANCE) ++m_sync_hits;
 
                 // 使用 IIR 滤波器平滑 offset
                 // 新偏移 = 10% 当前测量值 + 90% 历史记录
@@ -127,14 +178,11 @@ bool PDDemodulator::process(float sample, double freq) {
                 }
 
             // 探测 1200 -> 1500 的跳变沿作为 PORCH 的起始（硬同步）
-            if (m_segment_timer > (sync_duration_samples * 0.5)) {
+            if (m_segment_timer > (m_sync_samples * 0.5)) {
                 // 如果修正后的频率更接近黑色 (1500)，说明同步结束了
                 double corrected_smoothed_freq = smoothed_freq - m_afc_offset;
                 if (std::abs(corrected_smoothed_freq - BLACK_FREQ) < std::abs(corrected_smoothed_freq - SYNC_FREQ)) {
-                    // std::cout << "Transit to PORCH with m_afc_offset: " << m_afc_offset << "Hz" << std::endl;
-                    // std::cout << "Corrected smoothed freq:" << corrected_smoothed_freq << " Smoothed freq: " << smoothed_freq << " Origianl freq: " << freq << std::endl;
-                    // std::cout << "Sync duration sample num: " << sync_duration_samples <<
-                    //     " Porch duration sample num: " << porch_duration_samples << std::endl;
+                    validate_sync();
                     m_current_segment = SegmentType::PORCH;
                     m_segment_timer = static_cast<double>(MEDIAN_WINDOW + 1) / 2;
                     break;
@@ -142,36 +190,22 @@ bool PDDemodulator::process(float sample, double freq) {
             }
 
             // 超时退出
-            if (m_segment_timer >= sync_duration_samples) {
+            if (m_segment_timer >= m_sync_samples) {
+                validate_sync();
                 m_current_segment = SegmentType::PORCH;
-                // std::cout << "Timeout! Transit to PORCH with m_afc_offset: " << m_afc_offset << "Hz" << std::endl;
-                // std::cout << "Smoothed freq: " << smoothed_freq << " Origianl freq: " << freq << std::endl;
-                // std::cout << "Sync duration sample num: " << sync_duration_samples <<
-                //     " Porch duration sample num: " << porch_duration_samples << std::endl;
-                reserve_samples(sync_duration_samples);
+                m_stats.sync_timeouts.add();
+                reserve_samples(m_sync_samples);
             }
             break;
         }
 
         case SegmentType::PORCH:{
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 30) {
-            //     std::cout << "Debug [" << debug_counter << "]: corrected_freq = " << corrected_freq << " env12 = " << env12 << " env15 = " << env15 << std::endl;
-            //     debug_counter++;
-            // } else if (debug_counter == 30) {
-            //     std::cout << "Reached 30 debug outputs. Stopping output..." << std::endl;
-            //     // debug_counter++;
-            //     exit(0);
-            // }
-            if (m_segment_timer >= porch_duration_samples) {
+            if (m_segment_timer >= m_porch_samples) {
                 m_current_segment = SegmentType::Y1;
                 // 这里也进行硬重置，开始数据段的精确计数
-                // // Debug 调试代码重置
-                // debug_counter = 0;
-                reserve_samples(porch_duration_samples);
+                reserve_samples(m_porch_samples);
                 m_segment_buffer.clear();
-                m_segment_buffer.reserve(static_cast<size_t>(segment_duration_samples + 10));
+                m_segment_buffer.reserve(static_cast<size_t>(m_segment_samples + 10));
             }
             break;
         }
@@ -182,7 +216,7 @@ bool PDDemodulator::process(float sample, double freq) {
         case SegmentType::Y2:
             m_segment_buffer.push_back(corrected_freq);
 
-            if (m_segment_timer >= segment_duration_samples) {
+            if (m_segment_timer >= m_segment_samples) {
                 process_current_segment();
 
                 // 状态流转
@@ -194,7 +228,7 @@ bool PDDemodulator::process(float sample, double freq) {
                     m_current_segment = SegmentType::IDLE;
                     // Y2 结束回到 IDLE，不需要保留误差，因为我们需要等待下一个 Sync 信号
                     // 下一次 Sync 检测会自动消除之前的累积误差
-                    reserve_samples(segment_duration_samples);
+                    reserve_samples(m_segment_samples);
                     m_segment_buffer.clear();
                     break; // 跳出 switch
                 }
@@ -202,72 +236,237 @@ bool PDDemodulator::process(float sample, double freq) {
                 // 核心修复：保留小数部分的误差！
                 // 只有在数据段连续切换时（Y1->RY->BY->Y2），才保留时间残余
                 // 这样 0.64 + 0.64 + ... 最终会凑成一个完整的样本，自动修正漂移
-                m_segment_timer -= segment_duration_samples;
+                m_segment_timer -= m_segment_samples;
 
                 m_segment_buffer.clear();
             }
             break;
     }
+}
+
+void PDDemodulator::validate_sync() {
+    // 噪声也可能触发 IDLE -> SYNC 并“找到”跳变沿，只有频率确实停在 1200Hz 附近的同步才算锁定
+    if (m_sync_checks > 0 && 2 * m_sync_hits >= m_sync_checks) m_samples_since_sync = 0.0;
+}
+
+void PDDemodulator::track_sample(FreqSample corrected_freq) {
+    m_track_buffer.push_back(corrected_freq);
+    ++m_track_total;
+    if (static_cast<double>(m_track_total) >= m_next_decision) commit_sync();
+}
+
+void PDDemodulator::commit_sync() {
+    const int groups = (m_height + 1) / 2;
+    const double window = SYNC_SEARCH_MS * m_samples_per_ms;
+    const bool real_sync = m_syncs_committed < groups;
+
+    // 确定本次同步的位置：第一个同步在 VIS 之后的固定范围内搜索，之后在预测位置附近搜索；
+    // 最后一个行组之后没有同步脉冲，直接按周期外推
+    double sync = m_last_sync + m_line_period;
+    bool hit = false;
+    if (m_syncs_committed == 0) {
+        // 搜索范围远大于模板，窗口内的最低得分即为背景；没有可外推的依据，得分低也取最高分的位置
+        const SyncCandidate found = search_sync(0.0, FIRST_SYNC_SEARCH_MS * m_samples_per_ms);
+        hit = found.score - found.worst >= SYNC_CONTRAST_THRESHOLD;
+        sync = found.position;
+    } else if (real_sync) {
+        const SyncCandidate found = search_sync(sync - window, sync + window);
+        const float baseline = template_baseline(m_last_sync + m_sync_samples + m_porch_samples, sync - window);
+        hit = found.score - baseline >= SYNC_CONTRAST_THRESHOLD;
+        if (hit) sync = found.position;
+    }
+    if (real_sync) {
+
+        if (hit) {
+            m_stats.syncs_detected.add();
+            m_samples_since_sync = static_cast<double>(m_track_total) - sync;
+        } else {
+            m_stats.sync_timeouts.add();
+        }
+    }
+
+    if (m_syncs_committed > 0) {
+        // 相邻两个同步都可靠时更新周期，否则只用于外推
+        if (hit && m_last_sync_hit) {
+            const double measured = sync - m_last_sync;
+            if (std::abs(measured / line_group_samples() - 1.0) < MAX_PERIOD_ERROR) {
+                m_line_period += PERIOD_ALPHA * (measured - m_line_period);
+            }
+        }
+        decode_tracked_group(m_last_sync, sync);
+    }
 
-    if (m_current_line_idx >= m_height) {
-        return true;
+    if (hit) {
+        // 同步中段的残余频偏，只统计接近 1200Hz 的样本
+        const size_t begin = static_cast<size_t>(sync + 0.25 * m_sync_samples) - m_track_start;
+        const size_t end = static_cast<size_t>(sync + 0.75 * m_sync_samples) - m_track_start;
+        double residual = 0.0;
+        size_t count = 0;
+        for (size_t i = begin; i < end && i < m_track_buffer.size(); ++i) {
+            const double r = m_track_buffer[i] - SYNC_FREQ;
+            if (std::abs(r) < 2.0 * FREQ_TOLERANCE) {
+                residual += r;
+                ++count;
+            }
+        }
+        if (2 * count >= end - begin) m_afc_offset += AFC_ALPHA * (residual / static_cast<double>(count));
+    }
+
+    m_last_sync = sync;
+    m_last_sync_hit = hit;
+    ++m_syncs_committed;
+    if (m_current_line_idx >= m_height) return;
+
+    // 下一次判定需要预测窗口右端之后的完整模板；最后一个行组只需收满数据段
+    m_next_decision = m_syncs_committed < groups
+        ? sync + m_line_period + window + m_sync_samples + m_porch_samples + 1.0
+        : sync + m_line_period + 1.0;
+
+    // 丢弃本次同步之前的样本
+    const uint64_t keep_from = static_cast<uint64_t>(std::max(sync, 0.0));
+    if (keep_from > m_track_start) {
+        m_track_buffer.erase(m_track_buffer.begin(), m_track_buffer.begin() + static_cast<std::ptrdiff_t>(keep_from - m_track_start));
+        m_track_start = keep_from;
+    }
+}
+
+PDDemodulator::SyncCandidate PDDemodulator::search_sync(double lo, double hi) {
+    const size_t sync_len = static_cast<size_t>(std::lround(m_sync_samples));
+    const size_t porch_len = static_cast<size_t>(std::lround(m_porch_samples));
+    const size_t template_len = sync_len + porch_len;
+
+    const uint64_t first = std::max(static_cast<uint64_t>(std::max(std::ceil(lo), 0.0)), m_track_start);
+    const uint64_t last = std::min(static_cast<uint64_t>(std::max(std::floor(hi), 0.0)), m_track_total - template_len);
+    if (last < first) return {lo};
+    const size_t candidates = static_cast<size_t>(last - first) + 1;
+    const size_t n = candidates + template_len - 1;
+    const FreqSample* freq = m_track_buffer.data() + (first - m_track_start);
+
+    // 逐样本匹配度：1200Hz / 1500Hz 处为 1，偏离 TEMPLATE_SPAN_HZ 处为 0，最低 -1（无分支，可向量化）
+    m_sync_score.resize(n + 1);
+    m_porch_score.resize(n + 1);
+    float* g = m_sync_score.data();
+    float* h = m_porch_score.data();
+    g[0] = h[0] = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const float f = static_cast<float>(freq[i]);
+        g[i + 1] = std::clamp(1.0f - std::abs(f - static_cast<float>(SYNC_FREQ)) / TEMPLATE_SPAN_HZ, -1.0f, 1.0f);
+        h[i + 1] = std::clamp(1.0f - std::abs(f - static_cast<float>(BLACK_FREQ)) / TEMPLATE_SPAN_HZ, -1.0f, 1.0f);
+    }
+    // 前缀和：每个候选位置的模板相关值只需 4 次查表
+    for (size_t i = 1; i <= n; ++i) {
+        g[i] += g[i - 1];
+        h[i] += h[i - 1];
+    }
+
+    auto score_at = [&](size_t k) {
+        return (g[k + sync_len] - g[k]) + (h[k + template_len] - h[k + sync_len]);
+    };
+    size_t best = 0;
+    float best_raw = score_at(0);
+    float worst_raw = best_raw;
+    for (size_t k = 1; k < candidates; ++k) {
+        const float s = score_at(k);
+        if (s > best_raw) {
+            best_raw = s;
+            best = k;
+        }
+        worst_raw = std::min(worst_raw, s);
+    }
+
+    // 抛物线插值得到亚样本位置
+    double position = static_cast<double>(best);
+    if (best > 0 && best + 1 < candidates) {
+        const float left = score_at(best - 1);
+        const float right = score_at(best + 1);
+        const float curvature = left - 2.0f * best_raw + right;
+        if (curvature < 0.0f) position += std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5);
     }
-    return false;
+    return {static_cast<double>(first) + position, best_raw / static_cast<float>(template_len),
+            worst_raw / static_cast<float>(template_len)};
+}
+
+float PDDemodulator::template_baseline(double begin, double end) const {
+    // 数据段上模板两部分的平均匹配度，按模板中同步 / 后沿的长度加权
+    const size_t a = track_offset(begin);
+    const size_t b = track_offset(end);
+    if (b <= a) return -1.0f;
+
+    float sync_sum = 0.0f;
+    float porch_sum = 0.0f;
+    for (size_t i = a; i < b; ++i) {
+        const float f = static_cast<float>(m_track_buffer[i]);
+        sync_sum += std::clamp(1.0f - std::abs(f - static_cast<float>(SYNC_FREQ)) / TEMPLATE_SPAN_HZ, -1.0f, 1.0f);
+        porch_sum += std::clamp(1.0f - std::abs(f - static_cast<float>(BLACK_FREQ)) / TEMPLATE_SPAN_HZ, -1.0f, 1.0f);
+    }
+    const double sync_weight = m_sync_samples / (m_sync_samples + m_porch_samples);
+    return static_cast<float>((sync_weight * sync_sum + (1.0 - sync_weight) * porch_sum) / static_cast<double>(b - a));
+}
+
+size_t PDDemodulator::track_offset(double position) const {
+    const double offset = std::round(position) - static_cast<double>(m_track_start);
+    return static_cast<size_t>(std::clamp(offset, 0.0, static_cast<double>(m_track_buffer.size())));
+}
+
+void PDDemodulator::decode_tracked_group(double sync_start, double next_sync) {
+    // 按实测同步间隔等比例伸缩各段，就地校正采样率偏差引起的倾斜
+    const double scale = (next_sync - sync_start) / line_group_samples();
+    const double data_start = sync_start + (m_sync_samples + m_porch_samples) * scale;
+    const double segment = m_segment_samples * scale;
+
+    auto segment_span = [&](int index) {
+        const double begin = data_start + index * segment;
+        const size_t a = track_offset(begin);
+        const size_t b = track_offset(begin + segment);
+        return std::span<const FreqSample>(m_track_buffer.data() + a, b - a);
+    };
+    resample_segment(segment_span(0), m_y1_pixels);
+    resample_segment(segment_span(1), m_cr_pixels);
+    resample_segment(segment_span(2), m_cb_pixels);
+    resample_segment(segment_span(3), m_y2_pixels);
+    finalize_line_group();
 }
 
 void PDDemodulator::process_current_segment() {
-    std::vector<uint8_t> pixels = resample_segment(m_segment_buffer, m_width);
     switch (m_current_segment) {
-        case SegmentType::Y1: m_y1_pixels = std::move(pixels); break;
-        case SegmentType::RY: m_cr_pixels = std::move(pixels); break;
-        case SegmentType::BY: m_cb_pixels = std::move(pixels); break;
-        case SegmentType::Y2: m_y2_pixels = std::move(pixels); break;
+        case SegmentType::Y1: resample_segment(m_segment_buffer, m_y1_pixels); break;
+        case SegmentType::RY: resample_segment(m_segment_buffer, m_cr_pixels); break;
+        case SegmentType::BY: resample_segment(m_segment_buffer, m_cb_pixels); break;
+        case SegmentType::Y2: resample_segment(m_segment_buffer, m_y2_pixels); break;
         default: break;
     }
 }
 
-std::vector<uint8_t> PDDemodulator::resample_segment(const std::vector<double>& buffer, int target_count) {
-    if (buffer.empty()) return std::vector<uint8_t>(target_count, 0);
-    std::vector<uint8_t> result(target_count);
-    double src_size = static_cast<double>(buffer.size());
-
-    for (int i = 0; i < target_count; ++i) {
-        double pos = (static_cast<double>(i) / target_count) * src_size;
-        size_t idx_a = static_cast<size_t>(pos);
-        size_t idx_b = std::min(idx_a + 1, buffer.size() - 1);
-        double weight = pos - idx_a;
+void PDDemodulator::resample_segment(std::span<const FreqSample> buffer, std::span<uint8_t> out) {
+    if (buffer.empty()) {
+        std::fill(out.begin(), out.end(), uint8_t{0});
+        return;
+    }
+    // 线性插值频率，然后再转像素值（整行 SIMD 核）
+    dsp::simd::resample_to_pixels(buffer.data(), buffer.size(), out.data(), out.size());
+}
 
-        // 线性插值频率，然后再转像素值
-        double interpolated_freq = buffer[idx_a] * (1.0 - weight) + buffer[idx_b] * weight;
-        result[i] = dsp::freq_to_pixel_value(interpolated_freq);
+std::span<Pixel> PDDemodulator::line_output(int line_idx) {
+    const size_t width = static_cast<size_t>(m_width);
+    const size_t offset = static_cast<size_t>(line_idx) * width;
+    if (offset + width <= m_frame_buffer.size()) {
+        return m_frame_buffer.subspan(offset, width);
     }
-    return result;
+    return m_line_pixels;
 }
 
 void PDDemodulator::finalize_line_group() {
     if (m_y1_pixels.empty() || m_y2_pixels.empty() || m_cr_pixels.empty() || m_cb_pixels.empty()) return;
 
-    if (m_current_line_idx < m_height) {
-        std::vector<Pixel> line1(m_width);
-        for (int i = 0; i < m_width; ++i) line1[i] = ycbcr_to_rgb(m_y1_pixels[i], m_cb_pixels[i], m_cr_pixels[i]);
-        m_on_line_decoded(m_current_line_idx++, line1);
-    }
-    if (m_current_line_idx < m_height) {
-        std::vector<Pixel> line2(m_width);
-        for (int i = 0; i < m_width; ++i) line2[i] = ycbcr_to_rgb(m_y2_pixels[i], m_cb_pixels[i], m_cr_pixels[i]);
-        m_on_line_decoded(m_current_line_idx++, line2);
+    // 两行共用同一组色差分量，分别与 Y1 / Y2 组合
+    for (const std::vector<uint8_t>* luma : {&m_y1_pixels, &m_y2_pixels}) {
+        if (m_current_line_idx >= m_height) break;
+        std::span<Pixel> line = line_output(m_current_line_idx);
+        dsp::simd::ycbcr_to_rgb_row(luma->data(), m_cb_pixels.data(), m_cr_pixels.data(),
+                                    reinterpret_cast<uint8_t*>(line.data()), line.size());
+        m_on_line_decoded(m_current_line_idx++, line);
     }
     if (m_current_line_idx >= m_height) m_on_image_complete(m_width, m_height);
 }
 
-Pixel PDDemodulator::ycbcr_to_rgb(uint8_t Y, uint8_t Cb, uint8_t Cr) {
-    int y = Y - 16;
-    int cb = Cb - 128;
-    int cr = Cr - 128;
-    int r = (298 * y + 409 * cr + 128) >> 8;
-    int g = (298 * y - 100 * cb - 208 * cr + 128) >> 8;
-    int b = (298 * y + 516 * cb + 128) >> 8;
-    return { static_cast<uint8_t>(std::clamp(r, 0, 255)), static_cast<uint8_t>(std::clamp(g, 0, 255)), static_cast<uint8_t>(std::clamp(b, 0, 255)) };
-}
-
 } // namespace sstv
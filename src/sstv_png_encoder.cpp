@@ -0,0 +1,547 @@
+#include "sstv_png_encoder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace sstv {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr size_t HASH_BITS = 15;
+constexpr size_t HASH_SIZE = size_t{1} << HASH_BITS;
+
+constexpr unsigned MAX_CODE_BITS = 15;
+constexpr unsigned MAX_CODE_LENGTH_BITS = 7;
+constexpr size_t LITLEN_CODES = 286;
+constexpr size_t DISTANCE_CODES = 30;
+constexpr size_t CODE_LENGTH_CODES = 19;
+constexpr uint16_t END_OF_BLOCK = 256;
+constexpr uint16_t FIRST_LENGTH_CODE = 257;
+
+// RFC 1951 section 3.2.5
+constexpr std::array<uint16_t, 29> LENGTH_BASE = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<uint8_t, 29> LENGTH_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<uint16_t, 30> DISTANCE_BASE = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<uint8_t, 30> DISTANCE_EXTRA = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order in which the code-length code lengths are sent (section 3.2.7)
+constexpr std::array<uint8_t, CODE_LENGTH_CODES> CODE_LENGTH_ORDER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Match length - MIN_MATCH -> index into LENGTH_BASE
+constexpr std::array<uint8_t, MAX_MATCH - MIN_MATCH + 1> LENGTH_CODE = [] {
+    std::array<uint8_t, MAX_MATCH - MIN_MATCH + 1> code{};
+    for (size_t c = 0; c + 1 < LENGTH_BASE.size(); ++c) {
+        for (size_t i = 0; i < (size_t{1} << LENGTH_EXTRA[c]); ++i) code[LENGTH_BASE[c] - MIN_MATCH + i] = static_cast<uint8_t>(c);
+    }
+    code[MAX_MATCH - MIN_MATCH] = static_cast<uint8_t>(LENGTH_BASE.size() - 1);  // 258 has its own code
+    return code;
+}();
+
+constexpr std::array<uint32_t, 256> CRC_TABLE = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[n] = c;
+    }
+    return table;
+}();
+
+// Distance 1..32768 -> index into DISTANCE_BASE: two codes per power of two above 4
+unsigned distance_code(unsigned distance) {
+    if (distance <= 4) return distance - 1;
+    const unsigned v = distance - 1;
+    const unsigned bits = static_cast<unsigned>(std::bit_width(v)) - 1;
+    return 2 * bits + ((v >> (bits - 1)) & 1);
+}
+
+size_t hash3(const uint8_t* p) {
+    return ((static_cast<size_t>(p[0]) << 10) ^ (static_cast<size_t>(p[1]) << 5) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+uint32_t adler32(uint32_t adler, std::span<const uint8_t> data) {
+    constexpr uint32_t MOD = 65521;
+    constexpr size_t NMAX = 5552;  // Largest run before b can overflow 32 bits
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (!data.empty()) {
+        const size_t n = std::min(data.size(), NMAX);
+        for (size_t i = 0; i < n; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= MOD;
+        b %= MOD;
+        data = data.subspan(n);
+    }
+    return (b << 16) | a;
+}
+
+// Length-limited Huffman code lengths for `freq` (unused symbols get 0).
+// Whenever a symbol is used, the result is a complete code of at least two
+// codes, which every inflater accepts.
+void build_code_lengths(std::span<const uint32_t> freq, unsigned max_bits, std::span<uint8_t> lengths) {
+    std::fill(lengths.begin(), lengths.end(), uint8_t{0});
+    std::array<uint16_t, LITLEN_CODES> symbols;
+    size_t n = 0;
+    for (size_t i = 0; i < freq.size(); ++i) {
+        if (freq[i]) symbols[n++] = static_cast<uint16_t>(i);
+    }
+    if (n == 0) return;
+    if (n == 1) {
+        lengths[symbols[0]] = 1;
+        lengths[symbols[0] == 0 ? 1 : 0] = 1;
+        return;
+    }
+    std::sort(symbols.begin(), symbols.begin() + static_cast<std::ptrdiff_t>(n), [&](uint16_t a, uint16_t b) {
+        return freq[a] != freq[b] ? freq[a] < freq[b] : a < b;
+    });
+
+    // Two-queue construction: leaves [0, n) in frequency order, internal nodes
+    // [n, 2n - 1) in creation order (which is also weight order)
+    std::array<uint64_t, 2 * LITLEN_CODES> weight;
+    std::array<uint16_t, 2 * LITLEN_CODES> parent;
+    for (size_t i = 0; i < n; ++i) weight[i] = freq[symbols[i]];
+    size_t leaf = 0;
+    size_t internal = n;
+    size_t next = n;
+    auto take = [&] {
+        if (leaf < n && (internal == next || weight[leaf] <= weight[internal])) return leaf++;
+        return internal++;
+    };
+    for (; next < 2 * n - 1; ++next) {
+        const size_t a = take();
+        const size_t b = take();
+        weight[next] = weight[a] + weight[b];
+        parent[a] = parent[b] = static_cast<uint16_t>(next);
+    }
+    // Parents always come after their children, so one backward pass gives every depth
+    std::array<uint16_t, 2 * LITLEN_CODES> depth;
+    depth[2 * n - 2] = 0;
+    for (size_t i = 2 * n - 2; i-- > 0;) depth[i] = static_cast<uint16_t>(depth[parent[i]] + 1);
+
+    // Clamp to max_bits, then lengthen the shortest codes that can give up
+    // space until the Kraft sum fits again
+    std::array<uint32_t, MAX_CODE_BITS + 2> count{};
+    for (size_t i = 0; i < n; ++i) ++count[std::min<unsigned>(depth[i], max_bits)];
+    uint32_t total = 0;
+    for (unsigned bits = 1; bits <= max_bits; ++bits) total += count[bits] << (max_bits - bits);
+    while (total > (1u << max_bits)) {
+        --count[max_bits];
+        for (unsigned bits = max_bits - 1; bits > 0; --bits) {
+            if (count[bits]) {
+                --count[bits];
+                count[bits + 1] += 2;
+                break;
+            }
+        }
+        --total;
+    }
+
+    // The longest codes go to the rarest symbols
+    size_t i = 0;
+    for (unsigned bits = max_bits; bits > 0; --bits) {
+        for (uint32_t k = 0; k < count[bits]; ++k) lengths[symbols[i++]] = static_cast<uint8_t>(bits);
+    }
+}
+
+// Canonical codes (section 3.2.2), bit-reversed because deflate sends Huffman codes MSB first
+void assign_codes(std::span<const uint8_t> lengths, std::span<uint16_t> codes) {
+    std::array<uint16_t, MAX_CODE_BITS + 1> count{};
+    for (uint8_t length : lengths) {
+        if (length) ++count[length];
+    }
+    std::array<uint16_t, MAX_CODE_BITS + 1> next{};
+    uint16_t code = 0;
+    for (unsigned bits = 1; bits <= MAX_CODE_BITS; ++bits) {
+        code = static_cast<uint16_t>((code + count[bits - 1]) << 1);
+        next[bits] = code;
+    }
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        const unsigned length = lengths[i];
+        if (!length) continue;
+        const uint16_t value = next[length]++;
+        uint16_t reversed = 0;
+        for (unsigned b = 0; b < length; ++b) reversed = static_cast<uint16_t>(reversed | (((value >> b) & 1) << (length - 1 - b)));
+        codes[i] = reversed;
+    }
+}
+
+void put_be32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value >> 24);
+    dst[1] = static_cast<uint8_t>(value >> 16);
+    dst[2] = static_cast<uint8_t>(value >> 8);
+    dst[3] = static_cast<uint8_t>(value);
+}
+
+} // namespace
+
+uint32_t crc32(std::span<const uint8_t> data, uint32_t crc) {
+    uint32_t c = ~crc;
+    for (uint8_t byte : data) c = CRC_TABLE[(c ^ byte) & 0xFF] ^ (c >> 8);
+    return ~c;
+}
+
+// ---------------------------------------------------------------------------
+// Deflater
+// ---------------------------------------------------------------------------
+
+Deflater::Deflater() : m_window(2 * WINDOW), m_head(HASH_SIZE), m_prev(WINDOW) {
+    m_symbols.reserve(BLOCK_SYMBOLS);
+    reset();
+}
+
+void Deflater::reset() {
+    m_base = m_pos = m_end = 0;
+    std::fill(m_head.begin(), m_head.end(), 0u);
+    std::fill(m_prev.begin(), m_prev.end(), 0u);
+    m_symbols.clear();
+    m_adler = 1;
+    m_bit_buffer = 0;
+    m_bit_count = 0;
+    m_out.clear();
+    // CM = 8 (deflate), 32 KiB window, FCHECK makes the header a multiple of 31
+    m_out.push_back(0x78);
+    m_out.push_back(0x01);
+}
+
+void Deflater::write(std::span<const uint8_t> data) {
+    m_adler = adler32(m_adler, data);
+    while (!data.empty()) {
+        if (m_end == m_window.size()) slide();
+        const size_t n = std::min(data.size(), m_window.size() - m_end);
+        std::memcpy(m_window.data() + m_end, data.data(), n);
+        m_end += n;
+        data = data.subspan(n);
+        compress(false);
+    }
+}
+
+void Deflater::finish() {
+    compress(true);
+    emit_block(true);
+    align_to_byte();
+    uint8_t trailer[4];
+    put_be32(trailer, m_adler);
+    m_out.insert(m_out.end(), trailer, trailer + 4);
+}
+
+void Deflater::compress(bool flush) {
+    // Without flush, keep a full match of lookahead so matches never stop at a write() boundary
+    while (m_pos < m_end && (flush || m_end - m_pos >= MAX_MATCH)) {
+        const size_t available = std::min(MAX_MATCH, m_end - m_pos);
+        size_t best_length = 0;
+        size_t best_distance = 0;
+        if (available >= MIN_MATCH) {
+            const uint8_t* current = m_window.data() + m_pos;
+            const size_t position = m_base + m_pos;
+            uint32_t candidate = m_head[hash3(current)];
+            for (size_t chain = MAX_CHAIN; candidate != 0 && chain > 0; --chain) {
+                const size_t match = candidate - 1;
+                const size_t distance = position - match;
+                if (distance > WINDOW) break;
+                const uint8_t* reference = current - distance;
+                if (reference[best_length] == current[best_length]) {
+                    size_t length = 0;
+                    while (length < available && reference[length] == current[length]) ++length;
+                    if (length > best_length) {
+                        best_length = length;
+                        best_distance = distance;
+                        if (length == available) break;
+                    }
+                }
+                const uint32_t older = m_prev[match & (WINDOW - 1)];
+                if (older >= candidate) break;
+                candidate = older;
+            }
+        }
+
+        if (best_length >= MIN_MATCH) {
+            m_symbols.push_back({static_cast<uint16_t>(best_length), static_cast<uint16_t>(best_distance)});
+            for (size_t i = 0; i < best_length; ++i) insert_hash(m_pos + i);
+            m_pos += best_length;
+        } else {
+            m_symbols.push_back({m_window[m_pos], 0});
+            insert_hash(m_pos);
+            ++m_pos;
+        }
+        if (m_symbols.size() >= BLOCK_SYMBOLS) emit_block(false);
+    }
+}
+
+void Deflater::insert_hash(size_t index) {
+    if (index + MIN_MATCH > m_end) return;
+    const size_t h = hash3(m_window.data() + index);
+    const size_t position = m_base + index;
+    m_prev[position & (WINDOW - 1)] = m_head[h];
+    m_head[h] = static_cast<uint32_t>(position + 1);
+}
+
+void Deflater::slide() {
+    // Keep one window of history behind the next byte to encode; the hash
+    // tables hold stream positions, so they stay valid
+    const size_t shift = m_pos > WINDOW ? m_pos - WINDOW : 0;
+    if (shift == 0) return;
+    std::memmove(m_window.data(), m_window.data() + shift, m_end - shift);
+    m_base += shift;
+    m_pos -= shift;
+    m_end -= shift;
+}
+
+void Deflater::emit_block(bool final) {
+    if (m_symbols.empty()) {
+        // Fixed-Huffman block holding only the end-of-block code (7 zero bits)
+        if (final) {
+            put_bits(1, 1);
+            put_bits(1, 2);
+            put_bits(0, 7);
+        }
+        return;
+    }
+
+    std::array<uint32_t, LITLEN_CODES> litlen_freq{};
+    std::array<uint32_t, DISTANCE_CODES> distance_freq{};
+    for (const Symbol& s : m_symbols) {
+        if (s.distance == 0) {
+            ++litlen_freq[s.value];
+        } else {
+            ++litlen_freq[FIRST_LENGTH_CODE + LENGTH_CODE[s.value - MIN_MATCH]];
+            ++distance_freq[distance_code(s.distance)];
+        }
+    }
+    litlen_freq[END_OF_BLOCK] = 1;
+
+    std::array<uint8_t, LITLEN_CODES> litlen_lengths;
+    std::array<uint8_t, DISTANCE_CODES> distance_lengths;
+    build_code_lengths(litlen_freq, MAX_CODE_BITS, litlen_lengths);
+    build_code_lengths(distance_freq, MAX_CODE_BITS, distance_lengths);
+    if (std::all_of(distance_lengths.begin(), distance_lengths.end(), [](uint8_t l) { return l == 0; })) {
+        distance_lengths[0] = distance_lengths[1] = 1;  // Unused, but keeps the distance code complete
+    }
+    std::array<uint16_t, LITLEN_CODES> litlen_codes{};
+    std::array<uint16_t, DISTANCE_CODES> distance_codes{};
+    assign_codes(litlen_lengths, litlen_codes);
+    assign_codes(distance_lengths, distance_codes);
+
+    size_t hlit = LITLEN_CODES;
+    while (hlit > FIRST_LENGTH_CODE && litlen_lengths[hlit - 1] == 0) --hlit;
+    size_t hdist = DISTANCE_CODES;
+    while (hdist > 1 && distance_lengths[hdist - 1] == 0) --hdist;
+
+    // Run-length code both length tables as one sequence (section 3.2.7):
+    // 16 repeats the previous length 3-6 times, 17 / 18 send 3-10 / 11-138 zeros
+    std::array<uint8_t, LITLEN_CODES + DISTANCE_CODES> all_lengths;
+    std::copy_n(litlen_lengths.begin(), hlit, all_lengths.begin());
+    std::copy_n(distance_lengths.begin(), hdist, all_lengths.begin() + static_cast<std::ptrdiff_t>(hlit));
+    const size_t total = hlit + hdist;
+
+    struct RunLength {
+        uint8_t symbol;
+        uint8_t extra;
+    };
+    std::array<RunLength, LITLEN_CODES + DISTANCE_CODES> runs;
+    size_t run_count = 0;
+    for (size_t i = 0; i < total;) {
+        const uint8_t length = all_lengths[i];
+        size_t run = 1;
+        while (i + run < total && all_lengths[i + run] == length) ++run;
+        i += run;
+        if (length == 0) {
+            while (run >= 11) {
+                const size_t n = std::min<size_t>(run, 138);
+                runs[run_count++] = {18, static_cast<uint8_t>(n - 11)};
+                run -= n;
+            }
+            if (run >= 3) {
+                runs[run_count++] = {17, static_cast<uint8_t>(run - 3)};
+                run = 0;
+            }
+        } else {
+            runs[run_count++] = {length, 0};
+            --run;
+            while (run >= 3) {
+                const size_t n = std::min<size_t>(run, 6);
+                runs[run_count++] = {16, static_cast<uint8_t>(n - 3)};
+                run -= n;
+            }
+        }
+        for (; run > 0; --run) runs[run_count++] = {length, 0};
+    }
+
+    std::array<uint32_t, CODE_LENGTH_CODES> code_length_freq{};
+    for (size_t i = 0; i < run_count; ++i) ++code_length_freq[runs[i].symbol];
+    std::array<uint8_t, CODE_LENGTH_CODES> code_length_lengths;
+    std::array<uint16_t, CODE_LENGTH_CODES> code_length_codes{};
+    build_code_lengths(code_length_freq, MAX_CODE_LENGTH_BITS, code_length_lengths);
+    assign_codes(code_length_lengths, code_length_codes);
+    size_t hclen = CODE_LENGTH_CODES;
+    while (hclen > 4 && code_length_lengths[CODE_LENGTH_ORDER[hclen - 1]] == 0) --hclen;
+
+    put_bits(final ? 1 : 0, 1);
+    put_bits(2, 2);  // Dynamic Huffman
+    put_bits(static_cast<uint32_t>(hlit - FIRST_LENGTH_CODE), 5);
+    put_bits(static_cast<uint32_t>(hdist - 1), 5);
+    put_bits(static_cast<uint32_t>(hclen - 4), 4);
+    for (size_t i = 0; i < hclen; ++i) put_bits(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+    for (size_t i = 0; i < run_count; ++i) {
+        const RunLength& r = runs[i];
+        put_bits(code_length_codes[r.symbol], code_length_lengths[r.symbol]);
+        if (r.symbol == 16) put_bits(r.extra, 2);
+        else if (r.symbol == 17) put_bits(r.extra, 3);
+        else if (r.symbol == 18) put_bits(r.extra, 7);
+    }
+
+    for (const Symbol& s : m_symbols) {
+        if (s.distance == 0) {
+            put_bits(litlen_codes[s.value], litlen_lengths[s.value]);
+            continue;
+        }
+        const size_t lc = LENGTH_CODE[s.value - MIN_MATCH];
+        put_bits(litlen_codes[FIRST_LENGTH_CODE + lc], litlen_lengths[FIRST_LENGTH_CODE + lc]);
+        put_bits(s.value - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+        const unsigned dc = distance_code(s.distance);
+        put_bits(distance_codes[dc], distance_lengths[dc]);
+        put_bits(s.distance - DISTANCE_BASE[dc], DISTANCE_EXTRA[dc]);
+    }
+    put_bits(litlen_codes[END_OF_BLOCK], litlen_lengths[END_OF_BLOCK]);
+    m_symbols.clear();
+}
+
+void Deflater::put_bits(uint32_t value, unsigned count) {
+    m_bit_buffer |= static_cast<uint64_t>(value) << m_bit_count;
+    m_bit_count += count;
+    while (m_bit_count >= 8) {
+        m_out.push_back(static_cast<uint8_t>(m_bit_buffer));
+        m_bit_buffer >>= 8;
+        m_bit_count -= 8;
+    }
+}
+
+void Deflater::align_to_byte() {
+    if (m_bit_count > 0) m_out.push_back(static_cast<uint8_t>(m_bit_buffer));
+    m_bit_buffer = 0;
+    m_bit_count = 0;
+}
+
+// ---------------------------------------------------------------------------
+// PngEncoder
+// ---------------------------------------------------------------------------
+
+PngEncoder::PngEncoder(std::ostream& out, int width, int height)
+    : m_out(out), m_width(width), m_height(height)
+{
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("PNG: invalid image size");
+    }
+    m_stride = static_cast<size_t>(width) * sizeof(Pixel);
+    m_previous.assign(m_stride, 0);
+    m_current.assign(m_stride, 0);
+    for (auto& row : m_filtered) row.assign(m_stride + 1, 0);
+
+    static constexpr uint8_t SIGNATURE[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    m_out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+    uint8_t header[13];
+    put_be32(header, static_cast<uint32_t>(width));
+    put_be32(header + 4, static_cast<uint32_t>(height));
+    header[8] = 8;   // Bits per channel
+    header[9] = 2;   // Truecolour (RGB)
+    header[10] = 0;  // Deflate
+    header[11] = 0;  // Adaptive filtering
+    header[12] = 0;  // Not interlaced
+    write_chunk("IHDR", header);
+}
+
+void PngEncoder::write_row(std::span<const Pixel> row) {
+    if (m_finished || m_rows_written >= m_height) return;
+
+    const size_t pixels = std::min(row.size(), static_cast<size_t>(m_width));
+    if (pixels) std::memcpy(m_current.data(), row.data(), pixels * sizeof(Pixel));
+    std::fill(m_current.begin() + static_cast<std::ptrdiff_t>(pixels * sizeof(Pixel)), m_current.end(), uint8_t{0});
+
+    // Filter types 0-4 (None, Sub, Up, Average, Paeth); a = left, b = up, c = up-left
+    constexpr size_t BPP = sizeof(Pixel);
+    const uint8_t* x = m_current.data();
+    const uint8_t* up = m_previous.data();
+    std::array<uint8_t*, 5> out;
+    for (size_t f = 0; f < out.size(); ++f) {
+        m_filtered[f][0] = static_cast<uint8_t>(f);
+        out[f] = m_filtered[f].data() + 1;
+    }
+    std::array<uint32_t, 5> score{};
+    auto cost = [](uint8_t v) { return static_cast<uint32_t>(v < 128 ? v : 256 - v); };
+    for (size_t i = 0; i < m_stride; ++i) {
+        const int a = i >= BPP ? x[i - BPP] : 0;
+        const int b = up[i];
+        const int c = i >= BPP ? up[i - BPP] : 0;
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        const int paeth = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+
+        out[0][i] = x[i];
+        out[1][i] = static_cast<uint8_t>(x[i] - a);
+        out[2][i] = static_cast<uint8_t>(x[i] - b);
+        out[3][i] = static_cast<uint8_t>(x[i] - ((a + b) >> 1));
+        out[4][i] = static_cast<uint8_t>(x[i] - paeth);
+        for (size_t f = 0; f < out.size(); ++f) score[f] += cost(out[f][i]);
+    }
+    const size_t best = static_cast<size_t>(std::min_element(score.begin(), score.end()) - score.begin());
+
+    m_deflater.write(m_filtered[best]);
+    std::swap(m_previous, m_current);
+    ++m_rows_written;
+    write_idat(false);
+}
+
+void PngEncoder::finish() {
+    if (m_finished) return;
+    while (m_rows_written < m_height) write_row({});
+    m_deflater.finish();
+    write_idat(true);
+    write_chunk("IEND", {});
+    m_out.flush();
+    if (!m_out) {
+        throw std::runtime_error("PNG: write failed");
+    }
+    m_finished = true;
+}
+
+void PngEncoder::write_idat(bool all) {
+    std::vector<uint8_t>& compressed = m_deflater.output();
+    if (compressed.size() >= IDAT_BYTES || (all && !compressed.empty())) {
+        write_chunk("IDAT", compressed);
+        compressed.clear();
+    }
+}
+
+void PngEncoder::write_chunk(const char (&type)[5], std::span<const uint8_t> data) {
+    uint8_t prefix[8];
+    put_be32(prefix, static_cast<uint32_t>(data.size()));
+    std::memcpy(prefix + 4, type, 4);
+    uint8_t suffix[4];
+    put_be32(suffix, crc32(data, crc32(std::span<const uint8_t>(prefix + 4, 4))));
+
+    m_out.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+    m_out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    m_out.write(reinterpret_cast<const char*>(suffix), sizeof(suffix));
+    if (!m_out) {
+        throw std::runtime_error("PNG: write failed");
+    }
+}
+
+} // namespace sstv
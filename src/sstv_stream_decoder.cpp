@@ -0,0 +1,142 @@
+#include "sstv_stream_decoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace sstv {
+
+StreamDecoder::StreamDecoder(double sample_rate, size_t block_size, size_t buffer_samples,
+                             dsp::ResamplerMode resampler)
+    : m_decoder(sample_rate, resampler),
+      m_ring(buffer_samples ? buffer_samples : static_cast<size_t>(sample_rate * DEFAULT_BUFFER_SECONDS)),
+      m_sample_rate(sample_rate),
+      m_block_size(block_size)
+{
+    if (block_size == 0) {
+        throw std::runtime_error("StreamDecoder: block size must be positive");
+    }
+    if (m_ring.capacity() < block_size) {
+        throw std::runtime_error("StreamDecoder: buffer must hold at least one block");
+    }
+    m_block.resize(block_size);
+}
+
+StreamDecoder::~StreamDecoder() {
+    try {
+        stop();
+    } catch (...) {
+        // A decoding error can only be reported by an explicit stop()
+    }
+}
+
+void StreamDecoder::start() {
+    if (running()) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = false;
+        m_error = nullptr;
+    }
+    m_unflushed = 0;
+    m_thread = std::thread([this] { run(); });
+}
+
+void StreamDecoder::stop() {
+    if (!running()) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake_cv.notify_one();
+    m_thread.join();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(m_mutex);
+        std::swap(error, m_error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+size_t StreamDecoder::push(const float* samples, size_t count) noexcept {
+    const size_t accepted = m_ring.push(samples, count);
+    m_pushed.store(m_pushed.load(std::memory_order_relaxed) + accepted, std::memory_order_release);
+    if (accepted < count) {
+        m_overruns.store(m_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_dropped.store(m_dropped.load(std::memory_order_relaxed) + (count - accepted), std::memory_order_relaxed);
+    }
+    return accepted;
+}
+
+void StreamDecoder::flush() {
+    const uint64_t target = m_pushed.load(std::memory_order_acquire);
+    std::unique_lock lock(m_mutex);
+    if (!running()) {
+        if (m_processed < target) throw std::runtime_error("StreamDecoder: flush() requires a running decoder thread");
+        return;
+    }
+    ++m_flush_requests;
+    m_wake_cv.notify_one();
+    m_progress_cv.wait(lock, [&] { return m_processed >= target || m_error; });
+    --m_flush_requests;
+    if (m_error) throw std::runtime_error("StreamDecoder: decoder thread failed, see stop()");
+}
+
+void StreamDecoder::run() {
+    using namespace std::chrono;
+
+    size_t last_queued = 0;
+    while (true) {
+        const size_t queued = m_ring.size();
+        bool stopping, flushing;
+        {
+            std::lock_guard lock(m_mutex);
+            stopping = m_stopping;
+            flushing = m_flush_requests > 0;
+        }
+
+        // Decode in full blocks; a partial block only when the source has gone
+        // quiet (no growth since the last wait), or on flush / stop
+        const bool decode = queued >= m_block_size || (queued > 0 && (queued == last_queued || stopping || flushing));
+        // Nothing left to decode but THROUGHPUT mode may still hold samples back
+        const bool drain = !decode && m_unflushed > 0 && (stopping || flushing);
+        if (decode || drain) {
+            const size_t n = decode ? m_ring.pop(m_block.data(), m_block_size) : 0;
+            // Samples only count as processed once the decoder has flushed them: on a
+            // partial block (the source paused), or once the ring drains for flush / stop
+            const bool complete = n < m_block_size || ((stopping || flushing) && m_ring.size() == 0);
+            try {
+                if (n > 0) m_decoder.process(m_block.data(), n);
+                if (complete) m_decoder.flush();
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+                m_error = std::current_exception();
+                m_progress_cv.notify_all();
+                return;
+            }
+            m_unflushed += n;
+            last_queued = 0;
+            if (!complete) continue;
+            {
+                std::lock_guard lock(m_mutex);
+                m_processed += m_unflushed;
+            }
+            m_unflushed = 0;
+            m_progress_cv.notify_all();
+            continue;
+        }
+        if (stopping) return;
+
+        // Sleep for roughly the time the rest of the block takes to arrive; the
+        // producer never signals, so stop/flush are the only early wake-ups
+        last_queued = queued;
+        const auto block_time = duration<double>(static_cast<double>(m_block_size - queued) / m_sample_rate);
+        const auto timeout = std::clamp(duration_cast<microseconds>(block_time), microseconds(500), microseconds(100'000));
+        std::unique_lock lock(m_mutex);
+        m_wake_cv.wait_for(lock, timeout, [this] {
+            return m_stopping || (m_flush_requests > 0 && (m_ring.size() > 0 || m_unflushed > 0));
+        });
+    }
+}
+
+} // namespace sstv
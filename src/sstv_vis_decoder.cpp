@@ -1,6 +1,4 @@
 #include "sstv_vis_decoder.h"
-#include <iostream>
-#include <iomanip>
 
 namespace sstv {
 
@@ -11,16 +9,18 @@ VISDecoder::VISDecoder(double sample_rate, ModeDetectedCallback on_mode_detected
     reset();
 }
 
-double VISDecoder::get_smoothed_freq(double raw_freq) {
-    m_median_buffer.push_back(raw_freq);
-    if (m_median_buffer.size() > MEDIAN_WINDOW) m_median_buffer.pop_front();
-
-    std::vector<double> sorted = {m_median_buffer.begin(), m_median_buffer.end()};
-    std::sort(sorted.begin(), sorted.end());
-    return sorted[sorted.size() / 2];
+FreqSample VISDecoder::get_smoothed_freq(FreqSample raw_freq) {
+    return m_median_filter.process(raw_freq);
 }
 
 void VISDecoder::reset() {
+    if (m_state != State::IDLE && m_state != State::COMPLETE) {
+        m_stats.resets_by_state[static_cast<size_t>(m_state)].add();
+    }
+    restart();
+}
+
+void VISDecoder::restart() {
     m_state = State::IDLE;
     m_state_timer_samples = 0;
     m_preamble_step = 0;
@@ -30,13 +30,20 @@ void VISDecoder::reset() {
     m_bit_freq_accumulator = 0;
     m_bit_sample_count = 0;
     // 中值滤波重置
-    m_median_buffer.clear();
+    m_median_filter.clear();
     // AFC 重置
     m_afc_offset = 0.0;
     m_afc_accumulator = 0.0;
     m_afc_sample_count = 0;
 }
 
+void VISDecoder::reset_stats() {
+    for (auto& counter : m_stats.resets_by_state) counter.reset();
+    m_stats.parity_errors.reset();
+    m_stats.headers_decoded.reset();
+    m_stats.unknown_modes.reset();
+}
+
 void VISDecoder::reserve_time(double reserved_time_ms)
 {
     m_error_count = 0;
@@ -54,13 +61,23 @@ bool VISDecoder::is_freq_near(double freq, double target, double tolerance) {
     return std::abs(freq - target) < tolerance;
 }
 
-bool VISDecoder::process_frequency(const double& raw_freq) {
+bool VISDecoder::process_frequency(FreqSample raw_freq) {
     // 中值滤波预处理
     double freq = get_smoothed_freq(raw_freq);
     double corrected_freq = freq - m_afc_offset;
 
     m_state_timer_samples += 1.0;
 
+    if constexpr (TRACE_ENABLED) {
+        if (m_trace) {
+            m_trace->record({.source = TraceSource::VIS,
+                             .state = static_cast<uint8_t>(m_state),
+                             .freq = static_cast<float>(raw_freq),
+                             .corrected_freq = static_cast<float>(corrected_freq),
+                             .afc_offset = static_cast<float>(m_afc_offset)});
+        }
+    }
+
     // 鲁棒性检查：如果频率完全丢失（0），快速重置
     if (freq < 100.0) {
         reset();
@@ -74,21 +91,14 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
                 if (m_state_timer_samples >= ((DEFAULT_PREAMBLE_TONES[0].duration_ms - 5.0) * m_samples_per_ms)) {
                     m_preamble_step = 0;
                     m_afc_offset = freq - DEFAULT_PREAMBLE_TONES[0].frequency;
-                    // // 打印调试信息，便于在 log 中观察偏置锁定情况
-                    // std::cout << "[VIS] Signal Detected! Avg Freq: " << freq
-                    //           << "Hz, Estimated Offset: " << m_afc_offset << "Hz" << std::endl;
-                    // exit(0);
                     transition_to(State::PREAMBLE_WAIT_1, DEFAULT_PREAMBLE_TONES[0].duration_ms - 5.0);
                 }
             } else {
-                // std::cout << "IDLE Not satified: " << corrected_freq << " " << DEFAULT_PREAMBLE_TONES[0].frequency << std::endl;
                 m_state_timer_samples = 0; // 频率不对，重置计时
             }
             break;
 
         case State::PREAMBLE_WAIT_1: {
-            // // 调试信息
-            // std::cout << "Debug PREAMBLE_WAIT_1 [" << m_state_timer_samples << "]: corrected_freq = " << corrected_freq << std::endl;
             if (std::abs(corrected_freq - DEFAULT_PREAMBLE_TONES[1].frequency) < std::abs(corrected_freq - DEFAULT_PREAMBLE_TONES[0].frequency)) {
                 m_preamble_step = 1; // 已经完成第0个音
                 transition_to(State::PREAMBLE, 0.0);  // 由于会手动同步赋值计时器，无需填充已占用时间
@@ -102,46 +112,11 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
 
         case State::PREAMBLE: {
             const auto& target_tone = DEFAULT_PREAMBLE_TONES[m_preamble_step];
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 20 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: PREAMBLE " << m_preamble_step << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //         std::cout << "Target Freq: " << target_tone.frequency << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (target_tone.duration_ms * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 时间控制分支
             if (m_state_timer_samples >= (target_tone.duration_ms * m_samples_per_ms)) {
                 m_preamble_step++;
                 // 进入下一个前缀检测，误差归零，计数器归零
-                // // 调试输出状态转换
-                // std::cout << "Preamble next, now m_preamble_step: " << m_preamble_step << std::endl;
-                // std::cout << "Corrected freq: " << corrected_freq << std::endl;
                 reserve_time(target_tone.duration_ms);
-                // // 清除调试参数
-                // debug_counter = 0;
                 if (m_preamble_step >= DEFAULT_PREAMBLE_TONES.size()) {
                     transition_to(State::LEADER_BURST_1, 0.0);  // 上面的 reserve_time 已经处理过时间
                 }
@@ -152,9 +127,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
             } else {
                 // 允许短时间误差
                 if (++m_error_count > (MAX_ERROR_TIME_MS * m_samples_per_ms)) {
-                    // std::cout << "Force reset, m_preamble_step: " << m_preamble_step << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
                     reset();
                 };
             }
@@ -162,35 +134,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::LEADER_BURST_1: {
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 10 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: LEADER BURST 1 " << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * 3.0 * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 建议跳过前 50ms 的不稳定期
             if (m_state_timer_samples > (VIS_LEADER_BURST_DURATION_MS * 0.25 * m_samples_per_ms)
                 && m_state_timer_samples < (VIS_LEADER_BURST_DURATION_MS * 0.75 * m_samples_per_ms)) {
@@ -201,7 +144,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
                 // 计算偏移量：实际平均值 - 理论 1900
                 if (m_afc_sample_count > 0) {
                     m_afc_offset = (m_afc_accumulator / m_afc_sample_count) - VIS_LEADER_BURST_FREQ;
-                    // std::cout << "AFC Offset Calculated: " << m_afc_offset << " Hz" << std::endl;
                 }
                 transition_to(State::BREAK_1200, VIS_LEADER_BURST_DURATION_MS);
             }
@@ -215,35 +157,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::BREAK_1200:{
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 5 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: BREAK " << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 时间分支
             if (m_state_timer_samples >= (VIS_BREAK_DURATION_MS * m_samples_per_ms)) {
                 transition_to(State::LEADER_BURST_2, VIS_BREAK_DURATION_MS);
@@ -253,9 +166,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
             } else {
                 if (++m_error_count > (MAX_ERROR_TIME_MS * m_samples_per_ms))
                 {
-                    // std::cout << "Force reset in BREAK_1200: " << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
                     reset();
                 }
             }
@@ -263,38 +173,7 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::LEADER_BURST_2: {
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 20 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: LEADER BURST 2 " << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             if (m_state_timer_samples >= (VIS_LEADER_BURST_DURATION_MS * m_samples_per_ms)) {
-                // // Debug info
-                // std::cout << "Transition to START_BIT" << std::endl;
                 transition_to(State::START_BIT, VIS_LEADER_BURST_DURATION_MS);
             }
             else if (is_freq_near(corrected_freq, VIS_LEADER_BURST_FREQ)) {
@@ -302,9 +181,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
             } else {
                 if (++m_error_count > (MAX_ERROR_TIME_MS * m_samples_per_ms))
                 {
-                    // std::cout << "Force reset in LEADER_BURST_2: " << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
                     reset();
                 }
             }
@@ -312,36 +188,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::START_BIT: {
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 20 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: START_BIT " << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //         std::cout << "Target Freq: " << VIS_START_STOP_FREQ << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 时间分支
             if (m_state_timer_samples >= (VIS_BIT_DURATION_MS * m_samples_per_ms)) {
                 transition_to(State::DATA_BITS, VIS_BIT_DURATION_MS);
@@ -350,10 +196,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
                 // Nothing to do here
             } else {
                 if (++m_error_count > (MAX_ERROR_TIME_MS * m_samples_per_ms)) {
-                    // std::cout << "=======================" << std::endl;
-                    // std::cout << "Force reset in START_BIT: " << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
                     reset();
                 }
             }
@@ -361,35 +203,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::DATA_BITS:{
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 20 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: DATA BIT " << m_bit_count << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 累加整个位周期内的频率
             m_bit_freq_accumulator += corrected_freq;
             m_bit_sample_count++;
@@ -418,35 +231,6 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
         }
 
         case State::PARITY_BIT:{
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 10 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: PARITY BIT" << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             m_bit_freq_accumulator += corrected_freq;
             m_bit_sample_count++;
 
@@ -460,73 +244,36 @@ bool VISDecoder::process_frequency(const double& raw_freq) {
                 bool parity_ok = ((ones + p_bit) % 2 == 0);
 
                 if (parity_ok) {
-                    // // Debug info
-                    // std::cout << "Parity OK: " << ones << std::endl;
                     transition_to(State::STOP_BIT, VIS_BIT_DURATION_MS);
                 }
                 else {
-                    std::cerr << "VIS: Parity Error" << std::endl;
-                    // // 调试退出
-                    // std::cout << "Force reset in PARITY_BIT: " << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
-                    reset();
+                    // 已计入 parity_errors，不再记为 PARITY_BIT 处的 reset
+                    m_stats.parity_errors.add();
+                    restart();
                 }
             }
             break;
         }
 
         case State::STOP_BIT:{
-            // // 调试代码：输出 corrected_freq 并限制输出次数
-            // static int debug_counter = 0;
-            // if (debug_counter < 8000) {
-            //     if (debug_counter % 10 == 0) {
-            //         std::cout << "\n=== Debug [" << debug_counter << "] ===" << std::endl;
-            //         std::cout << "State: STOP BIT" << std::endl;
-            //         std::cout << "AFC offset: " << m_afc_offset << std::endl;
-            //         std::cout << "Current Freq: " << corrected_freq << " Hz" << std::endl;
-            //
-            //         // 时间相关的状态
-            //         double elapsed_ms = static_cast<double>(m_state_timer_samples) / m_samples_per_ms;
-            //         std::cout << "State Timer: " << m_state_timer_samples << " samples ("
-            //                   << std::fixed << std::setprecision(2) << elapsed_ms << " ms)" << std::endl;
-            //
-            //         // 进度百分比
-            //         double progress_pct = (m_state_timer_samples * 100.0) / (VIS_BIT_DURATION_MS * m_samples_per_ms);
-            //         std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress_pct << "%" << std::endl;
-            //
-            //         // 错误计数器
-            //         std::cout << "Error Count: " << m_error_count << "/" << (MAX_ERROR_TIME_MS * m_samples_per_ms) << std::endl;
-            //     }
-            //     debug_counter++;
-            // } else if (debug_counter == 8000) {
-            //     std::cout << "\n=== Debug Summary ===" << std::endl;
-            //     std::cout << "Reached max debug outputs (8000)." << std::endl;
-            //     std::cout << "Final Error Count: " << m_error_count << std::endl;
-            //     std::cout << "Exiting..." << std::endl;
-            //     exit(0);
-            // }
             // 时间分支
             if (m_state_timer_samples >= (VIS_BIT_DURATION_MS * m_samples_per_ms)) {
-                auto it = GLOBAL_VIS_MAP.find(m_decoded_vis_bits);
-                if (it != GLOBAL_VIS_MAP.end()) {
-                    m_on_mode_detected(it->second);
-                    m_state = State::COMPLETE;
-                    return true;
+                m_stats.headers_decoded.add();
+                // 先进入 COMPLETE 再回调：回调中的 reset()（如未注册的 VIS 码）不计入 resets_by_state，
+                // 也不会在返回后被这里的状态覆盖
+                m_state = State::COMPLETE;
+                if (const ModeDescriptor* desc = find_mode(m_decoded_vis_bits)) {
+                    m_on_mode_detected(desc->mode);
                 } else {
+                    m_stats.unknown_modes.add();
                     m_on_mode_detected(SSTVMode("Unknown", m_decoded_vis_bits, 0, 0, 0, SSTVFamily::UNKNOWN));
-                    m_state = State::COMPLETE;
-                    return true;
                 }
+                return true;
             }
             if (is_freq_near(corrected_freq, VIS_START_STOP_FREQ)) {
                 // Nothing to do here
             } else {
                 if (++m_error_count > (MAX_ERROR_TIME_MS * m_samples_per_ms)) {
-                    // std::cout << "=======================" << std::endl;
-                    // std::cout << "Force reset in STOP_BIT: " << std::endl;
-                    // std::cout << "Current freq: " << corrected_freq << std::endl;
-                    // exit(0);
                     reset();
                 }
             }
@@ -0,0 +1,350 @@
+#include "sstv_vis_goertzel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace sstv {
+
+namespace {
+
+constexpr float ENERGY_FLOOR = 1e-8f;  // 块均方值低于此值视为静音
+
+// 单频点 Goertzel：|X(f)|^2 = s1^2 + s2^2 - 2cos(w) s1 s2
+template <typename T>
+T goertzel_power(const float* x, size_t n, T coeff) {
+    T s1 = 0, s2 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const T s0 = static_cast<T>(x[i]) + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+template <typename T>
+T block_energy(const float* x, size_t n) {
+    T e = 0;
+    for (size_t i = 0; i < n; ++i) e += static_cast<T>(x[i]) * x[i];
+    return e;
+}
+
+// 三点抛物线插值，返回峰值相对中心点的偏移（-0.5 ~ 0.5）
+double parabolic_peak(double left, double center, double right) {
+    const double denom = left - 2.0 * center + right;
+    if (denom >= 0.0) return 0.0;
+    return std::clamp(0.5 * (left - right) / denom, -0.5, 0.5);
+}
+
+} // namespace
+
+GoertzelVISDecoder::GoertzelVISDecoder(double sample_rate, ModeDetectedCallback on_mode_detected_cb,
+                                       float purity_threshold, float min_score)
+    : m_sample_rate(sample_rate),
+      m_bit_samples(VIS_BIT_DURATION_MS * sample_rate / 1000.0),
+      m_purity_threshold(purity_threshold),
+      m_min_score(min_score),
+      m_on_mode_detected(std::move(on_mode_detected_cb)),
+      m_acquire_spacing(sample_rate / (2.0 * BLOCK_SIZE))
+{
+    if (sample_rate <= 0 || VIS_LEADER_BURST_FREQ + ACQUIRE_SPAN_HZ >= sample_rate / 2.0) {
+        throw std::runtime_error("Goertzel VIS decoder: invalid sample rate");
+    }
+    if (LEADER_WINDOW + 2 * BLOCK_SIZE + static_cast<size_t>(VIS_WINDOW_BITS * m_bit_samples) + BLOCK_SIZE >
+        HISTORY_KEEP) {
+        throw std::runtime_error("Goertzel VIS decoder: sample rate too high for the history buffer");
+    }
+
+    // 捕获频点组：1900 ± ACQUIRE_SPAN_HZ，间隔半个分辨率 fs / (2N)。前导序列中 100ms 的 1500 / 2300Hz
+    // 校准音可能被当作偏移很大的前导音锁定，但随后跟踪频点上没有能量，LEADER_DROPOUT_MS 后回到 IDLE 重新捕获
+    const int half_bins = static_cast<int>(std::ceil(ACQUIRE_SPAN_HZ / m_acquire_spacing));
+    for (int k = -half_bins; k <= half_bins; ++k) {
+        m_acquire_coeffs.push_back(coeff(VIS_LEADER_BURST_FREQ + k * m_acquire_spacing));
+    }
+    m_acquire_power.resize(m_acquire_coeffs.size());
+
+    m_history.reserve(HISTORY_CAPACITY + BLOCK_SIZE);
+    m_handover.reserve(HISTORY_KEEP);
+    reset();
+}
+
+void GoertzelVISDecoder::reset() {
+    if (m_state == State::LEADER || m_state == State::HEADER) {
+        m_stats.leaders_lost.add();
+    }
+    m_state = State::IDLE;
+    m_history.clear();
+    m_history_start = 0;
+    m_total = 0;
+    m_acquire_blocks = 0;
+    m_acquire_offset_sum = 0.0;
+    m_afc_offset = 0.0;
+    m_leader_blocks = 0;
+    m_dropout_blocks = 0;
+    m_start_blocks = 0;
+    m_start_candidate = 0;
+    m_header_ready_at = 0;
+    m_handover.clear();
+}
+
+void GoertzelVISDecoder::reset_stats() {
+    m_stats.leaders_lost.reset();
+    m_stats.framing_errors.reset();
+    m_stats.parity_errors.reset();
+    m_stats.headers_decoded.reset();
+    m_stats.unknown_modes.reset();
+}
+
+float GoertzelVISDecoder::coeff(double freq) const {
+    return static_cast<float>(2.0 * std::cos(2.0 * std::numbers::pi * freq / m_sample_rate));
+}
+
+const float* GoertzelVISDecoder::at(uint64_t sample_index) const {
+    return m_history.data() + (sample_index - m_history_start);
+}
+
+void GoertzelVISDecoder::append(const float* samples, size_t count) {
+    if (m_history.size() + count > HISTORY_CAPACITY) {
+        // 只保留最近 HISTORY_KEEP 个样本，压缩频率约每 0.7s 一次
+        const size_t drop = m_history.size() - HISTORY_KEEP;
+        m_history.erase(m_history.begin(), m_history.begin() + static_cast<std::ptrdiff_t>(drop));
+        m_history_start += drop;
+    }
+    m_history.insert(m_history.end(), samples, samples + count);
+    m_total += count;
+}
+
+bool GoertzelVISDecoder::process(std::span<const float> samples, size_t& consumed) {
+    consumed = 0;
+    while (consumed < samples.size()) {
+        // 按绝对序号对齐到块边界；收集 VIS 头时停在恰好收满的位置
+        size_t take = std::min(samples.size() - consumed, BLOCK_SIZE - static_cast<size_t>(m_total % BLOCK_SIZE));
+        if (m_state == State::HEADER) {
+            take = std::min<size_t>(take, m_header_ready_at - m_total);
+        }
+        append(samples.data() + consumed, take);
+        consumed += take;
+
+        if (m_state == State::HEADER) {
+            if (m_total == m_header_ready_at && decode_header()) return true;
+        } else if (m_state != State::COMPLETE && m_total % BLOCK_SIZE == 0) {
+            process_block(at(m_total - BLOCK_SIZE));
+        }
+    }
+    return false;
+}
+
+void GoertzelVISDecoder::process_block(const float* block) {
+    const float energy = block_energy<float>(block, BLOCK_SIZE);
+    if (m_state == State::IDLE) {
+        acquire_block(block, energy);
+    } else {
+        track_block(block, energy);
+    }
+}
+
+void GoertzelVISDecoder::acquire_block(const float* block, float energy) {
+    const size_t bins = m_acquire_coeffs.size();
+    float* power = m_acquire_power.data();
+    size_t peak = 0;
+    for (size_t k = 0; k < bins; ++k) {
+        power[k] = goertzel_power(block, BLOCK_SIZE, m_acquire_coeffs[k]);
+        if (power[k] > power[peak]) peak = k;
+    }
+
+    const bool tonal = energy >= ENERGY_FLOOR * BLOCK_SIZE &&
+                       power[peak] >= m_purity_threshold * (BLOCK_SIZE / 2.0f) * energy;
+    if (!tonal) {
+        m_acquire_blocks = 0;
+        return;
+    }
+
+    // 峰值频点两侧幅度做抛物线插值，得到本块的频偏估计
+    double delta = 0.0;
+    if (peak > 0 && peak + 1 < bins) {
+        delta = parabolic_peak(std::sqrt(power[peak - 1]), std::sqrt(power[peak]), std::sqrt(power[peak + 1]));
+    }
+    const double offset = (static_cast<double>(peak) - static_cast<double>(bins / 2) + delta) * m_acquire_spacing;
+
+    // 频偏估计必须前后一致，否则以本块重新开始计数
+    if (m_acquire_blocks > 0 &&
+        std::abs(offset - m_acquire_offset_sum / static_cast<double>(m_acquire_blocks)) > ACQUIRE_TOLERANCE_HZ) {
+        m_acquire_blocks = 0;
+        m_acquire_offset_sum = 0.0;
+    }
+    ++m_acquire_blocks;
+    m_acquire_offset_sum += offset;
+    if (m_acquire_blocks < ACQUIRE_BLOCKS) return;
+
+    // 锁定前导音：之后只跟踪校正后的 1900 / 1200Hz 两个频点
+    m_afc_offset = m_acquire_offset_sum / static_cast<double>(m_acquire_blocks);
+    m_leader_coeff = coeff(VIS_LEADER_BURST_FREQ + m_afc_offset);
+    m_sync_coeff = coeff(VIS_START_STOP_FREQ + m_afc_offset);
+    m_leader_blocks = m_acquire_blocks;
+    m_dropout_blocks = 0;
+    m_start_blocks = 0;
+    m_state = State::LEADER;
+}
+
+void GoertzelVISDecoder::track_block(const float* block, float energy) {
+    const float leader = goertzel_power(block, BLOCK_SIZE, m_leader_coeff);
+    const float sync = goertzel_power(block, BLOCK_SIZE, m_sync_coeff);
+    const bool audible = energy >= ENERGY_FLOOR * BLOCK_SIZE;
+    const float reference = m_purity_threshold * (BLOCK_SIZE / 2.0f) * energy;
+
+    // 块长 64 时分辨率约 172Hz，1100 / 1300Hz 的数据位在 1200Hz 频点上也有相当能量，
+    // 因此起始位只要求 1200Hz 频点占优且纯度过半数门限；噪声块打断计数不影响前导音
+    if (audible && sync > leader && sync >= 0.5f * reference) {
+        if (m_start_blocks++ == 0) m_start_candidate = m_total - BLOCK_SIZE;
+        const double leader_ms = static_cast<double>(m_leader_blocks * BLOCK_SIZE) * 1000.0 / m_sample_rate;
+        if (m_start_blocks >= START_CONFIRM_BLOCKS && leader_ms >= MIN_LEADER_MS) {
+            // 真实跳变在候选块前后一块之内；收满最晚的 10 个位窗后解码
+            m_header_ready_at = m_start_candidate + 2 * BLOCK_SIZE +
+                                static_cast<uint64_t>(std::ceil(VIS_WINDOW_BITS * m_bit_samples)) + 1;
+            m_state = State::HEADER;
+        }
+        return;
+    }
+
+    if (audible && leader >= reference) {
+        // 10ms 间隔音在这里并入前导音
+        m_leader_blocks += 1 + m_start_blocks;
+        m_start_blocks = 0;
+        m_dropout_blocks = 0;
+        return;
+    }
+
+    m_start_blocks = 0;
+    const double dropout_ms = static_cast<double>(++m_dropout_blocks * BLOCK_SIZE) * 1000.0 / m_sample_rate;
+    if (dropout_ms > LEADER_DROPOUT_MS) {
+        m_stats.leaders_lost.add();
+        m_state = State::IDLE;
+        m_acquire_blocks = 0;
+        m_acquire_offset_sum = 0.0;
+    }
+}
+
+double GoertzelVISDecoder::refine_offset(uint64_t leader_end) const {
+    // 前导音末段上以 FINE_STEP_HZ 为步长扫描 ±FINE_SEARCH_HZ，取能量峰值再插值
+    const uint64_t first = std::max<uint64_t>(m_history_start, leader_end - std::min<uint64_t>(leader_end, LEADER_WINDOW));
+    const size_t n = static_cast<size_t>(leader_end - first);
+    if (n < BLOCK_SIZE) return m_afc_offset;
+
+    constexpr int steps = static_cast<int>(FINE_SEARCH_HZ / FINE_STEP_HZ);
+    std::array<double, 2 * steps + 1> power{};
+    size_t peak = 0;
+    for (int k = -steps; k <= steps; ++k) {
+        const double freq = VIS_LEADER_BURST_FREQ + m_afc_offset + k * FINE_STEP_HZ;
+        const size_t i = static_cast<size_t>(k + steps);
+        power[i] = goertzel_power<double>(at(first), n, 2.0 * std::cos(2.0 * std::numbers::pi * freq / m_sample_rate));
+        if (power[i] > power[peak]) peak = i;
+    }
+    double delta = 0.0;
+    if (peak > 0 && peak + 1 < power.size()) {
+        delta = parabolic_peak(power[peak - 1], power[peak], power[peak + 1]);
+    }
+    return m_afc_offset + (static_cast<double>(peak) - steps + delta) * FINE_STEP_HZ;
+}
+
+GoertzelVISDecoder::WindowScore GoertzelVISDecoder::score_header(uint64_t start, double offset) const {
+    const double two_pi_over_fs = 2.0 * std::numbers::pi / m_sample_rate;
+    const double c1100 = 2.0 * std::cos(two_pi_over_fs * (VIS_LOGIC_1_FREQ + offset));
+    const double c1200 = 2.0 * std::cos(two_pi_over_fs * (VIS_START_STOP_FREQ + offset));
+    const double c1300 = 2.0 * std::cos(two_pi_over_fs * (VIS_LOGIC_0_FREQ + offset));
+
+    WindowScore result;
+    result.framed = true;
+    int ones = 0;
+    for (size_t bit = 0; bit < VIS_WINDOW_BITS; ++bit) {
+        const uint64_t begin = start + static_cast<uint64_t>(std::llround(bit * m_bit_samples));
+        const uint64_t end = start + static_cast<uint64_t>(std::llround((bit + 1) * m_bit_samples));
+        const size_t n = static_cast<size_t>(end - begin);
+        const float* x = at(begin);
+
+        // 归一化能量：理想单音为 1，与信号幅度无关
+        const double norm = (n / 2.0) * block_energy<double>(x, n);
+        if (norm <= 0.0) {
+            result.framed = false;
+            continue;
+        }
+        const double s1100 = goertzel_power<double>(x, n, c1100) / norm;
+        const double s1200 = goertzel_power<double>(x, n, c1200) / norm;
+        const double s1300 = goertzel_power<double>(x, n, c1300) / norm;
+
+        if (bit == 0 || bit == VIS_WINDOW_BITS - 1) {
+            // 起始位 / 停止位
+            result.score += s1200;
+            result.framed = result.framed && s1200 > std::max(s1100, s1300);
+            continue;
+        }
+        const int value = s1100 > s1300 ? 1 : 0;  // 逻辑 1 是 1100，逻辑 0 是 1300
+        result.score += std::max(s1100, s1300);
+        if (bit <= 7) {
+            result.code |= value << (bit - 1);
+        }
+        ones += value;  // 7 个数据位 + 校验位
+    }
+    result.parity_ok = ones % 2 == 0;  // 偶校验
+    return result;
+}
+
+bool GoertzelVISDecoder::decode_header() {
+    const double offset = refine_offset(m_start_candidate - BLOCK_SIZE);
+
+    // 先以 4 样本步长粗搜，再在最优点附近逐样本细搜位边界
+    constexpr uint64_t COARSE_STEP = 4;
+    const uint64_t lo = m_start_candidate - BLOCK_SIZE;
+    const uint64_t hi = m_start_candidate + BLOCK_SIZE;
+    uint64_t best_start = lo;
+    WindowScore best;
+    for (uint64_t start = lo; start <= hi; start += COARSE_STEP) {
+        const WindowScore s = score_header(start, offset);
+        if (s.score > best.score) {
+            best = s;
+            best_start = start;
+        }
+    }
+    const uint64_t coarse = best_start;
+    for (uint64_t start = coarse - (COARSE_STEP - 1); start <= coarse + (COARSE_STEP - 1); ++start) {
+        if (start == coarse) continue;
+        const WindowScore s = score_header(start, offset);
+        if (s.score > best.score) {
+            best = s;
+            best_start = start;
+        }
+    }
+
+    if (!best.framed || best.score < m_min_score * VIS_WINDOW_BITS) {
+        m_stats.framing_errors.add();
+        m_state = State::IDLE;
+        m_acquire_blocks = 0;
+        m_acquire_offset_sum = 0.0;
+        return false;
+    }
+    if (!best.parity_ok) {
+        m_stats.parity_errors.add();
+        m_state = State::IDLE;
+        m_acquire_blocks = 0;
+        m_acquire_offset_sum = 0.0;
+        return false;
+    }
+
+    // 交接样本必须在回调之前准备好：回调里可能 reset() 本解码器
+    const uint64_t header_end = best_start + static_cast<uint64_t>(std::llround(VIS_WINDOW_BITS * m_bit_samples));
+    const uint64_t from = header_end - HANDOVER_HISTORY;
+    m_handover.assign(at(from), at(from) + (m_total - from));
+    m_afc_offset = offset;
+    m_state = State::COMPLETE;
+
+    m_stats.headers_decoded.add();
+    if (const ModeDescriptor* desc = find_mode(best.code)) {
+        m_on_mode_detected(desc->mode);
+    } else {
+        m_stats.unknown_modes.add();
+        m_on_mode_detected(SSTVMode("Unknown", best.code, 0, 0, 0, SSTVFamily::UNKNOWN));
+    }
+    return true;
+}
+
+} // namespace sstv